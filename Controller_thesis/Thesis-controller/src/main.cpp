@@ -2,12 +2,14 @@
 
 #include <esp_now.h>
 #include <WiFi.h>
+#include <ArmFrame.h>
 #include "include/Button.h"
 #include "include/set_up.h"
 
 const unsigned long SEND_INTERVAL = 100;           // ms tra invii (10Hz)
 const unsigned long HEARTBEAT_INTERVAL = 2000;     // ms tra heartbeat (0.5Hz)
-const unsigned long REPEAT_INTERVAL = 200;         // ms tra comandi ripetuti durante pressione continua
+const unsigned long REPEAT_INTERVAL = 100;         // ms tra comandi ripetuti (keepalive del jog, < 300ms)
+const unsigned long LAYOUT_HOLD_TIME = 800;        // ms con Base SX + Base DX per cambiare layout
 
 // Pulsanti con debouncing automatico
 Button base_sx(YELLOW_BASE_SX, false);
@@ -23,21 +25,46 @@ Button claw_dx(YELLOW_CLAW_DX, false);
 struct ButtonMapping {   
     Button* btn;
     const char* label;
+    const char* releaseLabel;      // Inviato al rilascio (ferma il jog)
+    uint8_t bit;                   // Bit del frame (giunto o asse della pinza)
+    int8_t value;                  // Velocità nel frame, in % di quella di jog
     unsigned long lastRepeatTime;  // Timestamp ultimo invio
+    bool releasePending;           // Rilascio non ancora inviato
 };
 
-ButtonMapping buttons[] = {
-    {&base_sx,  "Base SX", 0},
-    {&base_dx,  "Base DX", 0},
-    {&elbow_sx, "Elbow SX", 0},
-    {&elbow_dx, "Elbow DX", 0},
-    {&wrist_sx, "Wrist SX", 0},
-    {&wrist_dx, "Wrist DX", 0},
-    {&claw_sx,  "Claw Open", 0},
-    {&claw_dx,  "Claw Close", 0}
+// Layout giunti: un pulsante per verso di ogni giunto
+ButtonMapping jointButtons[] = {
+    {&base_sx,  "Base SX",    "Base STOP",  0, -100, 0, false},
+    {&base_dx,  "Base DX",    "Base STOP",  0,  100, 0, false},
+    {&elbow_sx, "Elbow SX",   "Elbow STOP", 1, -100, 0, false},
+    {&elbow_dx, "Elbow DX",   "Elbow STOP", 1,  100, 0, false},
+    {&wrist_sx, "Wrist SX",   "Wrist STOP", 2, -100, 0, false},
+    {&wrist_dx, "Wrist DX",   "Wrist STOP", 2,  100, 0, false},
+    {&claw_sx,  "Claw Open",  "Claw STOP",  3,  100, 0, false},
+    {&claw_dx,  "Claw Close", "Claw STOP",  3, -100, 0, false}
 };
 
-const int NUM_BUTTONS = sizeof(buttons) / sizeof(buttons[0]);
+// Layout cartesiano: velocità della pinza lungo X/Y/Z, risolta dal
+// braccio con la cinematica inversa ad ogni tick
+ButtonMapping cartesianButtons[] = {
+    {&base_sx,  "CJOG X-",    "CJOG X STOP", ARM_FRAME_AXIS_BIT(0), -100, 0, false},
+    {&base_dx,  "CJOG X+",    "CJOG X STOP", ARM_FRAME_AXIS_BIT(0),  100, 0, false},
+    {&elbow_sx, "CJOG Y-",    "CJOG Y STOP", ARM_FRAME_AXIS_BIT(1), -100, 0, false},
+    {&elbow_dx, "CJOG Y+",    "CJOG Y STOP", ARM_FRAME_AXIS_BIT(1),  100, 0, false},
+    {&wrist_sx, "CJOG Z-",    "CJOG Z STOP", ARM_FRAME_AXIS_BIT(2), -100, 0, false},
+    {&wrist_dx, "CJOG Z+",    "CJOG Z STOP", ARM_FRAME_AXIS_BIT(2),  100, 0, false},
+    {&claw_sx,  "Claw Open",  "Claw STOP",   3,  100, 0, false},
+    {&claw_dx,  "Claw Close", "Claw STOP",   3, -100, 0, false}
+};
+
+const int NUM_BUTTONS = sizeof(jointButtons) / sizeof(jointButtons[0]);
+static_assert(sizeof(cartesianButtons) == sizeof(jointButtons), "I layout devono avere gli stessi pulsanti");
+
+// Layout attivo
+ButtonMapping* buttons = jointButtons;
+bool cartesianLayout = false;
+unsigned long layoutComboStart = 0;
+bool layoutSwitched = false;   // Cambiato: attende il rilascio di tutti i pulsanti
 
 // Stato connessione
 bool isConnected = false;
@@ -45,6 +72,10 @@ unsigned long lastSendTime = 0;
 unsigned long lastHeartbeatTime = 0;
 unsigned long lastSuccessTime = 0;
 
+// Sequenza dei frame binari (il braccio conta persi e duplicati)
+uint8_t frameSequence = 0;
+bool firstFrame = true;
+
 // Statistiche
 int messagesSent = 0;
 int messagesFailed = 0;
@@ -104,42 +135,119 @@ bool initESPNow() {
     return true;
 }
 
-bool sendMessage(const char* message) {
+bool sendBytes(const uint8_t* data, int length) {
     
     if (millis() - lastSendTime < SEND_INTERVAL) {
         return false;
     }
     
-    esp_err_t result = esp_now_send(
-        receiverAddress,
-        (uint8_t*)message,
-        strlen(message) + 1
-    );
+    esp_err_t result = esp_now_send(receiverAddress, data, length);
     
     lastSendTime = millis();
     
-    if (result == ESP_OK) {
-        Serial.printf("%s\n", message);
-        return true;
-    }
-    else {
+    if (result != ESP_OK) {
         Serial.printf("Errore: %d\n", result);
         return false;
     }
+    return true;
+}
+
+bool sendMessage(const char* message) {
+    if (!sendBytes((const uint8_t*)message, strlen(message) + 1)) {
+        return false;
+    }
+    Serial.printf("%s\n", message);
+    return true;
+}
+
+/**
+ * Assegna sequenza e flag FIRST e invia il frame: la sequenza avanza
+ * solo se l'invio parte, così il braccio non conta perdite inesistenti
+ */
+bool sendFrame(ArmFrame& frame) {
+    uint8_t buffer[ARM_FRAME_MAX_BYTES];
+    
+    frame.sequence = frameSequence;
+    if (firstFrame) {
+        frame.flags |= FRAME_FLAG_FIRST;
+    }
+    
+    int length = ArmFrameCodec::encode(frame, buffer, sizeof(buffer));
+    if (length == 0 || !sendBytes(buffer, length)) {
+        return false;
+    }
+    
+    frameSequence++;
+    firstFrame = false;
+    if (frame.type == FRAME_JOG) {
+        Serial.printf("Frame #%u: maschera 0x%03X (%d byte)\n", frame.sequence, frame.mask, length);
+    }
+    return true;
 }
 
 void sendHeartbeat() {
     if (millis() - lastHeartbeatTime > HEARTBEAT_INTERVAL) {
+#if ARM_FRAME_TEXT_COMPAT
         sendMessage("HEARTBEAT");
+#else
+        ArmFrame heartbeat = {};
+        heartbeat.type = FRAME_HEARTBEAT;
+        sendFrame(heartbeat);
+#endif
         lastHeartbeatTime = millis();
     }
 }
 
+bool anyReleasePending() {
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (buttons[i].releasePending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Base SX + Base DX tenuti insieme per LAYOUT_HOLD_TIME cambiano layout.
+ * Durante il gesto, e dopo il cambio fino al rilascio di tutti i
+ * pulsanti, non partono nuovi comandi ma solo i rilasci: il cambio
+ * avviene quando nessun rilascio del vecchio layout è in sospeso
+ * @return true se il gesto è in corso
+ */
+bool updateLayout() {
+    if (!(base_sx.isPressed() && base_dx.isPressed())) {
+        layoutComboStart = 0;
+        if (!layoutSwitched) {
+            return false;
+        }
+        for (int i = 0; i < NUM_BUTTONS; i++) {
+            if (buttons[i].btn->isPressed()) {
+                return true;
+            }
+        }
+        layoutSwitched = false;
+        return false;
+    }
+
+    if (layoutComboStart == 0) {
+        layoutComboStart = millis();
+    }
+
+    if (!layoutSwitched && millis() - layoutComboStart >= LAYOUT_HOLD_TIME && !anyReleasePending()) {
+        cartesianLayout = !cartesianLayout;
+        buttons = cartesianLayout ? cartesianButtons : jointButtons;
+        layoutSwitched = true;
+        Serial.printf("Layout: %s\n", cartesianLayout ? "cartesiano (X/Y/Z pinza)" : "giunti");
+    }
+    return true;
+}
+
 void printStats() {
     static unsigned long lastStatsTime = 0;
     
     if (millis() - lastStatsTime > 15000) { 
         Serial.printf("Stato:      %s\n", isConnected ? "Connesso" : "Disconnesso");
+        Serial.printf("Layout:     %s\n", cartesianLayout ? "Cartesiano" : "Giunti");
         Serial.printf("Inviati:    %d\n", messagesSent);
         Serial.printf("Falliti:    %d\n", messagesFailed);
         Serial.printf("Successo:   %.1f%%\n", 
@@ -176,9 +284,11 @@ void setup() {
     Serial.println("  • Base SX/DX   → Giallo (GPIO14/27)");
     Serial.println("  • Elbow SX/DX  → Bianco (GPIO26/25)");
     Serial.println("  • Wrist SX/DX  → Blu (GPIO33/32)");
-    Serial.println("  • Claw Open/Close → Giallo (GPIO12/13)\n");
+    Serial.println("  • Claw Open/Close → Giallo (GPIO12/13)");
+    Serial.println("Layout cartesiano: X-/X+ Y-/Y+ Z-/Z+ al posto di Base/Elbow/Wrist");
+    Serial.println("  • Cambio layout: Base SX + Base DX tenuti per 0.8s\n");
     Serial.println("💡 Tieni premuto per movimento continuo!");
-    Serial.println("   Intervallo ripetizione: 200ms\n");
+    Serial.println("   Intervallo ripetizione: 100ms\n");
 }
 
 void loop() {
@@ -188,14 +298,37 @@ void loop() {
         buttons[i].btn->update();
     }
 
+    bool layoutGesture = updateLayout();
+
     
     String commandsToSend = "";
     bool anyButtonPressed = false;
+    bool releaseQueued[NUM_BUTTONS] = {};
+    bool releaseInFrame = false;
+    bool anyNewPress = false;
+    
+    // Stessi comandi in binario: rilascio = velocità 0 sul bit
+    ArmFrame frame = {};
+    frame.type = FRAME_JOG;
+    
+    // I rilasci vanno prima delle pressioni: un "STOP" dopo un "SX"
+    // dello stesso giunto fermerebbe il nuovo jog
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (buttons[i].releasePending && !buttons[i].btn->isPressed()) {
+            commandsToSend += String(buttons[i].releaseLabel) + " ";
+            frame.mask |= (1 << buttons[i].bit);
+            frame.values[buttons[i].bit] = 0;
+            releaseQueued[i] = true;
+            releaseInFrame = true;
+        }
+    }
     
     for (int i = 0; i < NUM_BUTTONS; i++) {
-        // Verifica se pulsante è attualmente premuto
-        if (buttons[i].btn->isPressed()) {
+        // Verifica se pulsante è attualmente premuto (durante il cambio
+        // di layout i pulsanti tenuti valgono come rilasciati)
+        if (buttons[i].btn->isPressed() && !layoutGesture) {
             anyButtonPressed = true;
+            buttons[i].releasePending = false;
             
             // Verifica se è il momento di ripetere il comando
             unsigned long now = millis();
@@ -206,12 +339,15 @@ void loop() {
                 
                 // Aggiungi comando alla lista
                 commandsToSend += String(buttons[i].label) + " ";
+                frame.mask |= (1 << buttons[i].bit);
+                frame.values[buttons[i].bit] = buttons[i].value;
                 
                 // Aggiorna timestamp
                 buttons[i].lastRepeatTime = now;
                 
                 // Log prima pressione/ripetizione
                 if (buttons[i].btn->wasPressed()) {
+                    anyNewPress = true;
                     Serial.printf("Premuto: %s (inizio)\n", buttons[i].label);
                 } else {
                     Serial.printf("Ripeto: %s\n", buttons[i].label);
@@ -223,16 +359,37 @@ void loop() {
             if (buttons[i].lastRepeatTime > 0) {
                 Serial.printf("Rilasciato: %s\n", buttons[i].label);
                 buttons[i].lastRepeatTime = 0;
+                buttons[i].releasePending = true;
             }
         }
     }
     if (commandsToSend.length() > 0) {
+        bool sent;
+        
+        // Solo rinnovi del keepalive: il braccio non cambia nulla
+        if (!anyNewPress && !releaseInFrame) {
+            frame.flags |= FRAME_FLAG_REPEAT;
+        }
+        
+#if ARM_FRAME_TEXT_COMPAT
         commandsToSend.trim();
         
         char message[128];
         snprintf(message, sizeof(message), "%s", commandsToSend.c_str());
+        sent = sendMessage(message);
+#else
+        sent = sendFrame(frame);
+#endif
         
-        sendMessage(message);
+        // Il rilascio viene ritentato finché non parte (il keepalive
+        // del braccio ferma comunque il giunto se va perso in aria)
+        if (sent && releaseInFrame) {
+            for (int i = 0; i < NUM_BUTTONS; i++) {
+                if (releaseQueued[i]) {
+                    buttons[i].releasePending = false;
+                }
+            }
+        }
     }
 
     
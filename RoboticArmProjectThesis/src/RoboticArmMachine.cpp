@@ -1,6 +1,23 @@
 
 #include "RoboticArmMachine.h"
 #include "include/set_up.h"
+#include "include/ArmModel.h"
+
+// Tabella dei giunti, nell'ordine di JointIndex
+static const JointConfig ARM_JOINTS[] = {
+    // nome     modello            scheda  canale       safe min             safe max             parcheggio
+    {"Base",  SERVO_MODEL_20KG,  0,      BASE_SERVO,  0,                   MAX_RANGE,           SAFE_RANGE_DEFAULT},
+    {"Elbow", SERVO_MODEL_20KG,  0,      SERVO_ELBOW, 0,                   MAX_RANGE_ELBOW,     SAFE_RANGE_ELBOW},
+    {"Wrist", SERVO_MODEL_MG66R, 0,      SERVO_WRIST, 0,                   MAX_RANGE,           SAFE_RANGE_DEFAULT},
+    {"Claw",  SERVO_MODEL_MG66R, 0,      SERVO_CLAW,  SAFE_MIN_RANGE_CLAW, SAFE_MAX_RANGE_CLAW, SAFE_MIN_RANGE_CLAW},
+};
+
+// Giunti della catena cinematica, nell'ordine di KinematicAxis
+static const int KIN_JOINTS[KIN_AXES] = {JOINT_BASE, JOINT_ELBOW, JOINT_WRIST};
+#define KIN_JOINT_MASK ((1 << JOINT_BASE) | (1 << JOINT_ELBOW) | (1 << JOINT_WRIST))
+
+// Giunti controllati dalla CollisionMap: si muovono sempre insieme
+#define COLLISION_JOINT_MASK ((1 << JOINT_ELBOW) | (1 << JOINT_WRIST))
 
 
 RoboticArmMachine::RoboticArmMachine()
@@ -8,26 +25,28 @@ RoboticArmMachine::RoboticArmMachine()
 
     // Setup I2C
     Wire.begin(SDA_PIN, SCL_PIN);
-    Wire.setClock(400000);
-
-    Serial.printf("I2C: SDA=%d, SCL=%d, Clock=400kHz\n", SDA_PIN, SCL_PIN);
+    Wire.setClock(I2C_CLOCK_HZ);
 
-    // Test PCA9685
-    Wire.beginTransmission(PCA9685_ADDRESS);
-    byte error = Wire.endTransmission();
+    Serial.printf("I2C: SDA=%d, SCL=%d, Clock=%dkHz\n", SDA_PIN, SCL_PIN, I2C_CLOCK_HZ / 1000);
 
-    if (error != 0)
+    // Verifica e configurazione dei PCA9685 (con retry e bus-clear);
+    // una scheda assente non blocca l'avvio ma viene segnalata
+    const uint8_t addresses[] = PCA9685_ADDRESSES;
+    int online = 0;
+    for (size_t i = 0; i < sizeof(addresses); i++)
     {
-        Serial.printf("PCA9685 not found at 0x%02X\n", PCA9685_ADDRESS);
-        while (1)
-            delay(1000);
+        int board = this->pwm.addBoard(addresses[i], SERVO_PWM_FREQUENCY);
+        if (pwm.isOnline(board))
+        {
+            online++;
+        }
+        else
+        {
+            Serial.printf("PCA9685 not found at 0x%02X\n", addresses[i]);
+        }
     }
 
-    Serial.printf("PCA9685 found\n\n");
-
-    this->pwm = Adafruit_PWMServoDriver(PCA9685_ADDRESS);
-    this->pwm.begin();
-    this->pwm.setPWMFreq(50);
+    Serial.printf("PCA9685 found (%d/%d boards)\n\n", online, pwm.getBoardCount());
     delay(10);
 
     Serial.println("PCA9685 configured\n");
@@ -45,15 +64,85 @@ RoboticArmMachine::RoboticArmMachine()
     this->numCommands = 0;
 
     // Crea servo motori
-    this->baseServo = new ServoMotor20Diy(BASE_SERVO, 0, MAX_RANGE);
-    this->elbowServo = new ServoMotor20Diy(SERVO_ELBOW, 0, MAX_RANGE_ELBOW);
-
-    // Limited range servo (per sicurezza)
-    this->wristServo = new ServoMotorMG66R(SERVO_WRIST, 0, MAX_RANGE);
-    this->clawServo = new ServoMotorMG66R(SERVO_CLAW, SAFE_MIN_RANGE_CLAW, SAFE_MAX_RANGE_CLAW);
+    joints.configure(ARM_JOINTS, sizeof(ARM_JOINTS) / sizeof(ARM_JOINTS[0]));
+    kinematics.configure(ARM_GEOMETRY);
+    this->ikBranch = IK_DEFAULT_BRANCH;
+    this->lastIkMicros = 0;
+    this->lastCartesianMicros = 0;
+    this->maxCartesianMicros = 0;
+    this->collisionClips = 0;
+    this->collisionRejects = 0;
+
+    // La griglia va rigenerata dopo ogni modifica di ArmModel.h
+    if (!CollisionMap::matches(ARM_GEOMETRY))
+    {
+        Serial.println("ATTENZIONE: griglia di collisione non aggiornata (tools/genCollisionGrid.cpp)");
+    }
 
     Serial.println("Servo motors initialized\n");
 
+    // Uno slot di fase per ogni giunto; ogni scheda non supera il
+    // refresh del servo più lento collegato
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        ServoMotor *servo = joints.get(joint);
+        int board = servo->getBoard();
+        pwm.addChannel(board, servo->getChannel());
+
+        if (PWM_SYNC_PIN >= 0 && board == 0 && servo->getChannel() == PWM_SYNC_CHANNEL)
+        {
+            Serial.printf("PWM: %s usa il canale di riferimento %d\n", joints.getName(joint), PWM_SYNC_CHANNEL);
+        }
+
+        if (pwm.getFrequency(board) > ServoOutput::actualFrequency(servo->getMaxRefresh()))
+        {
+            Serial.printf("PWM %d: %s accetta al massimo %dHz\n", board, joints.getName(joint), servo->getMaxRefresh());
+            pwm.setFrequency(board, servo->getMaxRefresh());
+        }
+    }
+
+    // Canale di riferimento per l'allineamento al periodo PWM
+    // (fuori dalla tabella di fase: ON = 0, cioè a inizio periodo)
+    if (PWM_SYNC_PIN >= 0)
+    {
+        pwm.write(0, PWM_SYNC_CHANNEL, PWM_SYNC_PULSE);
+        pwm.flush();
+    }
+    sync.begin(PWM_SYNC_PIN, pwm.getPeriodMicros(0));
+    this->phaseCorrection = 0;
+
+    // Da qui i frame PWM partono dal task di trasmissione, non dal tick
+    pwm.startPipeline();
+
+    // Registrazioni teach su LittleFS (letture e scritture dal task della flash)
+    this->teachMode = TEACH_OFF;
+    this->teachEntry = 0;
+    this->teachWaits = 0;
+    teachStore.begin();
+    this->scriptName[0] = '\0';
+
+    // Stream G-code dall'host: lettere A B C D nell'ordine dei giunti
+    gcode.configure(joints.getCount());
+    this->gcodeDwellStart = 0;
+    this->gcodeActive = false;
+
+    // Frame ESP-NOW binari
+    this->frameHead = 0;
+    this->frameCount = 0;
+    this->frameLock = portMUX_INITIALIZER_UNLOCKED;
+    this->framesApplied = 0;
+    this->framesRejected = 0;
+    this->framesDropped = 0;
+
+    // Ordine di parcheggio
+    const JointMask parkOrder[] = PARK_ORDER;
+    parking.setOrder(parkOrder, sizeof(parkOrder) / sizeof(parkOrder[0]));
+
+    // Curve di calibrazione salvate in NVS
+    this->calibrationServo = nullptr;
+    this->lastCalibrationState = CAL_IDLE;
+    loadCalibrations();
+
     this->currentState = STATE_START;
     this->previousState = STATE_START;
     this->networkConnected = false;
@@ -65,6 +154,9 @@ RoboticArmMachine::RoboticArmMachine()
     this->lastNetworkCheck = millis();
     this->lastServoCheck = millis();
 
+    // Posa iniziale dalle posizioni di avvio
+    updateSnapshot();
+
     Serial.println("RoboticArmMachine initialized\n");
 }
 
@@ -74,8 +166,14 @@ void RoboticArmMachine::begin()
 
     setLedState(false, false);
 
-    // Posizione sicura iniziale
-    moveAllToCenter();
+    // Posizione sicura iniziale: all'accensione la posizione reale è
+    // ignota, quindi scrittura diretta invece del parcheggio
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        joints.get(joint)->moveToCenter(pwm);
+    }
+    pwm.flush();
+    joints.sync();
     delay(500);
 
     // Transizione a START
@@ -106,8 +204,6 @@ void RoboticArmMachine::update()
         handleIdle();
         break;
     }
-    //Togli questa riga dopo il debug
-    this->getDebugInfo();
 }
 
 int RoboticArmMachine::getCurrentState() const
@@ -136,24 +232,19 @@ String RoboticArmMachine::getStateString() const
     }
 }
 
-int RoboticArmMachine::getBaseAngle() const
-{
-    return baseServo->getCurrentAngle();
-}
-
-int RoboticArmMachine::getElbowAngle() const
+int RoboticArmMachine::getJointCount() const
 {
-    return elbowServo->getCurrentAngle();
+    return joints.getCount();
 }
 
-int RoboticArmMachine::getWristAngle() const
+int RoboticArmMachine::getJointAngle(int joint) const
 {
-    return wristServo->getCurrentAngle();
+    return (int)(joints.getPosition(joint) + 0.5f);
 }
 
-int RoboticArmMachine::getClawAngle() const
+const JointTable& RoboticArmMachine::getJoints() const
 {
-    return clawServo->getCurrentAngle();
+    return joints;
 }
 
 bool RoboticArmMachine::wasButtonWhitePressed()
@@ -195,6 +286,11 @@ String RoboticArmMachine::popCommand() {
     commandQueue.pop();
     numCommands--;
 
+    // Attività: rinvia il timeout di WORKING
+    if (currentState == STATE_WORKING) {
+        stateEntryTime = millis();
+    }
+
     Serial.printf("Comando estratto: %s (coda: %d)\n",
         cmd.c_str(), numCommands);
     
@@ -219,49 +315,129 @@ void RoboticArmMachine::clearCommands() {
 
 
 bool RoboticArmMachine::executeCommand(const String& cmd) {
-    int angle = DEFAULT_ANGLE_MOVE;
+    if (cmd.startsWith("CAL ")) {
+        return handleCalibrationCommand(cmd.substring(4));
+    }
 
-    if (cmd == "Base SX") {
-        int currentAngle = baseServo->getCurrentAngle();
-        moveBaseServo(currentAngle - angle);
-        return true;
+    if (isCalibrating()) {
+        Serial.println("Calibrazione in corso, comando ignorato");
+        return false;
     }
-    else if (cmd == "Base DX") {
-        int currentAngle = baseServo->getCurrentAngle();
-        moveBaseServo(currentAngle + angle);
-        return true;
+
+    if (isParking()) {
+        Serial.println("Parcheggio in corso, comando ignorato");
+        return false;
     }
-    else if (cmd == "Elbow SX") {
-        int currentAngle = elbowServo->getCurrentAngle();
-        moveElbowServo(currentAngle - angle);
+
+    if (cmd.startsWith("FEED ")) {
+        setFeedRate(cmd.substring(5).toInt());
         return true;
     }
-    else if (cmd == "Elbow DX") {
-        int currentAngle = elbowServo->getCurrentAngle();
-        moveElbowServo(currentAngle + angle);
+
+    if (cmd.startsWith("POWER ")) {
+        setSupplyBudget(cmd.substring(6).toInt());
         return true;
     }
-    else if (cmd == "Wrist SX") {
-        int currentAngle = wristServo->getCurrentAngle();
-        moveWristServo(currentAngle - angle);
-        return true;
+
+    // "TEACH REC <nome>", "TEACH PLAY <nome>", "TEACH STOP"
+    if (cmd.startsWith("TEACH ")) {
+        return handleTeachCommand(cmd.substring(6));
     }
-    else if (cmd == "Wrist DX") {
-        int currentAngle = wristServo->getCurrentAngle();
-        moveWristServo(currentAngle + angle);
-        return true;
+
+    // "SCRIPT RUN <nome>", "SCRIPT CHECK <nome>", "SCRIPT STOP"
+    if (cmd.startsWith("SCRIPT ")) {
+        return handleScriptCommand(cmd.substring(7));
+    }
+
+    // Durante riproduzione e script i giunti seguono il programma
+    if (teachMode >= TEACH_LOADING) {
+        Serial.println("Riproduzione in corso, comando ignorato");
+        return false;
+    }
+
+    if (scriptRunner.isRunning()) {
+        Serial.println("Script in corso, comando ignorato");
+        return false;
     }
-    else if (cmd == "Claw Open") {
-        int currentAngle = clawServo->getCurrentAngle();
-        moveClawServo(currentAngle + angle);
+
+    // Più pulsanti in un messaggio di testo (seriale o controller con
+    // ARM_FRAME_TEXT_COMPAT = 1): tutti i jog nello stesso tick, come
+    // il frame binario che il controller invia di default
+    const char* names[MAX_JOINTS];
+    for (int i = 0; i < joints.getCount(); i++) {
+        names[i] = joints.getName(i);
+    }
+    ArmFrame jogs;
+    if (JogList::parse(cmd.c_str(), names, joints.getCount(), jogs) > 1) {
+        return applyFrame(jogs);
+    }
+
+    // Il rilascio ferma la retta lungo il percorso
+    if (cmd == "LINE STOP") {
+        cartesian.stop();
         return true;
     }
-    else if (cmd == "Claw Close") {
-        int currentAngle = clawServo->getCurrentAngle();
-        moveClawServo(currentAngle - angle);
+
+    // "CJOG X+/X-/.../Z STOP": jog cartesiano della pinza
+    if (cmd.startsWith("CJOG ")) {
+        return handleCartesianJog(cmd.substring(5));
+    }
+
+    // Durante retta e jog cartesiano base, gomito e polso seguono la
+    // cinematica: si possono comandare solo gli altri giunti
+    int space = cmd.indexOf(' ');
+    int joint = joints.find(cmd.substring(0, space));
+    if (cartesian.isActive() && (joint < 0 || (KIN_JOINT_MASK & (1 << joint)))) {
+        Serial.println("Movimento cartesiano in corso, comando ignorato");
+        return false;
+    }
+
+    // "MOVE x y z [pitch]" in mm e gradi; "LINE ..." in linea retta
+    if (cmd.startsWith("MOVE ")) {
+        return handleMoveCommand(cmd.substring(5), false);
+    }
+
+    if (cmd.startsWith("LINE ")) {
+        return handleMoveCommand(cmd.substring(5), true);
+    }
+
+    if (cmd.startsWith("IK ")) {
+        String branch = cmd.substring(3);
+        if (branch == "UP") {
+            setIkBranch(IK_ELBOW_UP);
+        }
+        else if (branch == "DOWN") {
+            setIkBranch(IK_ELBOW_DOWN);
+        }
+        else if (branch == "ANY") {
+            setIkBranch(IK_ELBOW_ANY);
+        }
+        else {
+            Serial.println("Ramo IK non valido: " + branch);
+            return false;
+        }
         return true;
     }
 
+    // "<Giunto> SX/DX/Open/Close" avvia o rinnova il jog,
+    // "<Giunto> STOP" è il rilascio del pulsante
+    ServoMotor* servo = joints.get(joint);
+    if (servo == nullptr || space < 0) {
+        Serial.println("❌ Comando non riconosciuto");
+        return false;
+    }
+
+    String action = cmd.substring(space + 1);
+    if (action == "STOP") {
+        return jogJoint(joint, 0.0f);
+    }
+    else if (action == "DX" || action == "Open") {
+        return jogJoint(joint, JOG_VELOCITY);
+    }
+    else if (action == "SX" || action == "Close") {
+        return jogJoint(joint, -JOG_VELOCITY);
+    }
+
     Serial.println("❌ Comando non riconosciuto");
     return false;
 }
@@ -329,6 +505,7 @@ void RoboticArmMachine::servoErrorResolved()
     Serial.println("Servo error resolved");
     this->servoErrorFlag = false;
     this->lastErrorMsg = "";
+    health.clearFault();
     transitionTo(STATE_CONNECTED);
 }
 
@@ -344,198 +521,1685 @@ void RoboticArmMachine::receiveCommand(String command)
 
 // MOVIMENTO SERVO
 
-void RoboticArmMachine::moveBaseServo(int angle)
+bool RoboticArmMachine::moveJoint(int joint, float angle)
 {
-    baseServo->startSmoothMove(pwm, angle, 180, 0);
+    ServoMotor *servo = joints.get(joint);
+    if (servo == nullptr)
+        return false;
+
+    // Gomito e polso passano dal waypoint di più giunti (vedi queuePose)
+    if ((1 << joint) & COLLISION_JOINT_MASK)
+    {
+        float angles[MAX_JOINTS];
+        angles[joint] = angle;
+        return queuePose(angles, 1 << joint);
+    }
+
+    if (!servo->queueMove(angle))
+        return false;
+
+    joints.sync();
+    return true;
 }
 
-void RoboticArmMachine::moveElbowServo(int angle)
+
+bool RoboticArmMachine::queuePose(const float pose[], JointMask mask, float cruiseTime)
 {
-    elbowServo->startSmoothMove(pwm, angle, 180, 0);
+    float angles[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        angles[joint] = pose[joint];
+    }
+
+    // Gomito e polso sempre nello stesso waypoint (l'altro resta fermo):
+    // così il tratto controllato da clipCollisions è quello eseguito
+    if (mask & COLLISION_JOINT_MASK)
+    {
+        for (int joint = 0; joint < joints.getCount(); joint++)
+        {
+            if ((COLLISION_JOINT_MASK & ~mask) & (1 << joint))
+                angles[joint] = joints.getTarget(joint);
+        }
+        mask |= COLLISION_JOINT_MASK;
+    }
+
+    if (!clipCollisions(angles, mask))
+        return false;
+
+    if (!JointTable::queueSync(joints.getServos(), joints.getCount(), angles, mask, 0.0f, cruiseTime))
+    {
+        Serial.println("Waypoint scartato");
+        return false;
+    }
+
+    joints.sync();
+    return true;
 }
 
-void RoboticArmMachine::moveWristServo(int angle)
+bool RoboticArmMachine::moveTo(float x, float y, float z, bool hasPitch, float pitch)
 {
-    wristServo->startSmoothMove(pwm, angle, 180, 0);
+    IkTarget target = {x, y, z, hasPitch, pitch, ikBranch};
+    IkLimits limits;
+    float current[KIN_AXES];
+
+    // Partenza dagli ultimi target
+    getIkLimits(limits);
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        current[axis] = joints.getTarget(KIN_JOINTS[axis]);
+    }
+
+    float solution[KIN_AXES];
+    unsigned long start = micros();
+    int result = kinematics.inverse(target, limits, current, solution);
+    lastIkMicros = micros() - start;
+
+    if (result != IK_OK)
+    {
+        Serial.printf("MOVE %.1f %.1f %.1f: %s\n", x, y, z, Kinematics::resultName(result));
+        return false;
+    }
+
+    float angles[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        angles[joint] = joints.getTarget(joint);
+    }
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        angles[KIN_JOINTS[axis]] = solution[axis];
+    }
+
+    return queuePose(angles, KIN_JOINT_MASK);
 }
 
-void RoboticArmMachine::moveClawServo(int angle)
+bool RoboticArmMachine::moveLine(float x, float y, float z, bool hasPitch, float pitch)
 {
-    clawServo->startSmoothMove(pwm, angle, 180, 0);
-}
+    if (isAnyServoMoving())
+    {
+        Serial.println("LINE: giunti in movimento");
+        return false;
+    }
+
+    // La retta parte dalla posizione effettiva, con i limiti attuali
+    float current[KIN_AXES];
+    configureCartesian(current);
+
+    IkTarget target = {x, y, z, hasPitch, pitch, IK_ELBOW_ANY};
+    float feed = joints.get(0)->getFeedRate();
+    int result = cartesian.begin(current, target, CARTESIAN_SPEED * feed, CARTESIAN_ACCEL);
+
+    if (result != CART_OK)
+    {
+        Serial.printf("LINE %.1f %.1f %.1f: %s\n", x, y, z,
+                      result == CART_IK_FAILED ? Kinematics::resultName(cartesian.getIkResult()) : "Richiesta non valida");
+        return false;
+    }
 
+    Serial.printf("LINE: %.1fmm a %.0fmm/s\n", cartesian.getLength(), CARTESIAN_SPEED * feed);
+    return true;
+}
 
 /**
- * Aggiorna tutti i movimenti servo in corso
- * Chiamato dal MotionTask ogni 20ms (50Hz)
+ * "X+", "X-", "X STOP" (anche Y e Z)
  */
-void RoboticArmMachine::updateServoMovements()
+bool RoboticArmMachine::handleCartesianJog(const String& arg)
 {
-    // Aggiorna ogni servo
-    // updateSmoothMove() ritorna true quando completato
-    baseServo->updateSmoothMove(pwm);
-    elbowServo->updateSmoothMove(pwm);
-    wristServo->updateSmoothMove(pwm);
-    clawServo->updateSmoothMove(pwm);
+    int axis = arg.length() > 0 ? String("XYZ").indexOf(arg[0]) : -1;
+    String action = arg.substring(1);
+    action.trim();
+
+    float velocity;
+    if (action == "+")
+        velocity = CARTESIAN_JOG_SPEED * joints.get(0)->getFeedRate();
+    else if (action == "-")
+        velocity = -CARTESIAN_JOG_SPEED * joints.get(0)->getFeedRate();
+    else if (action == "STOP")
+        velocity = 0.0f;
+    else
+        axis = -1;
+
+    if (axis < 0)
+    {
+        Serial.println("Comando CJOG non valido: " + arg);
+        return false;
+    }
+
+    return jogTool(axis, velocity);
 }
 
 /**
- * Verifica se almeno un servo è in movimento
- * @return true se qualche servo sta ancora muovendosi
+ * Jog di un giunto (gradi/s con segno, 0 = rilascio)
  */
-bool RoboticArmMachine::isAnyServoMoving() const
+bool RoboticArmMachine::jogJoint(int joint, float velocity)
 {
-    return baseServo->isMoving() || 
-           elbowServo->isMoving() || 
-           wristServo->isMoving() || 
-           clawServo->isMoving();
-}
+    ServoMotor *servo = joints.get(joint);
+    if (servo == nullptr)
+        return false;
 
+    if (velocity == 0.0f)
+    {
+        servo->jogStop();
+        return true;
+    }
 
-void RoboticArmMachine::moveAllToSafePosition()
-{
-    Serial.println("Moving all servos to SAFE position...");
-    baseServo->moveToSafePosition(pwm, SAFE_RANGE_DEFAULT);
-    elbowServo->moveToSafePosition(pwm, SAFE_RANGE_ELBOW);
-    wristServo->moveToSafePosition(pwm, SAFE_RANGE_DEFAULT);
-    clawServo->moveToSafePosition(pwm, SAFE_MIN_RANGE_CLAW);
+    // Finestra senza collisioni, aggiornata a ogni rinnovo del jog
+    setCollisionWindow(joint);
+    servo->jog(velocity);
+    return true;
 }
 
-void RoboticArmMachine::moveAllToCenter()
+/**
+ * Jog cartesiano di un asse della pinza (mm/s con segno, 0 = rilascio)
+ */
+bool RoboticArmMachine::jogTool(int axis, float velocity)
 {
-    Serial.println("Moving all servos to CENTER...");
-    baseServo->moveToCenter(pwm);
-    elbowServo->moveToCenter(pwm);
-    wristServo->moveToCenter(pwm);
-    clawServo->moveToCenter(pwm);
+    float current[KIN_AXES];
+    if (!cartesian.isJogging())
+    {
+        // Rilascio arrivato dopo la fine del jog
+        if (velocity == 0.0f)
+            return true;
+
+        if (joints.getMovingMask() & KIN_JOINT_MASK)
+        {
+            Serial.println("CJOG: giunti in movimento");
+            return false;
+        }
+        configureCartesian(current);
+    }
+
+    return cartesian.jog(current, axis, velocity, CARTESIAN_ACCEL);
 }
 
-bool RoboticArmMachine::areAllAngleSafe()
+/**
+ * Limiti e velocità dei giunti per retta e jog, angoli di partenza
+ */
+void RoboticArmMachine::configureCartesian(float current[KIN_AXES])
 {
-    return baseServo->isAngleSafe(this->baseServo->getCurrentAngle()) &&
-           elbowServo->isAngleSafe(this->elbowServo->getCurrentAngle()) &&
-           wristServo->isAngleSafe(this->wristServo->getCurrentAngle()) &&
-           clawServo->isAngleSafe(this->clawServo->getCurrentAngle());
+    IkLimits limits;
+    float velocities[KIN_AXES];
+    getIkLimits(limits);
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        velocities[axis] = joints.get(KIN_JOINTS[axis])->getMaxVelocity();
+        current[axis] = joints.getPosition(KIN_JOINTS[axis]);
+    }
+    cartesian.configure(&kinematics, limits, velocities);
 }
 
-void RoboticArmMachine::setSafetyEnabled(bool enabled)
+void RoboticArmMachine::getIkLimits(IkLimits& limits) const
 {
-    baseServo->setSafetyEnabled(enabled);
-    elbowServo->setSafetyEnabled(enabled);
-    wristServo->setSafetyEnabled(enabled);
-    clawServo->setSafetyEnabled(enabled);
+    // Limiti di sicurezza dei servo
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        ServoMotor *servo = joints.get(KIN_JOINTS[axis]);
+        limits.minAngle[axis] = servo->getSafeMinAngle();
+        limits.maxAngle[axis] = servo->getSafeMaxAngle();
+    }
+
+    // Pose senza collisioni tra gomito e polso
+    limits.filter = CollisionMap::filter;
+    limits.filterContext = (void *)&collisions;
 }
 
+/**
+ * Accorcia il segmento di gomito e polso (in spazio giunti, dagli ultimi
+ * target) alla parte senza collisioni; gli altri giunti della maschera
+ * si fermano alla stessa frazione. Il segmento retto è il percorso
+ * eseguito: queuePose accoda gomito e polso con un profilo comune
+ * (JointTable::queueSync). Il parcheggio non passa di qui.
+ * @param angles Angoli indicizzati con JointIndex (validi nella maschera),
+ *               riscritti se il movimento viene accorciato
+ * @return false se non resta nessun passo sicuro
+ */
+bool RoboticArmMachine::clipCollisions(float angles[], JointMask mask)
+{
+    if (!(mask & COLLISION_JOINT_MASK))
+        return true;
 
-// STATO: START
+    float start[MAX_JOINTS];
+    float end[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        start[joint] = joints.getTarget(joint);
+        end[joint] = (mask & (1 << joint)) ? angles[joint] : start[joint];
+    }
 
-void RoboticArmMachine::enterStart()
-{
-    setLedState(false, false);
-    stateEntryTime = millis();
-}
+    float fraction = collisions.clip(start[JOINT_ELBOW], start[JOINT_WRIST], end[JOINT_ELBOW], end[JOINT_WRIST]);
+    if (fraction >= 1.0f)
+        return true;
 
-void RoboticArmMachine::handleStart()
-{
-    unsigned long elapsed = millis() - stateEntryTime;
+    if (fraction <= 0.0f)
+    {
+        collisionRejects++;
+        Serial.println("Collisione: movimento scartato");
+        return false;
+    }
 
-    // Simula connessione dopo 2 secondi
-    if (elapsed > 2000)
+    collisionClips++;
+    for (int joint = 0; joint < joints.getCount(); joint++)
     {
-        connectionEstablished();
+        if (mask & (1 << joint))
+        {
+            angles[joint] = start[joint] + (end[joint] - start[joint]) * fraction;
+        }
     }
+    Serial.printf("Collisione: movimento fermato al %.0f%%\n", fraction * 100.0f);
+    return true;
 }
 
-void RoboticArmMachine::exitStart()
+/**
+ * Limiti del jog di gomito o polso con l'altro giunto nella posizione
+ * attuale (gli altri giunti non hanno vincoli)
+ */
+void RoboticArmMachine::setCollisionWindow(int joint)
 {
-    Serial.println("Exit START\n");
-}
+    if (joint != JOINT_ELBOW && joint != JOINT_WRIST)
+        return;
 
+    float minAngle;
+    float maxAngle;
+    collisions.window(joint == JOINT_ELBOW ? KIN_ELBOW : KIN_WRIST,
+                      joints.get(JOINT_ELBOW)->getPosition(), joints.get(JOINT_WRIST)->getPosition(),
+                      minAngle, maxAngle);
+    joints.get(joint)->setJogWindow(minAngle, maxAngle);
+}
 
-// STATO: CONNECTED
+/**
+ * Un campione della retta per tick, scritto direttamente sui giunti
+ */
+void RoboticArmMachine::updateCartesian()
+{
+    if (!cartesian.isActive())
+    {
+        return;
+    }
 
+    float angles[KIN_AXES];
+    unsigned long start = micros();
+    bool sample = cartesian.step(MOTION_PERIOD_S, angles);
+    lastCartesianMicros = micros() - start;
+    if (lastCartesianMicros > maxCartesianMicros)
+    {
+        maxCartesianMicros = lastCartesianMicros;
+    }
 
-void RoboticArmMachine::enterConnected()
-{
-    setLedState(true, false);
-    stateEntryTime = millis();
-    Serial.println("System ready for commands\n");
-}
+    if (sample)
+    {
+        for (int axis = 0; axis < KIN_AXES; axis++)
+        {
+            joints.get(KIN_JOINTS[axis])->moveServo(pwm, angles[axis]);
+        }
+    }
 
-void RoboticArmMachine::handleConnected()
-{
-    // Monitoraggio rete
-    if (millis() - lastNetworkCheck > NETWORK_CHECK_INTERVAL)
+    if (cartesian.getState() == CART_FAILED)
     {
-        //checkNetwork();
-        lastNetworkCheck = millis();
+        Serial.printf("LINE interrotta a %.1f/%.1fmm: %s\n", cartesian.getTravelled(), cartesian.getLength(),
+                      cartesian.getError() == CART_SINGULAR ? "singolarità" : Kinematics::resultName(cartesian.getIkResult()));
     }
 }
 
-void RoboticArmMachine::exitConnected()
+void RoboticArmMachine::setIkBranch(int branch)
 {
-    Serial.println("Exit CONNECTED\n");
+    ikBranch = branch;
+    Serial.printf("IK: ramo %s\n", branch == IK_ELBOW_UP ? "UP" : (branch == IK_ELBOW_DOWN ? "DOWN" : "ANY"));
 }
 
-
-// STATO: WORKING
-
-
-void RoboticArmMachine::enterWorking()
+/**
+ * "x y z [pitch]" per MOVE (spazio giunti) e LINE (retta)
+ */
+bool RoboticArmMachine::handleMoveCommand(const String& arg, bool straight)
 {
-    setLedState(true, true); // Entrambi LED accesi
-    stateEntryTime = millis();
+    float values[4];
+    int count = 0;
+    int start = 0;
 
-}
+    while (start < (int)arg.length() && count < 4)
+    {
+        int end = arg.indexOf(' ', start);
+        if (end < 0)
+            end = arg.length();
+        if (end > start)
+            values[count++] = arg.substring(start, end).toFloat();
+        start = end + 1;
+    }
 
-void RoboticArmMachine::handleWorking()
-{
-    // Controlla salute servo
-    if (millis() - lastServoCheck > SERVO_CHECK_INTERVAL)
+    if (count < 3)
     {
-        //checkServoHealth();
-        lastServoCheck = millis();
+        Serial.println(straight ? "Uso: LINE x y z [pitch]" : "Uso: MOVE x y z [pitch]");
+        return false;
     }
 
-    // Timeout dopo 30 secondi
-    if (millis() - stateEntryTime > 30000)
+    bool hasPitch = count == 4;
+    float pitch = hasPitch ? values[3] : 0.0f;
+    if (straight)
     {
-        stopWorking();
+        return moveLine(values[0], values[1], values[2], hasPitch, pitch);
     }
+    return moveTo(values[0], values[1], values[2], hasPitch, pitch);
 }
 
-void RoboticArmMachine::exitWorking()
+/**
+ * Aggiorna tutti i movimenti servo in corso
+ * Chiamato dal MotionTask ogni 20ms (50Hz)
+ */
+void RoboticArmMachine::updateServoMovements()
 {
-    Serial.println("Exit WORKING\n");
+    // Parcheggio, script e stream G-code accodano i movimenti prima dell'ammissione
+    parking.update(millis());
+    updateScript();
+    updateGcode();
+
+    // I waypoint di più giunti partono solo con tutti i loro giunti pronti,
+    // poi le partenze vengono ammesse, scalate o rimandate secondo il budget
+    joints.holdIncompleteGroups();
+    power.admit(joints.getServos(), joints.getCount());
+
+    // Campione della retta cartesiana o della riproduzione
+    // (prima dell'aggiornamento degli array)
+    updateCartesian();
+    updatePlayback();
+
+    // Aggiorna ogni servo e gli array di stato
+    joints.update(pwm);
+    updateCalibration();
+
+    // Un frame per scheda con tutti i canali cambiati nel tick
+    pwm.flush();
+    updatePhaseCorrection();
+
+    // Contatori di salute (il guasto viene gestito dallo stato)
+    health.update(joints, pwm.getPipeline(), millis());
+
+    updateSnapshot();
+    updateRecording();
 }
 
+/**
+ * Copia lo stato del tick e calcola la posa della pinza
+ * (cinematica in virgola fissa, costo fisso)
+ */
+void RoboticArmMachine::updateSnapshot()
+{
+    snapshot.state = currentState;
+    snapshot.time = millis();
+    snapshot.jointCount = joints.getCount();
+    snapshot.movingMask = joints.getMovingMask();
 
-// STATO: PROBLEM_SERVO
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        snapshot.positions[joint] = joints.getPosition(joint);
+    }
 
+    float servoAngles[KIN_AXES];
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        servoAngles[axis] = joints.getPosition(KIN_JOINTS[axis]);
+    }
+    kinematics.forward(servoAngles, snapshot.tool);
+}
 
-void RoboticArmMachine::enterProblemServo()
+const ArmSnapshot& RoboticArmMachine::getSnapshot() const
 {
+    return snapshot;
+}
 
-    setLedState(false, true); // Solo LED rosso
-    Serial.printf(" Error: %s\n\n", lastErrorMsg.c_str());
+const Kinematics& RoboticArmMachine::getKinematics() const
+{
+    return kinematics;
+}
 
-    bringToSafePosition();
-    stateEntryTime = millis();
+/**
+ * Verifica se almeno un servo è in movimento
+ * @return true se qualche servo sta ancora muovendosi
+ */
+bool RoboticArmMachine::isAnyServoMoving() const
+{
+    return joints.getMovingMask() != 0 || cartesian.isActive() || teachMode >= TEACH_LOADING;
 }
 
-void RoboticArmMachine::handleProblemServo()
+bool RoboticArmMachine::canAcceptMotion() const
 {
-    // Auto-recovery dopo 3 secondi
-    if (millis() - stateEntryTime > ERROR_RECOVERY_TIMEOUT)
+    for (int joint = 0; joint < joints.getCount(); joint++)
     {
-        servoErrorResolved();
+        if (!joints.get(joint)->canQueueMove())
+            return false;
     }
+    return true;
 }
 
-void RoboticArmMachine::exitProblemServo()
+void RoboticArmMachine::stopAllServos(StopMode mode)
 {
-    Serial.println("✅ Exit PROBLEM_SERVO\n");
-}
+    parking.abort();
+    scriptRunner.stop();
+
+    // Le righe già inviate dall'host non devono ripartire da sole
+    if (gcodeActive || !gcode.isEmpty())
+    {
+        gcode.halt();
+        gcodeActive = false;
+        gcodeDwellStart = 0;
+        Serial.println("G-code: halt, M999 per riprendere");
+    }
+    if (teachMode >= TEACH_LOADING)
+        endPlayback("fermata");
+    if (mode == STOP_RAMP)
+        cartesian.stop();
+    else
+        cartesian.abort();
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        joints.get(joint)->stopMove(mode);
+    }
+    joints.sync();
+}
+
+void RoboticArmMachine::moveAllToSafePosition()
+{
+    Serial.println("Moving all servos to SAFE position...");
+    float targets[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        targets[joint] = joints.getParkAngle(joint);
+    }
+    startParking(targets);
+}
+
+void RoboticArmMachine::moveAllToCenter()
+{
+    Serial.println("Moving all servos to CENTER...");
+    float targets[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        ServoMotor *servo = joints.get(joint);
+        targets[joint] = (servo->getSafeMinAngle() + servo->getSafeMaxAngle()) / 2;
+    }
+    startParking(targets);
+}
+
+void RoboticArmMachine::setParkingOrder(const JointMask* masks, int count)
+{
+    parking.setOrder(masks, count);
+}
+
+bool RoboticArmMachine::isParking() const
+{
+    return parking.isActive();
+}
+
+int RoboticArmMachine::getParkingState() const
+{
+    return parking.getState();
+}
+
+void RoboticArmMachine::setSupplyBudget(int milliAmps)
+{
+    power.setBudget(constrain(milliAmps, 500, 20000));
+}
+
+const PowerBudget& RoboticArmMachine::getPowerBudget() const
+{
+    return power;
+}
+
+const ServoHealth& RoboticArmMachine::getHealth() const
+{
+    return health;
+}
+
+/**
+ * Scarto tra l'invio del frame e il punto ideale prima del fronte PWM:
+ * il tick viene spostato di 1ms per volta finché lo scarto non rientra
+ * nella banda morta
+ */
+void RoboticArmMachine::updatePhaseCorrection()
+{
+    unsigned long now = micros();
+    phaseCorrection = 0;
+
+    if (!sync.isLocked(now))
+    {
+        return;
+    }
+
+    long error = sync.phaseError(now, PWM_SYNC_LEAD_US);
+    if (error > PWM_SYNC_DEADBAND_US)
+    {
+        phaseCorrection = 1;
+    }
+    else if (error < -PWM_SYNC_DEADBAND_US)
+    {
+        phaseCorrection = -1;
+    }
+}
+
+long RoboticArmMachine::getOutputPhaseCorrection() const
+{
+    return phaseCorrection;
+}
+
+const PwmSync& RoboticArmMachine::getPwmSync() const
+{
+    return sync;
+}
+
+void RoboticArmMachine::startParking(const float targets[])
+{
+    cartesian.abort();
+    parking.begin(joints.getServos(), targets, joints.getCount(), millis());
+    joints.sync();
+}
+
+bool RoboticArmMachine::areAllAngleSafe()
+{
+    return joints.getUnsafeMask() == 0;
+}
+
+void RoboticArmMachine::setSafetyEnabled(bool enabled)
+{
+    joints.setSafetyEnabled(enabled);
+}
+
+
+// TEACH E RIPRODUZIONE
+
+/**
+ * "REC <nome>", "PLAY <nome>", "STOP"
+ */
+bool RoboticArmMachine::handleTeachCommand(const String& arg)
+{
+    if (arg == "STOP")
+    {
+        stopTeach();
+        return true;
+    }
+
+    int space = arg.indexOf(' ');
+    String action = space < 0 ? arg : arg.substring(0, space);
+    String name = space < 0 ? "" : arg.substring(space + 1);
+    name.trim();
+
+    if (action == "REC")
+        return startTeach(name.c_str());
+    if (action == "PLAY")
+        return startPlayback(name.c_str());
+
+    Serial.println("Uso: TEACH REC <nome> | TEACH PLAY <nome> | TEACH STOP");
+    return false;
+}
+
+bool RoboticArmMachine::startTeach(const char* name)
+{
+    if (teachMode != TEACH_OFF)
+    {
+        Serial.println("Teach: registrazione o riproduzione già attiva");
+        return false;
+    }
+
+    // Il task può ancora scrivere la registrazione precedente
+    if (!teachStore.record(name))
+    {
+        Serial.printf("Teach: impossibile registrare \"%s\" (%s)\n", name,
+                      teachStore.isReady() ? "archivio occupato o nome non valido" : "LittleFS non disponibile");
+        return false;
+    }
+
+    TrajectoryHeader header = {(uint8_t)joints.getCount(), MOTION_PERIOD_MS, TRAJ_UNITS_PER_DEG};
+    if (!teachEncoder.begin(&teachStore.getRing(), header))
+    {
+        teachStore.getRing().close();
+        return false;
+    }
+
+    teachMode = TEACH_RECORDING;
+    Serial.printf("Teach: registrazione \"%s\"\n", name);
+    return true;
+}
+
+bool RoboticArmMachine::startPlayback(const char* name)
+{
+    if (teachMode != TEACH_OFF || isAnyServoMoving() || scriptRunner.isRunning())
+    {
+        Serial.println("Teach: riproduzione solo a giunti fermi");
+        return false;
+    }
+
+    if (!teachStore.play(name))
+    {
+        Serial.printf("Teach: impossibile riprodurre \"%s\" (%s)\n", name,
+                      teachStore.isReady() ? "archivio occupato o nome non valido" : "LittleFS non disponibile");
+        return false;
+    }
+
+    teachDecoder.reset(&teachStore.getRing());
+    teachMode = TEACH_LOADING;
+    teachEntry = millis();
+    teachWaits = 0;
+    Serial.printf("Teach: riproduzione \"%s\"\n", name);
+    return true;
+}
+
+void RoboticArmMachine::stopTeach()
+{
+    if (teachMode == TEACH_RECORDING)
+    {
+        // Con il ring pieno il file resta valido fino all'ultimo record
+        teachEncoder.finish();
+        teachStore.getRing().close();
+        teachMode = TEACH_OFF;
+        Serial.printf("Teach: registrati %lu campioni in %lu byte\n", teachEncoder.getSamples(), teachEncoder.getBytes());
+    }
+    else if (teachMode != TEACH_OFF)
+    {
+        endPlayback("interrotta");
+    }
+}
+
+int RoboticArmMachine::getTeachMode() const
+{
+    return teachMode;
+}
+
+/**
+ * Un campione dei setpoint per tick, codificato nel ring (niente flash)
+ */
+void RoboticArmMachine::updateRecording()
+{
+    if (teachMode != TEACH_RECORDING)
+    {
+        return;
+    }
+
+    // Il task si è fermato (file non creato o flash piena)
+    if (teachStore.getMode() != STORE_RECORDING)
+    {
+        teachMode = TEACH_OFF;
+        const char* error = teachStore.getLastError();
+        Serial.printf("Teach: registrazione interrotta (%s)\n", error != nullptr ? error : "archivio");
+        return;
+    }
+
+    int16_t sample[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        sample[joint] = TrajectoryDecoder::quantize(snapshot.positions[joint]);
+    }
+
+    // Ring pieno: la flash non tiene il passo, il file resta valido fin qui
+    if (!teachEncoder.add(sample))
+    {
+        teachStore.getRing().close();
+        teachMode = TEACH_OFF;
+        Serial.printf("Teach: buffer pieno, registrazione interrotta a %lu campioni\n", teachEncoder.getSamples());
+    }
+}
+
+/**
+ * Riproduzione: primo campione con un movimento raccordato, poi un
+ * campione per tick scritto direttamente sui giunti
+ */
+void RoboticArmMachine::updatePlayback()
+{
+    if (teachMode < TEACH_LOADING)
+    {
+        return;
+    }
+
+    if (teachMode == TEACH_APPROACH)
+    {
+        if (joints.getMovingMask() == 0)
+        {
+            teachMode = TEACH_PLAYING;
+        }
+        return;
+    }
+
+    int16_t sample[MAX_JOINTS];
+    int status = teachDecoder.next(sample);
+
+    if (status == TRAJ_WAIT)
+    {
+        // Dati in ritardo: i giunti restano sull'ultimo campione
+        if (teachMode == TEACH_PLAYING)
+        {
+            teachWaits++;
+        }
+        else if (millis() - teachEntry > TEACH_LOAD_TIMEOUT_MS)
+        {
+            endPlayback("non riuscita: flash non risponde");
+        }
+        return;
+    }
+
+    if (status == TRAJ_END)
+    {
+        endPlayback(teachDecoder.isTruncated() ? "completata (registrazione senza fine)" : "completata");
+        return;
+    }
+
+    if (status == TRAJ_ERROR)
+    {
+        const char* error = teachStore.getLastError();
+        Serial.printf("Teach: %s\n", error != nullptr ? error : "file non valido");
+        endPlayback("non riuscita");
+        return;
+    }
+
+    if (teachMode == TEACH_LOADING)
+    {
+        const TrajectoryHeader& header = teachDecoder.getHeader();
+        if (header.jointCount != joints.getCount() || header.periodMs != MOTION_PERIOD_MS)
+        {
+            endPlayback("non riuscita: giunti o periodo diversi");
+            return;
+        }
+
+        for (int joint = 0; joint < joints.getCount(); joint++)
+        {
+            teachFirst[joint] = TrajectoryDecoder::toDegrees(sample[joint]);
+        }
+        if (!queuePose(teachFirst, (JointMask)((1 << joints.getCount()) - 1)))
+        {
+            endPlayback("non riuscita: primo campione non raggiungibile");
+            return;
+        }
+        teachMode = TEACH_APPROACH;
+        return;
+    }
+
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        joints.get(joint)->moveServo(pwm, TrajectoryDecoder::toDegrees(sample[joint]));
+    }
+}
+
+void RoboticArmMachine::endPlayback(const char* reason)
+{
+    teachStore.cancel();
+    teachMode = TEACH_OFF;
+    Serial.printf("Teach: riproduzione %s (%lu campioni, %lu tick senza dati)\n", reason,
+                  teachDecoder.getSamples(), teachWaits);
+}
+
+
+// SCRIPT
+
+/**
+ * "RUN <nome>", "CHECK <nome>", "STOP"
+ */
+bool RoboticArmMachine::handleScriptCommand(const String& arg)
+{
+    if (arg == "STOP")
+    {
+        stopScript();
+        return true;
+    }
+
+    int space = arg.indexOf(' ');
+    String action = space < 0 ? arg : arg.substring(0, space);
+    String name = space < 0 ? "" : arg.substring(space + 1);
+    name.trim();
+
+    if (action == "RUN")
+        return runScript(name.c_str());
+    if (action == "CHECK")
+        return checkScript(name.c_str());
+
+    Serial.println("Uso: SCRIPT RUN <nome> | SCRIPT CHECK <nome> | SCRIPT STOP");
+    return false;
+}
+
+bool RoboticArmMachine::runScript(const char* name)
+{
+    if (scriptRunner.isRunning() || isAnyServoMoving())
+    {
+        Serial.println("Script: avvio solo a giunti fermi");
+        return false;
+    }
+
+    // Niente movimenti da uno script che non passa il dry-run
+    ScriptReport report;
+    if (!loadScript(name, report))
+        return false;
+
+    scriptRunner.start(&script, this);
+    Serial.printf("Script %s: avviato (%d movimenti, ciclo stimato %.1fs)\n", scriptName, report.moves, report.cycleSeconds);
+    return true;
+}
+
+bool RoboticArmMachine::checkScript(const char* name)
+{
+    // Il programma in esecuzione non va sovrascritto
+    if (scriptRunner.isRunning())
+    {
+        Serial.println("Script: in esecuzione");
+        return false;
+    }
+
+    // Lettura da LittleFS e dry-run bloccano il MotionTask per più tick
+    if (isAnyServoMoving())
+    {
+        Serial.println("Script: verifica solo a giunti fermi");
+        return false;
+    }
+
+    ScriptReport report;
+    if (!loadScript(name, report))
+        return false;
+
+    Serial.printf("Script %s: OK, %d movimenti, ciclo stimato %.1fs%s\n", scriptName, report.moves, report.cycleSeconds,
+                  report.endless ? " (ripetuto fino a SCRIPT STOP)" : "");
+    return true;
+}
+
+void RoboticArmMachine::stopScript()
+{
+    if (!scriptRunner.isRunning())
+        return;
+
+    // L'istruzione in corso termina, le successive non partono
+    scriptRunner.stop();
+    Serial.printf("Script %s: fermato alla riga %d\n", scriptName, scriptRunner.getLine());
+}
+
+const ScriptRunner& RoboticArmMachine::getScriptRunner() const
+{
+    return scriptRunner;
+}
+
+/**
+ * Legge e compila SCRIPT_DIRECTORY/<nome>.txt, poi dry-run dagli ultimi target
+ * La lettura avviene una volta all'avvio, prima del primo movimento
+ */
+bool RoboticArmMachine::loadScript(const char* name, ScriptReport& report)
+{
+    size_t length = strlen(name);
+    if (length == 0 || length >= SCRIPT_NAME_LENGTH || strchr(name, '/') != nullptr)
+    {
+        Serial.println("Script: nome non valido");
+        return false;
+    }
+
+    char path[sizeof(SCRIPT_DIRECTORY) + SCRIPT_NAME_LENGTH + 5];
+    snprintf(path, sizeof(path), "%s/%s.txt", SCRIPT_DIRECTORY, name);
+
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file)
+    {
+        Serial.printf("Script: %s non trovato\n", path);
+        return false;
+    }
+    size_t size = file.read((uint8_t *)scriptSource, SCRIPT_MAX_SOURCE - 1);
+    bool truncated = file.available() > 0;
+    file.close();
+    scriptSource[size] = '\0';
+
+    if (truncated)
+    {
+        Serial.printf("Script: %s supera %d byte\n", path, SCRIPT_MAX_SOURCE - 1);
+        return false;
+    }
+
+    const char *names[MAX_JOINTS];
+    float start[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        names[joint] = joints.getName(joint);
+        start[joint] = joints.getTarget(joint);
+    }
+
+    // Errori di compilazione e di dry-run arrivano nello stesso report
+    ScriptConfig config = {names, joints.getCount(), JOINT_CLAW, SAFE_MAX_RANGE_CLAW, SAFE_MIN_RANGE_CLAW};
+    script.compile(scriptSource, config);
+    ScriptRunner::dryRun(script, *this, start, report);
+
+    if (!report.ok)
+    {
+        Serial.printf("Script %s, riga %d: %s\n", name, report.errorLine, report.error);
+        return false;
+    }
+
+    strcpy(scriptName, name);
+    return true;
+}
+
+void RoboticArmMachine::updateScript()
+{
+    if (!scriptRunner.isRunning())
+        return;
+
+    int state = scriptRunner.step(millis());
+    if (state == SCRIPT_DONE)
+    {
+        Serial.printf("Script %s: completato\n", scriptName);
+    }
+    else if (state == SCRIPT_FAILED)
+    {
+        Serial.printf("Script %s: movimento rifiutato alla riga %d\n", scriptName, scriptRunner.getLine());
+    }
+}
+
+// ScriptTarget
+
+bool RoboticArmMachine::isIdle()
+{
+    return joints.getMovingMask() == 0 && !cartesian.isActive();
+}
+
+bool RoboticArmMachine::moveJoints(const float angles[], uint16_t mask)
+{
+    return queuePose(angles, mask);
+}
+
+bool RoboticArmMachine::moveTool(const float target[4], bool hasPitch, bool straight)
+{
+    if (straight)
+        return moveLine(target[0], target[1], target[2], hasPitch, target[3]);
+    return moveTo(target[0], target[1], target[2], hasPitch, target[3]);
+}
+
+bool RoboticArmMachine::solveTool(const float target[4], bool hasPitch, const float current[], float angles[])
+{
+    IkTarget ik = {target[0], target[1], target[2], hasPitch, target[3], ikBranch};
+    IkLimits limits;
+    float from[KIN_AXES];
+    float solution[KIN_AXES];
+
+    getIkLimits(limits);
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        from[axis] = current[KIN_JOINTS[axis]];
+    }
+    if (kinematics.inverse(ik, limits, from, solution) != IK_OK)
+        return false;
+
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        angles[joint] = current[joint];
+    }
+    for (int axis = 0; axis < KIN_AXES; axis++)
+    {
+        angles[KIN_JOINTS[axis]] = solution[axis];
+    }
+    return true;
+}
+
+bool RoboticArmMachine::isPoseValid(const float angles[])
+{
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        ServoMotor *servo = joints.get(joint);
+        if (angles[joint] < servo->getSafeMinAngle() || angles[joint] > servo->getSafeMaxAngle())
+            return false;
+    }
+    return collisions.isSafe(angles[JOINT_ELBOW], angles[JOINT_WRIST]);
+}
+
+/**
+ * Stima senza ammissione di potenza né rallentamenti vicino alle singolarità
+ */
+float RoboticArmMachine::estimateTime(const float from[], const float to[], bool straight)
+{
+    if (straight)
+    {
+        float servoFrom[KIN_AXES];
+        float servoTo[KIN_AXES];
+        ToolPose start;
+        ToolPose end;
+        for (int axis = 0; axis < KIN_AXES; axis++)
+        {
+            servoFrom[axis] = from[KIN_JOINTS[axis]];
+            servoTo[axis] = to[KIN_JOINTS[axis]];
+        }
+        kinematics.forward(servoFrom, start);
+        kinematics.forward(servoTo, end);
+
+        float dx = Kinematics::toMm(end.x - start.x);
+        float dy = Kinematics::toMm(end.y - start.y);
+        float dz = Kinematics::toMm(end.z - start.z);
+        float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+
+        // Trapezio da fermo a fermo lungo la retta
+        float speed = CARTESIAN_SPEED * joints.get(0)->getFeedRate();
+        if (distance >= speed * speed / CARTESIAN_ACCEL)
+            return distance / speed + speed / CARTESIAN_ACCEL;
+        return 2.0f * sqrtf(distance / CARTESIAN_ACCEL);
+    }
+
+    float longest = 0.0f;
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        float time = joints.get(joint)->getRestToRestTime(from[joint], to[joint]);
+        if (time > longest)
+            longest = time;
+    }
+    return longest;
+}
+
+
+// STREAM G-CODE
+
+bool RoboticArmMachine::pushGcode(const char* line)
+{
+    return gcode.push(line);
+}
+
+const GcodeStream& RoboticArmMachine::getGcodeStream() const
+{
+    return gcode;
+}
+
+/**
+ * Esegue le righe in testa finché il planner le accetta; ogni risposta
+ * restituisce all'host il credito della riga
+ */
+void RoboticArmMachine::updateGcode()
+{
+    // Sulla seriale solo le risposte all'host finché lo stream è attivo
+    ServoMotor::setMotionLog(!gcodeActive && gcode.isEmpty());
+
+    for (int i = 0; i < GCODE_LINES_PER_TICK; i++)
+    {
+        const GcodeBlock *block = gcode.peek();
+        if (block == nullptr)
+        {
+            // Fine dello stream quando l'ultimo movimento è arrivato
+            if (gcodeActive && !isAnyServoMoving())
+                gcodeActive = false;
+            return;
+        }
+
+        const char *error = block->error;
+        int result = (block->command == GCODE_ERROR) ? GCODE_REJECTED : executeGcode(*block, error);
+        if (result == GCODE_WAIT)
+            return;
+
+        if (result == GCODE_DONE)
+            Serial.println("ok");
+        else
+            Serial.printf("error:%s\n", error);
+        gcode.pop();
+    }
+}
+
+int RoboticArmMachine::executeGcode(const GcodeBlock& block, const char*& error)
+{
+    switch (block.command)
+    {
+    case GCODE_MOVE:
+        return queueGcodeMove(block, error);
+
+    case GCODE_SYNC:
+        return isAnyServoMoving() ? GCODE_WAIT : GCODE_DONE;
+
+    case GCODE_DWELL:
+        // La pausa parte a braccio fermo
+        if (isAnyServoMoving())
+            return GCODE_WAIT;
+        if (gcodeDwellStart == 0)
+            gcodeDwellStart = millis() | 1;
+        if (millis() - gcodeDwellStart < block.dwellMs)
+            return GCODE_WAIT;
+        gcodeDwellStart = 0;
+        return GCODE_DONE;
+
+    case GCODE_REPORT:
+        reportPosition();
+        return GCODE_DONE;
+
+    case GCODE_INFO:
+        Serial.printf("cap:buffer %d joints %d\n", gcode.getCapacity(), joints.getCount());
+        return GCODE_DONE;
+
+    default:
+        return GCODE_DONE;
+    }
+}
+
+/**
+ * G0/G1: pinza con la cinematica inversa (partenza dagli ultimi target)
+ * o giunti diretti; con G1 la crociera dura distanza / F
+ */
+int RoboticArmMachine::queueGcodeMove(const GcodeBlock& block, const char*& error)
+{
+    if (isCalibrating() || isParking() || teachMode >= TEACH_LOADING || scriptRunner.isRunning() || cartesian.isActive())
+    {
+        error = "braccio occupato";
+        return GCODE_REJECTED;
+    }
+
+    // Il lookahead lavora sulla coda dei giunti: la riga aspetta lo spazio
+    if (!canAcceptMotion())
+        return GCODE_WAIT;
+
+    float angles[MAX_JOINTS];
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        angles[joint] = joints.getTarget(joint);
+    }
+
+    JointMask mask = 0;
+    float length = 0.0f;    // mm per la pinza, gradi per i giunti
+
+    if (block.toolMask != 0)
+    {
+        if (block.jointMask & KIN_JOINT_MASK)
+        {
+            error = "pinza e giunti della catena nella stessa riga";
+            return GCODE_REJECTED;
+        }
+
+        float servoAngles[KIN_AXES];
+        ToolPose pose;
+        for (int axis = 0; axis < KIN_AXES; axis++)
+        {
+            servoAngles[axis] = angles[KIN_JOINTS[axis]];
+        }
+        kinematics.forward(servoAngles, pose);
+
+        float from[GCODE_TOOL_WORDS] = {Kinematics::toMm(pose.x), Kinematics::toMm(pose.y), Kinematics::toMm(pose.z),
+                                        Kinematics::angleToDeg(pose.pitch)};
+        float target[GCODE_TOOL_WORDS];
+        for (int word = 0; word < GCODE_TOOL_WORDS; word++)
+        {
+            if (!(block.toolMask & (1 << word)))
+                target[word] = from[word];
+            else
+                target[word] = block.relative ? from[word] + block.tool[word] : block.tool[word];
+        }
+
+        if (!solveTool(target, (block.toolMask & (1 << GCODE_PITCH)) != 0, angles, angles))
+        {
+            error = "punto non raggiungibile";
+            return GCODE_REJECTED;
+        }
+
+        float dx = target[GCODE_X] - from[GCODE_X];
+        float dy = target[GCODE_Y] - from[GCODE_Y];
+        float dz = target[GCODE_Z] - from[GCODE_Z];
+        length = sqrtf(dx * dx + dy * dy + dz * dz);
+        mask |= KIN_JOINT_MASK;
+    }
+
+    for (int joint = 0; joint < joints.getCount() && joint < GCODE_MAX_JOINTS; joint++)
+    {
+        if (!(block.jointMask & (1 << joint)))
+            continue;
+
+        float angle = block.relative ? angles[joint] + block.joints[joint] : block.joints[joint];
+        if (block.toolMask == 0 && fabsf(angle - angles[joint]) > length)
+            length = fabsf(angle - angles[joint]);
+        angles[joint] = angle;
+        mask |= 1 << joint;
+    }
+
+    if (!isPoseValid(angles))
+    {
+        error = "fuori dai limiti o in collisione";
+        return GCODE_REJECTED;
+    }
+
+    float cruiseTime = (block.rapid || length <= 0.0f) ? 0.0f : length / block.feed;
+    if (!queuePose(angles, mask, cruiseTime))
+    {
+        error = "waypoint non accodato";
+        return GCODE_REJECTED;
+    }
+
+    gcodeActive = true;
+    return GCODE_DONE;
+}
+
+/**
+ * M114: posa della pinza e angoli all'ultimo tick
+ */
+void RoboticArmMachine::reportPosition()
+{
+    const ToolPose &tool = snapshot.tool;
+    Serial.printf("X:%.1f Y:%.1f Z:%.1f P:%.1f", Kinematics::toMm(tool.x), Kinematics::toMm(tool.y),
+                  Kinematics::toMm(tool.z), Kinematics::angleToDeg(tool.pitch));
+    for (int joint = 0; joint < joints.getCount() && joint < GCODE_MAX_JOINTS; joint++)
+    {
+        Serial.printf(" %c:%.1f", GCODE_JOINT_WORDS[joint], snapshot.positions[joint]);
+    }
+    Serial.println();
+}
+
+
+// FRAME BINARI ESP-NOW
+
+bool RoboticArmMachine::pushFrame(const ArmFrame& frame)
+{
+    bool pushed = false;
+
+    portENTER_CRITICAL(&frameLock);
+    if (frameCount < FRAME_QUEUE_SIZE)
+    {
+        frameQueue[(frameHead + frameCount) % FRAME_QUEUE_SIZE] = frame;
+        frameCount++;
+        pushed = true;
+    }
+    portEXIT_CRITICAL(&frameLock);
+
+    if (!pushed)
+        framesDropped++;
+    return pushed;
+}
+
+void RoboticArmMachine::processFrames()
+{
+    ArmFrame frame;
+
+    for (;;)
+    {
+        portENTER_CRITICAL(&frameLock);
+        bool available = frameCount > 0;
+        if (available)
+        {
+            frame = frameQueue[frameHead];
+            frameHead = (frameHead + 1) % FRAME_QUEUE_SIZE;
+            frameCount--;
+        }
+        portEXIT_CRITICAL(&frameLock);
+
+        if (!available)
+            return;
+        if (applyFrame(frame))
+        {
+            framesApplied++;
+
+            // Attività: rinvia il timeout di WORKING
+            if (currentState == STATE_WORKING)
+                stateEntryTime = millis();
+        }
+        else
+        {
+            framesRejected++;
+        }
+    }
+}
+
+/**
+ * Stessi vincoli dei comandi "<Giunto> SX/DX/STOP" e "CJOG", senza
+ * stringhe: un frame porta i jog e i rilasci di tutti i pulsanti
+ * @return false se almeno un jog è stato ignorato
+ */
+bool RoboticArmMachine::applyFrame(const ArmFrame& frame)
+{
+    if (frame.type != FRAME_JOG)
+        return false;
+
+    if (isCalibrating() || isParking() || teachMode >= TEACH_LOADING || scriptRunner.isRunning())
+    {
+        Serial.println("Frame di jog ignorato: braccio occupato");
+        return false;
+    }
+    bool applied = true;
+
+    // Prima gli assi della pinza: un rilascio libera i giunti della catena
+    for (int axis = 0; axis < ARM_FRAME_AXES && axis < KIN_AXES; axis++)
+    {
+        int bit = ARM_FRAME_AXIS_BIT(axis);
+        if (frame.mask & (1 << bit))
+        {
+            float scale = (float)frame.values[bit] / ARM_FRAME_FULL_SCALE;
+            applied = jogTool(axis, scale * CARTESIAN_JOG_SPEED * joints.get(0)->getFeedRate()) && applied;
+        }
+    }
+
+    for (int joint = 0; joint < joints.getCount() && joint < ARM_FRAME_MAX_JOINTS; joint++)
+    {
+        if (!(frame.mask & (1 << joint)))
+            continue;
+
+        float velocity = (float)frame.values[joint] / ARM_FRAME_FULL_SCALE * JOG_VELOCITY;
+        if (velocity != 0.0f && cartesian.isActive() && (KIN_JOINT_MASK & (1 << joint)))
+        {
+            Serial.println("Movimento cartesiano in corso, jog ignorato");
+            applied = false;
+            continue;
+        }
+        applied = jogJoint(joint, velocity) && applied;
+    }
+    return applied;
+}
+
+
+// CALIBRAZIONE
+
+bool RoboticArmMachine::startCalibration(const String& jointName)
+{
+    ServoMotor *servo = getServoByName(jointName);
+
+    if (servo == nullptr)
+    {
+        Serial.println("Giunto non valido: " + jointName);
+        return false;
+    }
+
+    if (isCalibrating())
+    {
+        Serial.println("Calibrazione già in corso");
+        return false;
+    }
+
+    if (isParking())
+    {
+        Serial.println("Parcheggio in corso");
+        return false;
+    }
+
+    // Parte sempre dalla curva nominale, la vecchia non deve influire
+    ServoCalibration nominal = servo->getCalibration();
+    nominal.setLinear(nominal.getMinAngle(), nominal.getMaxAngle(),
+                      servo->getMinPulse(), servo->getMaxPulse());
+
+    servo->stopMove();
+    calibrationServo = servo;
+    lastCalibrationState = CAL_IDLE;
+    calibrator.begin(nominal,
+                     servo->getSafeMinAngle(), servo->getSafeMaxAngle(),
+                     servo->getMinPulse(), servo->getMaxPulse(),
+                     millis());
+
+    Serial.printf("Calibrazione Ch%d avviata\n", servo->getChannel());
+    return true;
+}
+
+void RoboticArmMachine::setCalibrationProbe(CalibrationProbe probe, void* context)
+{
+    calibrator.setProbe(probe, context);
+}
+
+bool RoboticArmMachine::isCalibrating() const
+{
+    return calibrationServo != nullptr;
+}
+
+void RoboticArmMachine::loadCalibrations()
+{
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        ServoMotor *servo = joints.get(joint);
+        ServoCalibration cal = servo->getCalibration();
+        if (calibrationStore.load(servo->getBoard(), servo->getChannel(), cal))
+        {
+            servo->setCalibration(cal);
+        }
+    }
+}
+
+/**
+ * Avanza la calibrazione attiva
+ * Chiamato dal MotionTask insieme ai movimenti
+ */
+void RoboticArmMachine::updateCalibration()
+{
+    if (calibrationServo == nullptr)
+    {
+        return;
+    }
+
+    if (calibrator.update(millis()))
+    {
+        calibrationServo->writePulse(pwm, calibrator.getPulse());
+    }
+
+    int state = calibrator.getState();
+    if (state == lastCalibrationState)
+    {
+        return;
+    }
+    lastCalibrationState = state;
+
+    int channel = calibrationServo->getChannel();
+
+    if (state == CAL_WAIT_OPERATOR)
+    {
+        Serial.printf("Ch%d: punto %d (%.1f°) pulse %d - allinea con CAL +/- e conferma con CAL OK\n",
+                      channel, calibrator.getCurrentPoint(),
+                      calibrator.getCurrentAngle(), calibrator.getPulse());
+    }
+    else if (state == CAL_DONE)
+    {
+        if (calibrationServo->setCalibration(calibrator.getResult()) &&
+            calibrationStore.save(calibrationServo->getBoard(), channel, calibrator.getResult()))
+        {
+            Serial.printf("Ch%d: Calibrazione salvata\n", channel);
+        }
+        else
+        {
+            Serial.printf("Ch%d: Calibrazione non salvata\n", channel);
+        }
+    }
+    else if (state == CAL_FAILED)
+    {
+        Serial.printf("Ch%d: Calibrazione annullata\n", channel);
+    }
+
+    if (state == CAL_DONE || state == CAL_FAILED)
+    {
+        // Riporta il servo all'angolo comandato prima della calibrazione
+        calibrationServo->moveServo(pwm, calibrationServo->getCurrentAngle());
+        calibrationServo = nullptr;
+    }
+}
+
+bool RoboticArmMachine::handleCalibrationCommand(const String& arg)
+{
+    if (arg.startsWith("RESET "))
+    {
+        ServoMotor *servo = getServoByName(arg.substring(6));
+        if (servo == nullptr || isCalibrating())
+        {
+            return false;
+        }
+        servo->resetCalibration();
+        calibrationStore.erase(servo->getBoard(), servo->getChannel());
+        Serial.printf("Ch%d: Calibrazione azzerata\n", servo->getChannel());
+        return true;
+    }
+
+    if (!isCalibrating())
+    {
+        return startCalibration(arg);
+    }
+
+    if (arg == "+")
+    {
+        calibrator.nudge(CAL_NUDGE_FINE);
+    }
+    else if (arg == "-")
+    {
+        calibrator.nudge(-CAL_NUDGE_FINE);
+    }
+    else if (arg == "++")
+    {
+        calibrator.nudge(CAL_NUDGE_COARSE);
+    }
+    else if (arg == "--")
+    {
+        calibrator.nudge(-CAL_NUDGE_COARSE);
+    }
+    else if (arg == "OK")
+    {
+        calibrator.confirm();
+    }
+    else if (arg == "STOP")
+    {
+        calibrator.abort();
+    }
+    else
+    {
+        Serial.println("Comando calibrazione non valido: " + arg);
+        return false;
+    }
+
+    return true;
+}
+
+void RoboticArmMachine::setFeedRate(int percent)
+{
+    percent = constrain(percent, 5, 100);
+    joints.setFeedRate(percent / 100.0f);
+    Serial.printf("Feed rate: %d%%\n", percent);
+}
+
+int RoboticArmMachine::getFeedRate() const
+{
+    return (int)(joints.get(0)->getFeedRate() * 100.0f + 0.5f);
+}
+
+ServoMotor* RoboticArmMachine::getServoByName(const String& name) const
+{
+    return joints.get(joints.find(name));
+}
+
+
+// STATO: START
+
+void RoboticArmMachine::enterStart()
+{
+    setLedState(false, false);
+    stateEntryTime = millis();
+}
+
+void RoboticArmMachine::handleStart()
+{
+    unsigned long elapsed = millis() - stateEntryTime;
+
+    // Simula connessione dopo 2 secondi
+    if (elapsed > 2000)
+    {
+        connectionEstablished();
+    }
+}
+
+void RoboticArmMachine::exitStart()
+{
+    Serial.println("Exit START\n");
+}
+
+
+// STATO: CONNECTED
+
+
+void RoboticArmMachine::enterConnected()
+{
+    setLedState(true, false);
+    stateEntryTime = millis();
+    Serial.println("System ready for commands\n");
+}
+
+void RoboticArmMachine::handleConnected()
+{
+    // Monitoraggio rete
+    if (millis() - lastNetworkCheck > NETWORK_CHECK_INTERVAL)
+    {
+        //checkNetwork();
+        lastNetworkCheck = millis();
+    }
+}
+
+void RoboticArmMachine::exitConnected()
+{
+    Serial.println("Exit CONNECTED\n");
+}
+
+
+// STATO: WORKING
+
+
+void RoboticArmMachine::enterWorking()
+{
+    setLedState(true, true); // Entrambi LED accesi
+    stateEntryTime = millis();
+
+}
+
+void RoboticArmMachine::handleWorking()
+{
+    // Controlla salute servo
+    if (millis() - lastServoCheck > SERVO_CHECK_INTERVAL)
+    {
+        checkServoHealth();
+        lastServoCheck = millis();
+    }
+
+    // Timeout solo a braccio inattivo: stateEntryTime viene rinnovato
+    // da ogni comando o frame accettato
+    bool busy = gcodeActive || scriptRunner.isRunning() || teachMode >= TEACH_LOADING ||
+                cartesian.isActive() || joints.getMovingMask() != 0;
+    if (busy)
+    {
+        stateEntryTime = millis();
+    }
+    else if (millis() - stateEntryTime > WORKING_IDLE_TIMEOUT_MS)
+    {
+        stopWorking();
+    }
+}
+
+/**
+ * Porta il guasto rilevato da ServoHealth nella macchina a stati
+ */
+void RoboticArmMachine::checkServoHealth()
+{
+    if (!health.hasFault())
+    {
+        return;
+    }
+
+    const ServoFault &fault = health.getFault();
+    String msg = ServoHealth::faultName(fault.type);
+
+    if (fault.joint >= 0)
+    {
+        msg += " " + String(joints.getName(fault.joint)) + " (Ch" +
+               String(joints.get(fault.joint)->getChannel()) + ")";
+    }
+    msg += ": " + String(fault.value, 1);
+
+    servoError(msg);
+}
+
+void RoboticArmMachine::exitWorking()
+{
+    // Niente movimenti residui fuori da WORKING
+    stopAllServos(STOP_RAMP);
+    Serial.println("Exit WORKING\n");
+}
+
+
+// STATO: PROBLEM_SERVO
+
+
+void RoboticArmMachine::enterProblemServo()
+{
+
+    setLedState(false, true); // Solo LED rosso
+    Serial.printf(" Error: %s\n\n", lastErrorMsg.c_str());
+
+    // Guasto servo: nessuna rampa, si congela dove si è
+    stopAllServos(STOP_HOLD);
+    bringToSafePosition();
+    stateEntryTime = millis();
+}
+
+void RoboticArmMachine::handleProblemServo()
+{
+    // Auto-recovery dopo 3 secondi, a parcheggio concluso
+    if (millis() - stateEntryTime > ERROR_RECOVERY_TIMEOUT && !isParking())
+    {
+        servoErrorResolved();
+    }
+}
+
+void RoboticArmMachine::exitProblemServo()
+{
+    Serial.println("✅ Exit PROBLEM_SERVO\n");
+}
 
 
 // STATO: NETWORK_LOST
@@ -677,10 +2341,52 @@ String RoboticArmMachine::getDebugInfo() const
     info += "╚════════════════════════════════════╝\n\n";
 
     info += "State: " + getStateString() + "\n";
-    info += "Base: " + String(baseServo->getCurrentAngle()) + "°\n";
-    info += "Elbow: " + String(elbowServo->getCurrentAngle()) + "°\n";
-    info += "Wrist: " + String(wristServo->getCurrentAngle()) + "°\n";
-    info += "Claw: " + String(clawServo->getCurrentAngle()) + "°\n";
+    for (int joint = 0; joint < joints.getCount(); joint++)
+    {
+        info += String(joints.getName(joint)) + ": " + String(getJointAngle(joint)) + "° (ritardi " +
+                String(health.getOverruns(joint)) + ", saturazioni " + String(health.getSaturations(joint)) +
+                ", feedback " + String(health.getFeedbackErrors(joint)) + ")\n";
+    }
+    const ToolPose& tool = snapshot.tool;
+    info += "Tool: X " + String(Kinematics::toMm(tool.x), 1) + " Y " + String(Kinematics::toMm(tool.y), 1) +
+            " Z " + String(Kinematics::toMm(tool.z), 1) + "mm, pitch " +
+            String(Kinematics::angleToDeg(tool.pitch), 1) + "° (IK " + String(lastIkMicros) + "us)\n";
+    info += "Cartesiano: " + String(cartesian.getPaths()) + " rette, " + String(cartesian.getTravelled(), 1) + "/" +
+            String(cartesian.getLength(), 1) + "mm, rallentati " + String(cartesian.getScaledTicks()) + " tick (min " +
+            String(cartesian.getMinScale() * 100.0f, 0) + "%), jog al bordo " + String(cartesian.getJogLimits()) + ", tick " + String(lastCartesianMicros) + "us (max " +
+            String(maxCartesianMicros) + "us)\n";
+    info += "Teach: modo " + String(teachMode) + ", salvate " + String(teachStore.getSaved()) + ", ultimo file " +
+            String(teachStore.getFileBytes()) + " byte, tick senza dati " + String(teachWaits) + "\n";
+    info += "Script: " + String(scriptName[0] != '\0' ? scriptName : "-") + ", stato " + String(scriptRunner.getState()) +
+            ", riga " + String(scriptRunner.getLine()) + ", cicli " + String(scriptRunner.getCycles()) + "\n";
+    info += "G-code: buffer " + String(gcode.getCount()) + "/" + String(gcode.getCapacity()) +
+            ", righe " + String(gcode.getReceived()) + ", oltre i crediti " + String(gcode.getOverflows()) +
+            (gcode.isHalted() ? ", halt" : "") + "\n";
+    info += "Frame ESP-NOW: applicati " + String(framesApplied) + ", rifiutati " + String(framesRejected) +
+            ", scartati " + String(framesDropped) + "\n";
+    info += "Collisioni: griglia " + String(CollisionMap::matches(ARM_GEOMETRY) ? "aggiornata" : "DA RIGENERARE") +
+            ", movimenti fermati " + String(collisionClips) + ", scartati " + String(collisionRejects) + "\n";
+    info += "Health: guasti " + String(health.getFaultCount()) + ", errori I2C " +
+            String(health.getI2cErrors()) + "\n";
+    info += "Power: " + String(power.getReservedCurrent(), 0) + "/" + String(power.getBudget(), 0) +
+            "mA (picco " + String(power.getPeakCurrent(), 0) + "mA, scalati " + String(power.getScaledStarts()) +
+            ", rimandati " + String(power.getDelayedStarts()) + " per " +
+            String(power.getDelayedTicks() * MOTION_PERIOD_MS) + "ms)\n";
+    const PwmPipeline& pipeline = pwm.getPipeline();
+    info += "I2C: " + String(pwm.getBoardCount()) + " schede, ultimo frame " +
+            String(pwm.getLastFlushBytes()) + " byte in " + String(pipeline.getLastBusMicros()) +
+            "us (max " + String(pipeline.getMaxBusMicros()) + "us), errori " + String(pipeline.getErrors()) +
+            ", rimandati " + String(pipeline.getDeferred()) + ", ripresi " + String(pipeline.getReclaimed()) + "\n";
+    info += "PWM: " + String(pwm.getFrequency(0), 1) + "Hz, sync " +
+            String(sync.isLocked(micros()) ? "agganciato" : "libero") + " (" + String(sync.getEdges()) +
+            " fronti, correzione " + String(phaseCorrection) + "ms)\n";
+    const I2cLink& link = pipeline.getLink();
+    info += "I2C errori: NACK ind " + String(link.getErrors(I2C_NACK_ADDRESS)) +
+            ", NACK dati " + String(link.getErrors(I2C_NACK_DATA)) + ", timeout " + String(link.getErrors(I2C_TIMEOUT)) +
+            ", altri " + String(link.getErrors(I2C_OTHER)) + ", bus giù " + String(link.getErrors(I2C_BUS_DOWN)) +
+            " | retry " + String(link.getRetries()) + ", bloccato " + String(link.getStuckEvents()) +
+            ", recuperi " + String(link.getRecoveries()) + "/" +
+            String(link.getRecoveries() + link.getFailedRecoveries()) + "\n";
     info += "Network: " + String(networkConnected ? "Connected" : "Disconnected") + "\n";
     info += "Error: " + String(servoErrorFlag ? lastErrorMsg : "None") + "\n\n";
 
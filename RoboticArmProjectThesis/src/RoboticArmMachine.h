@@ -2,12 +2,24 @@
 #ifndef __RAM__
 #define __RAM__
 
-#include "include/ServoMG66R.h"
-#include "include/Servo20Diy.h"
+#include "include/JointTable.h"
 #include "include/set_up.h"
 #include "include/Led.h"
 #include "include/Button.h"
-#include <Adafruit_PWMServoDriver.h>
+#include "include/CalibrationRoutine.h"
+#include "include/CalibrationStore.h"
+#include "include/ParkingSequence.h"
+#include "include/PowerBudget.h"
+#include "include/ServoHealth.h"
+#include "include/PwmSync.h"
+#include "include/Kinematics.h"
+#include "include/CartesianPath.h"
+#include "include/CollisionMap.h"
+#include "include/TeachStore.h"
+#include "include/MotionScript.h"
+#include "include/GcodeStream.h"
+#include "include/JogList.h"
+#include <ArmFrame.h>
 #include <queue>
 
 
@@ -19,7 +31,53 @@
 #define MAX_RANGE_ELBOW 137
 #define SAFE_MIN_RANGE_CLAW 45
 #define SAFE_MAX_RANGE_CLAW 110
-#define DEFAULT_ANGLE_MOVE 10
+#define JOG_VELOCITY 60.0f  // Velocità di jog dei comandi "SX/DX" (gradi/s)
+// Fasi di parcheggio: prima si alza il gomito, poi polso e pinza, infine la base
+#define PARK_ORDER {(1 << JOINT_ELBOW), (1 << JOINT_WRIST) | (1 << JOINT_CLAW), (1 << JOINT_BASE)}
+#define CAL_NUDGE_FINE 1     // Step pulse per "CAL +" / "CAL -"
+#define CAL_NUDGE_COARSE 10  // Step pulse per "CAL ++" / "CAL --"
+#define IK_DEFAULT_BRANCH IK_ELBOW_UP  // Ramo preferito di "MOVE" (cambia con "IK UP/DOWN/ANY")
+#define CARTESIAN_SPEED 60.0f    // Velocità della pinza in "LINE" (mm/s, scalata dal feed rate)
+#define CARTESIAN_ACCEL 250.0f   // Accelerazione lungo la retta e del jog (mm/s²)
+#define CARTESIAN_JOG_SPEED 40.0f  // Velocità del jog "CJOG" per asse (mm/s, scalata dal feed rate)
+#define TEACH_LOAD_TIMEOUT_MS 1000  // Attesa dei primi dati di "TEACH PLAY"
+#define WORKING_IDLE_TIMEOUT_MS 30000  // WORKING → IDLE senza comandi né movimenti
+#define SCRIPT_DIRECTORY "/scripts"  // Script "SCRIPT RUN <nome>" (data/scripts, caricati con uploadfs)
+#define SCRIPT_MAX_SOURCE 2048       // Sorgente massimo di uno script (byte)
+#define GCODE_LINES_PER_TICK 4       // Righe G-code eseguite al più per tick
+#define FRAME_QUEUE_SIZE 8           // Frame ESP-NOW in attesa del tick di movimento
+
+// Indici dei giunti nella tabella ARM_JOINTS (bit delle JointMask)
+enum JointIndex
+{
+    JOINT_BASE = 0,
+    JOINT_ELBOW = 1,
+    JOINT_WRIST = 2,
+    JOINT_CLAW = 3
+};
+
+/**
+ * Istantanea dello stato del braccio, aggiornata ad ogni tick
+ */
+struct ArmSnapshot
+{
+    int state;
+    unsigned long time;             // millis() del tick
+    int jointCount;
+    float positions[MAX_JOINTS];    // Gradi servo
+    JointMask movingMask;
+    ToolPose tool;                  // Posa della pinza (cinematica diretta)
+};
+
+// Registrazione e riproduzione ("TEACH REC/PLAY/STOP")
+enum TeachMode
+{
+    TEACH_OFF = 0,
+    TEACH_RECORDING = 1,   // Un campione dei setpoint per tick
+    TEACH_LOADING = 2,     // In attesa dell'intestazione e del primo campione
+    TEACH_APPROACH = 3,    // Movimento raccordato fino al primo campione
+    TEACH_PLAYING = 4      // Un campione per tick sui giunti
+};
 
 enum RobotStateEnum
 {
@@ -31,7 +89,7 @@ enum RobotStateEnum
     STATE_IDLE = 5
 };
 
-class RoboticArmMachine
+class RoboticArmMachine : private ScriptTarget
 {
 
 public:
@@ -66,6 +124,20 @@ public:
      */
     bool executeCommand(const String& cmd);
 
+    // FRAME BINARI ESP-NOW
+
+    /**
+     * Accoda un frame già verificato (vedi ArmFrame.h): chiamabile dal
+     * callback ESP-NOW, che gira nel task del WiFi
+     * @return false se la coda è piena
+     */
+    bool pushFrame(const ArmFrame& frame);
+
+    /**
+     * Applica i frame in coda (dal MotionTask, prima dei comandi di testo)
+     */
+    void processFrames();
+
     // TRANSIZIONI PUBBLICHE
 
     void tryConnectToNetwork();
@@ -78,23 +150,184 @@ public:
     void receiveCommand(String command);
 
     // MOVIMENTO SERVO
-    void moveBaseServo(int angle);
-    void moveElbowServo(int angle);
-    void moveWristServo(int angle);
-    void moveClawServo(int angle);
+
+    /**
+     * Accoda un waypoint su un giunto (indice JointIndex)
+     * Gomito e polso si fermano prima di una collisione (vedi CollisionMap)
+     * e passano da queuePose()
+     */
+    bool moveJoint(int joint, float angle);
+
+    /**
+     * Waypoint dell'intero braccio: accoda su ogni giunto della maschera
+     * il suo tratto di un profilo comune (JointTable::queueSync), così
+     * che partano e arrivino insieme lungo il segmento retto in spazio
+     * giunti. Gomito e polso sono sempre nello stesso waypoint
+     * @param pose   Angoli indicizzati con JointIndex
+     * @param mask   Bit (1 << JointIndex) dei giunti da muovere
+     * @param cruiseTime Se > 0, durata della crociera (s): ogni giunto
+     *               procede a distanza / cruiseTime (velocità imposta,
+     *               allungata se un giunto non ci arriva)
+     * Se il segmento di gomito e polso entra in collisione, tutti i giunti
+     * vengono fermati alla stessa frazione del movimento. Il waypoint è
+     * raccordato solo se ogni giunto può attraversarlo senza fermarsi
+     * @return false se qualche coda è piena, un giunto è in jog o nessun
+     *         passo è sicuro (nessun giunto viene mosso)
+     */
+    bool queuePose(const float pose[], JointMask mask, float cruiseTime = 0.0f);
+
+    /**
+     * Porta la pinza in un punto (mm, pitch in gradi opzionale) con la
+     * cinematica inversa: base, gomito e polso arrivano insieme
+     * @return false se il punto non è raggiungibile nei limiti dei servo
+     */
+    bool moveTo(float x, float y, float z, bool hasPitch, float pitch);
+
+    /**
+     * Porta la pinza in linea retta fino al punto (mm), a velocità
+     * CARTESIAN_SPEED: un campione IK per tick, rallentato vicino alle
+     * singolarità. Solo a giunti fermi; "LINE STOP" decelera e ferma
+     * @return false se la retta esce dallo spazio raggiungibile
+     */
+    bool moveLine(float x, float y, float z, bool hasPitch, float pitch);
+
+    /**
+     * Ramo preferito della cinematica inversa (IkBranch)
+     */
+    void setIkBranch(int branch);
+
+    // TEACH E RIPRODUZIONE
+
+    /**
+     * Registra i setpoint di tutti i giunti, un campione per tick, fino a
+     * stopTeach(): qualunque comando di movimento (jog, MOVE, LINE...)
+     * viene registrato con i suoi tempi. Il file viene scritto dal task
+     * di TeachStore, non dal tick
+     * @param name Nome della registrazione (max TEACH_NAME_LENGTH)
+     */
+    bool startTeach(const char* name);
+
+    /**
+     * Riproduce una registrazione: raccordo fino al primo campione, poi
+     * un campione per tick letto dalla flash a blocchi. Solo a giunti
+     * fermi; durante la riproduzione gli altri movimenti sono ignorati
+     */
+    bool startPlayback(const char* name);
+
+    /**
+     * Chiude la registrazione o interrompe la riproduzione
+     */
+    void stopTeach();
+    int getTeachMode() const;
+
+    // SCRIPT
+
+    /**
+     * Carica SCRIPT_DIRECTORY/<nome>.txt, lo verifica con il dry-run e lo
+     * esegue: un passo per tick in updateServoMovements(). Solo a giunti
+     * fermi; durante lo script gli altri movimenti sono ignorati
+     */
+    bool runScript(const char* name);
+
+    /**
+     * Dry-run dalla posizione attuale: limiti, raggiungibilità, collisioni
+     * e durata stimata di un ciclo, senza muovere il braccio
+     */
+    bool checkScript(const char* name);
+    void stopScript();
+    const ScriptRunner& getScriptRunner() const;
+
+    // STREAM G-CODE
+
+    /**
+     * Accoda una riga G-code dell'host (vedi GcodeStream): eseguita in
+     * updateServoMovements() appena il planner ha spazio, con risposta
+     * "ok" o "error:..." sulla seriale
+     * @return false se il buffer è pieno (l'host ha superato i crediti)
+     */
+    bool pushGcode(const char* line);
+    const GcodeStream& getGcodeStream() const;
 
     void updateServoMovements();
     
     bool isAnyServoMoving() const;
 
+    /**
+     * true se tutte le code dei giunti hanno spazio per un waypoint
+     */
+    bool canAcceptMotion() const;
+
+    /**
+     * Ferma tutti i giunti e svuota le loro code
+     * @param mode STOP_HOLD (immediato) o STOP_RAMP (decelerazione)
+     */
+    void stopAllServos(StopMode mode);
+
+    /**
+     * Parcheggio ordinato e a velocità limitata (NON-BLOCCANTE)
+     * Procede in updateServoMovements(); isParking() resta true fino
+     * all'arrivo di tutti i giunti
+     */
     void moveAllToSafePosition();
 
+    /**
+     * Override di velocità per tutti i giunti (5-100%)
+     */
+    void setFeedRate(int percent);
+    int getFeedRate() const;
+
     void moveAllToCenter();
 
-    int getBaseAngle() const;
-    int getElbowAngle() const;
-    int getWristAngle() const;
-    int getClawAngle() const;
+    /**
+     * Ordine delle fasi di parcheggio (maschere 1 << JointIndex)
+     */
+    void setParkingOrder(const JointMask* masks, int count);
+
+    bool isParking() const;
+    int getParkingState() const;
+
+    /**
+     * Corrente disponibile per i servo (mA), vedi PowerBudget
+     */
+    void setSupplyBudget(int milliAmps);
+    const PowerBudget& getPowerBudget() const;
+
+    /**
+     * Monitor di salute (contatori e guasto attivo), vedi ServoHealth
+     */
+    const ServoHealth& getHealth() const;
+
+    /**
+     * Spostamento del prossimo tick (ms) per allineare l'uscita al
+     * periodo PWM (0 se PWM_SYNC_PIN non è collegato)
+     */
+    long getOutputPhaseCorrection() const;
+    const PwmSync& getPwmSync() const;
+
+    /**
+     * Stato del braccio all'ultimo tick, posa cartesiana inclusa
+     */
+    const ArmSnapshot& getSnapshot() const;
+    const Kinematics& getKinematics() const;
+
+    int getJointCount() const;
+    int getJointAngle(int joint) const;
+    const JointTable& getJoints() const;
+
+    // CALIBRAZIONE
+
+    /**
+     * Avvia la calibrazione guidata di un giunto ("Base", "Elbow", ...)
+     * Procede in updateServoMovements(), comandata con "CAL +/-/OK/STOP"
+     */
+    bool startCalibration(const String& jointName);
+
+    /**
+     * Imposta il probe per la calibrazione automatica (nullptr = guidata)
+     */
+    void setCalibrationProbe(CalibrationProbe probe, void* context);
+
+    bool isCalibrating() const;
 
     /**
      * Verifica stato pulsanti
@@ -103,7 +336,7 @@ public:
     bool wasButtonBluePressed();
 
     /**
-     * Ottiene info debug
+     * Ottiene info debug (solo su richiesta: comando seriale STATUS)
      */
     String getDebugInfo() const;
 
@@ -125,14 +358,75 @@ private:
     // OGGETTI
 
 
-    // Servo motori
-    ServoMotor20Diy *baseServo;
-    ServoMotor20Diy *elbowServo;
-    ServoMotorMG66R *wristServo;
-    ServoMotorMG66R *clawServo;
-
-    // Driver e comunicazione
-    Adafruit_PWMServoDriver pwm;
+    // Giunti (creati dalla tabella ARM_JOINTS)
+    JointTable joints;
+
+    // Uscita PWM (PCA9685 con impulsi sfasati)
+    ServoOutput pwm;
+
+    // Parcheggio
+    ParkingSequence parking;
+
+    // Ammissione dei movimenti entro la corrente disponibile
+    PowerBudget power;
+
+    // Guasti servo e bus
+    ServoHealth health;
+
+    // Fase del periodo PWM
+    PwmSync sync;
+    long phaseCorrection;
+
+    // Cinematica e stato per tick
+    Kinematics kinematics;
+    ArmSnapshot snapshot;
+    int ikBranch;
+    unsigned long lastIkMicros;
+
+    // Retta e jog cartesiano
+    CartesianPath cartesian;
+    unsigned long lastCartesianMicros;
+    unsigned long maxCartesianMicros;
+
+    // Teach e riproduzione
+    TeachStore teachStore;
+    TrajectoryEncoder teachEncoder;
+    TrajectoryDecoder teachDecoder;
+    int teachMode;
+    unsigned long teachEntry;
+    float teachFirst[MAX_JOINTS];     // Primo campione (fine del raccordo)
+    unsigned long teachWaits;         // Tick di riproduzione senza dati
+
+    // Script
+    MotionScript script;
+    ScriptRunner scriptRunner;
+    char scriptSource[SCRIPT_MAX_SOURCE];
+    char scriptName[SCRIPT_NAME_LENGTH];
+
+    // Stream G-code dall'host
+    GcodeStream gcode;
+    unsigned long gcodeDwellStart;    // 0 = pausa non iniziata
+    bool gcodeActive;                 // Movimenti dello stream in corso
+
+    // Frame ESP-NOW dal task del WiFi al tick di movimento
+    ArmFrame frameQueue[FRAME_QUEUE_SIZE];
+    int frameHead;
+    int frameCount;
+    portMUX_TYPE frameLock;
+    unsigned long framesApplied;
+    unsigned long framesRejected;    // Jog ignorati (braccio occupato, cartesiano)
+    unsigned long framesDropped;     // Coda piena
+
+    // Collisioni tra giunti
+    CollisionMap collisions;
+    unsigned long collisionClips;
+    unsigned long collisionRejects;
+
+    // Calibrazione
+    CalibrationRoutine calibrator;
+    CalibrationStore calibrationStore;
+    ServoMotor *calibrationServo;
+    int lastCalibrationState;
 
     // LED e Input
     Led *ledGreen;
@@ -202,9 +496,45 @@ private:
     void setLedState(bool green, bool red);
    // void logStateChange(int oldState, int newState);
    // void checkNetwork();
-   // void checkServoHealth();
+    void checkServoHealth();
+    void updatePhaseCorrection();
+    void updateSnapshot();
    // void processCommand(String command);
     void bringToSafePosition();
+    void startParking(const float targets[]);
+    ServoMotor* getServoByName(const String& name) const;
+    void loadCalibrations();
+    void updateCalibration();
+    bool handleCalibrationCommand(const String& arg);
+    bool handleMoveCommand(const String& arg, bool straight);
+    bool handleCartesianJog(const String& arg);
+    bool jogJoint(int joint, float velocity);
+    bool jogTool(int axis, float velocity);
+    bool applyFrame(const ArmFrame& frame);
+    void configureCartesian(float current[KIN_AXES]);
+    void getIkLimits(IkLimits& limits) const;
+    void updateCartesian();
+    bool clipCollisions(float angles[], JointMask mask);
+    bool handleTeachCommand(const String& arg);
+    void updatePlayback();
+    void updateRecording();
+    void endPlayback(const char* reason);
+    bool handleScriptCommand(const String& arg);
+    bool loadScript(const char* name, ScriptReport& report);
+    void updateScript();
+    void updateGcode();
+    int executeGcode(const GcodeBlock& block, const char*& error);
+    int queueGcodeMove(const GcodeBlock& block, const char*& error);
+    void reportPosition();
+
+    // ScriptTarget: il braccio visto dagli script
+    bool isIdle() override;
+    bool moveJoints(const float angles[], uint16_t mask) override;
+    bool moveTool(const float target[4], bool hasPitch, bool straight) override;
+    bool solveTool(const float target[4], bool hasPitch, const float current[], float angles[]) override;
+    bool isPoseValid(const float angles[]) override;
+    float estimateTime(const float from[], const float to[], bool straight) override;
+    void setCollisionWindow(int joint);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "include/CalibrationRoutine.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+CalibrationRoutine::CalibrationRoutine() {
+    this->probe = nullptr;
+    this->probeContext = nullptr;
+    this->state = CAL_IDLE;
+    this->firstPoint = 0;
+    this->lastPoint = -1;
+    this->currentPoint = 0;
+    this->iterations = 0;
+    this->minPulse = 0;
+    this->maxPulse = 0;
+    this->pulse = 0;
+    this->pulsePerDegree = 0.0f;
+    this->outputDirty = false;
+    this->settleStart = 0;
+    this->lastUpdate = 0;
+}
+
+// ============================================================================
+// AVVIO
+// ============================================================================
+
+void CalibrationRoutine::begin(
+    const ServoCalibration& nominal,
+    int safeMin,
+    int safeMax,
+    uint16_t minPulse,
+    uint16_t maxPulse,
+    unsigned long now
+) {
+    this->nominal = nominal;
+    this->result = nominal;
+    this->minPulse = minPulse;
+    this->maxPulse = maxPulse;
+    this->lastUpdate = now;
+
+    int span = nominal.getMaxAngle() - nominal.getMinAngle();
+    this->pulsePerDegree =
+        ((float)nominal.getPointPulse(CAL_POINTS - 1) - nominal.getPointPulse(0)) / span;
+
+    // Solo i punti dentro il range sicuro vengono visitati
+    firstPoint = CAL_POINTS;
+    lastPoint = -1;
+    for (int i = 0; i < CAL_POINTS; i++) {
+        float angle = nominal.getPointAngle(i);
+        if (angle >= safeMin && angle <= safeMax) {
+            if (i < firstPoint) firstPoint = i;
+            lastPoint = i;
+        }
+    }
+
+    if (lastPoint < firstPoint) {
+        state = CAL_FAILED;
+        return;
+    }
+
+    enterPoint(firstPoint, now);
+}
+
+void CalibrationRoutine::setProbe(CalibrationProbe probe, void* context) {
+    this->probe = probe;
+    this->probeContext = context;
+}
+
+// ============================================================================
+// AGGIORNAMENTO NON-BLOCCANTE
+// ============================================================================
+
+bool CalibrationRoutine::update(unsigned long now) {
+    lastUpdate = now;
+
+    if (state == CAL_SETTLING && now - settleStart >= CAL_SETTLE_MS) {
+        if (probe == nullptr) {
+            // Modalità guidata: aspetta l'operatore
+            state = CAL_WAIT_OPERATOR;
+        }
+        else {
+            float error = getCurrentAngle() - probe(probeContext, pulse);
+
+            if ((error <= CAL_TOLERANCE_DEG && error >= -CAL_TOLERANCE_DEG) ||
+                iterations >= CAL_MAX_ITERATIONS) {
+                recordPoint(now);
+            }
+            else {
+                float correction = error * pulsePerDegree;
+                long steps = (long)(correction + (correction >= 0 ? 0.5f : -0.5f));
+                if (steps == 0) {
+                    steps = (correction >= 0) ? 1 : -1;
+                }
+                iterations++;
+                setPulse((long)pulse + steps, now);
+            }
+        }
+    }
+
+    bool dirty = outputDirty;
+    outputDirty = false;
+    return dirty;
+}
+
+// ============================================================================
+// COMANDI OPERATORE
+// ============================================================================
+
+void CalibrationRoutine::nudge(int steps) {
+    if (state != CAL_WAIT_OPERATOR) {
+        return;
+    }
+
+    long value = (long)pulse + steps;
+    if (value < minPulse) value = minPulse;
+    if (value > maxPulse) value = maxPulse;
+
+    pulse = (uint16_t)value;
+    outputDirty = true;
+}
+
+void CalibrationRoutine::confirm() {
+    if (state != CAL_WAIT_OPERATOR) {
+        return;
+    }
+    recordPoint(lastUpdate);
+}
+
+void CalibrationRoutine::abort() {
+    if (isActive()) {
+        state = CAL_FAILED;
+    }
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+bool CalibrationRoutine::isActive() const {
+    return state == CAL_SETTLING || state == CAL_WAIT_OPERATOR;
+}
+
+int CalibrationRoutine::getState() const {
+    return state;
+}
+
+uint16_t CalibrationRoutine::getPulse() const {
+    return pulse;
+}
+
+int CalibrationRoutine::getCurrentPoint() const {
+    return currentPoint;
+}
+
+float CalibrationRoutine::getCurrentAngle() const {
+    return nominal.getPointAngle(currentPoint);
+}
+
+const ServoCalibration& CalibrationRoutine::getResult() const {
+    return result;
+}
+
+// ============================================================================
+// UTILITY PRIVATE
+// ============================================================================
+
+void CalibrationRoutine::enterPoint(int index, unsigned long now) {
+    currentPoint = index;
+    iterations = 0;
+
+    // Parte dal nominale più la correzione del punto precedente
+    long start = nominal.getPointPulse(index);
+    if (index > firstPoint) {
+        start += (long)result.getPointPulse(index - 1) - nominal.getPointPulse(index - 1);
+    }
+
+    setPulse(start, now);
+}
+
+void CalibrationRoutine::setPulse(long value, unsigned long now) {
+    if (value < minPulse) value = minPulse;
+    if (value > maxPulse) value = maxPulse;
+
+    pulse = (uint16_t)value;
+    outputDirty = true;
+    settleStart = now;
+    state = CAL_SETTLING;
+}
+
+void CalibrationRoutine::recordPoint(unsigned long now) {
+    result.setPointPulse(currentPoint, pulse);
+
+    if (currentPoint < lastPoint) {
+        enterPoint(currentPoint + 1, now);
+    }
+    else {
+        finish();
+    }
+}
+
+void CalibrationRoutine::finish() {
+    // Punti fuori dal range sicuro: stessa correzione del punto misurato più vicino
+    long lowOffset = (long)result.getPointPulse(firstPoint) - nominal.getPointPulse(firstPoint);
+    long highOffset = (long)result.getPointPulse(lastPoint) - nominal.getPointPulse(lastPoint);
+
+    for (int i = 0; i < firstPoint; i++) {
+        long value = nominal.getPointPulse(i) + lowOffset;
+        result.setPointPulse(i, (uint16_t)(value < 0 ? 0 : value));
+    }
+    for (int i = lastPoint + 1; i < CAL_POINTS; i++) {
+        long value = nominal.getPointPulse(i) + highOffset;
+        result.setPointPulse(i, (uint16_t)(value < 0 ? 0 : value));
+    }
+
+    state = result.isMonotonic() ? CAL_DONE : CAL_FAILED;
+}
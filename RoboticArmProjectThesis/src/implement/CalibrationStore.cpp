@@ -0,0 +1,77 @@
+#include "include/CalibrationStore.h"
+
+bool CalibrationStore::load(int board, int channel, ServoCalibration& cal) {
+    char key[8];
+    makeKey(board, channel, key, sizeof(key));
+
+    Record record;
+    prefs.begin(CAL_STORE_NAMESPACE, true);
+    size_t len = prefs.getBytes(key, &record, sizeof(record));
+    prefs.end();
+
+    if (len != sizeof(record)) {
+        return false;
+    }
+
+    if (record.version != CAL_STORE_VERSION ||
+        record.points != CAL_POINTS ||
+        record.minAngle != cal.getMinAngle() ||
+        record.maxAngle != cal.getMaxAngle()) {
+        Serial.printf("Ch%d: Calibrazione salvata non compatibile\n", channel);
+        return false;
+    }
+
+    ServoCalibration loaded = cal;
+    for (int i = 0; i < CAL_POINTS; i++) {
+        loaded.setPointPulse(i, record.pulse[i]);
+    }
+
+    if (loaded.checksum() != record.checksum || !loaded.isMonotonic()) {
+        Serial.printf("Ch%d: Calibrazione salvata corrotta\n", channel);
+        return false;
+    }
+
+    cal = loaded;
+    return true;
+}
+
+bool CalibrationStore::save(int board, int channel, const ServoCalibration& cal) {
+    char key[8];
+    makeKey(board, channel, key, sizeof(key));
+
+    Record record;
+    record.version = CAL_STORE_VERSION;
+    record.points = CAL_POINTS;
+    record.minAngle = cal.getMinAngle();
+    record.maxAngle = cal.getMaxAngle();
+    for (int i = 0; i < CAL_POINTS; i++) {
+        record.pulse[i] = cal.getPointPulse(i);
+    }
+    record.checksum = cal.checksum();
+
+    prefs.begin(CAL_STORE_NAMESPACE, false);
+    size_t written = prefs.putBytes(key, &record, sizeof(record));
+    prefs.end();
+
+    return written == sizeof(record);
+}
+
+bool CalibrationStore::erase(int board, int channel) {
+    char key[8];
+    makeKey(board, channel, key, sizeof(key));
+
+    prefs.begin(CAL_STORE_NAMESPACE, false);
+    bool removed = prefs.remove(key);
+    prefs.end();
+
+    return removed;
+}
+
+void CalibrationStore::makeKey(int board, int channel, char* key, size_t size) const {
+    if (board == 0) {
+        snprintf(key, size, "ch%d", channel);
+    }
+    else {
+        snprintf(key, size, "b%dch%d", board, channel);
+    }
+}
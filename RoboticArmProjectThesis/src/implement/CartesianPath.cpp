@@ -0,0 +1,404 @@
+#include "include/CartesianPath.h"
+#include <math.h>
+
+// ============================================================================
+// COSTRUTTORE E CONFIGURAZIONE
+// ============================================================================
+
+CartesianPath::CartesianPath() {
+    this->kinematics = nullptr;
+    this->limits.filter = nullptr;
+    this->limits.filterContext = nullptr;
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        this->limits.minAngle[axis] = 0.0f;
+        this->limits.maxAngle[axis] = 0.0f;
+        this->maxJointVelocity[axis] = 0.0f;
+        this->angles[axis] = 0.0f;
+        this->endAngles[axis] = 0.0f;
+    }
+    for (int i = 0; i < 3; i++) {
+        this->start[i] = 0.0f;
+        this->direction[i] = 0.0f;
+        this->position[i] = 0.0f;
+        this->jogVelocity[i] = 0.0f;
+        this->jogTarget[i] = 0.0f;
+        this->jogAge[i] = 0.0f;
+    }
+    this->length = 0.0f;
+    this->travelled = 0.0f;
+    this->velocity = 0.0f;
+    this->speed = 0.0f;
+    this->accel = 0.0f;
+    this->state = CART_IDLE;
+    this->error = CART_OK;
+    this->ikResult = IK_OK;
+    this->scaledTicks = 0;
+    this->minScale = 1.0f;
+    this->paths = 0;
+    this->jogLimits = 0;
+}
+
+void CartesianPath::configure(const Kinematics* kinematics, const IkLimits& limits,
+                              const float maxJointVelocity[KIN_AXES]) {
+    this->kinematics = kinematics;
+    this->limits = limits;
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        this->maxJointVelocity[axis] = maxJointVelocity[axis];
+    }
+}
+
+// ============================================================================
+// AVVIO
+// ============================================================================
+
+int CartesianPath::begin(const float servoAngles[KIN_AXES], const IkTarget& target, float speed, float accel) {
+    if (kinematics == nullptr || speed <= 0.0f || accel <= 0.0f) {
+        return CART_BAD_REQUEST;
+    }
+
+    ToolPose pose;
+    kinematics->forward(servoAngles, pose);
+    start[0] = Kinematics::toMm(pose.x);
+    start[1] = Kinematics::toMm(pose.y);
+    start[2] = Kinematics::toMm(pose.z);
+
+    float delta[3] = {target.x - start[0], target.y - start[1], target.z - start[2]};
+    length = sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+    for (int i = 0; i < 3; i++) {
+        direction[i] = length > 0.0f ? delta[i] / length : 0.0f;
+    }
+
+    // Percorre la retta a passi: ogni punto deve avere una soluzione
+    // vicina alla precedente, quella del punto finale chiude la retta
+    float previous[KIN_AXES];
+    float solution[KIN_AXES];
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        previous[axis] = servoAngles[axis];
+    }
+    for (float distance = CART_CHECK_STEP_MM; distance < length; distance += CART_CHECK_STEP_MM) {
+        if (!solve(distance, previous, solution)) {
+            return CART_IK_FAILED;
+        }
+        for (int axis = 0; axis < KIN_AXES; axis++) {
+            previous[axis] = solution[axis];
+        }
+    }
+
+    IkTarget end = target;
+    end.branch = IK_ELBOW_ANY;
+    ikResult = kinematics->inverse(end, limits, previous, endAngles);
+    if (ikResult != IK_OK) {
+        return CART_IK_FAILED;
+    }
+
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        angles[axis] = servoAngles[axis];
+    }
+    travelled = 0.0f;
+    velocity = 0.0f;
+    this->speed = speed;
+    this->accel = accel;
+    state = CART_RUNNING;
+    error = CART_OK;
+    paths++;
+
+    return CART_OK;
+}
+
+// ============================================================================
+// CAMPIONAMENTO
+// ============================================================================
+
+bool CartesianPath::step(float dt, float servoAngles[KIN_AXES]) {
+    if (state == CART_JOGGING) {
+        return stepJog(dt, servoAngles);
+    }
+    if (!isActive()) {
+        return false;
+    }
+
+    // Profilo trapezoidale in linea: accelera, crociera, frena in tempo
+    float remaining = length - travelled;
+    float limit = state == CART_STOPPING ? 0.0f : speed;
+    float braking = sqrtf(2.0f * accel * remaining);
+    float next = velocity + accel * dt;
+    if (next > limit) next = limit;
+    if (next > braking) next = braking;
+    if (state == CART_STOPPING) {
+        next = velocity - accel * dt;
+    }
+    if (next <= 0.0f && state == CART_STOPPING) {
+        velocity = 0.0f;
+        finish(CART_DONE, CART_OK);
+        return false;
+    }
+
+    float stepLength = next * dt;
+    if (stepLength >= remaining || (state == CART_RUNNING && remaining <= CART_MIN_STEP_MM)) {
+        // Ultimo campione: esattamente la soluzione del punto finale
+        for (int axis = 0; axis < KIN_AXES; axis++) {
+            servoAngles[axis] = angles[axis] = endAngles[axis];
+        }
+        travelled = length;
+        velocity = 0.0f;
+        finish(CART_DONE, CART_OK);
+        return true;
+    }
+
+    float solution[KIN_AXES];
+    float scale = 1.0f;
+    for (int attempt = 0; ; attempt++) {
+        if (!solve(travelled + stepLength * scale, angles, solution)) {
+            finish(CART_FAILED, CART_IK_FAILED);
+            return false;
+        }
+
+        float ratio = jointRatio(solution, dt);
+        if (ratio <= 1.0f) {
+            break;
+        }
+
+        // Passo troppo lungo per qualche giunto: riduzione proporzionale
+        scale *= CART_SCALE_MARGIN / ratio;
+        if (attempt + 1 >= CART_SCALE_ITERATIONS || stepLength * scale < CART_MIN_STEP_MM) {
+            finish(CART_FAILED, CART_SINGULAR);
+            return false;
+        }
+    }
+
+    if (scale < 1.0f) {
+        scaledTicks++;
+        if (scale < minScale) minScale = scale;
+    }
+
+    travelled += stepLength * scale;
+    velocity = next * scale;
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        servoAngles[axis] = angles[axis] = solution[axis];
+    }
+    return true;
+}
+
+// ============================================================================
+// JOG
+// ============================================================================
+
+bool CartesianPath::jog(const float servoAngles[KIN_AXES], int axis, float velocity, float accel) {
+    if (kinematics == nullptr || axis < CART_X || axis > CART_Z || accel <= 0.0f) {
+        return false;
+    }
+    if (state == CART_RUNNING || state == CART_STOPPING) {
+        return false;
+    }
+
+    if (state != CART_JOGGING) {
+        ToolPose pose;
+        kinematics->forward(servoAngles, pose);
+        position[0] = Kinematics::toMm(pose.x);
+        position[1] = Kinematics::toMm(pose.y);
+        position[2] = Kinematics::toMm(pose.z);
+
+        for (int i = 0; i < 3; i++) {
+            jogVelocity[i] = 0.0f;
+            jogTarget[i] = 0.0f;
+            jogAge[i] = 0.0f;
+        }
+        for (int i = 0; i < KIN_AXES; i++) {
+            angles[i] = servoAngles[i];
+        }
+        state = CART_JOGGING;
+        error = CART_OK;
+    }
+
+    jogTarget[axis] = velocity;
+    jogAge[axis] = 0.0f;
+    this->accel = accel;
+    return true;
+}
+
+bool CartesianPath::stepJog(float dt, float servoAngles[KIN_AXES]) {
+    bool moving = false;
+    bool requested = false;
+
+    // Rampa di ogni asse verso la velocità richiesta (0 senza rinnovo)
+    for (int i = 0; i < 3; i++) {
+        jogAge[i] += dt;
+        float target = jogAge[i] > CART_JOG_KEEPALIVE_S ? 0.0f : jogTarget[i];
+        float change = target - jogVelocity[i];
+        float maxChange = accel * dt;
+        if (change > maxChange) change = maxChange;
+        if (change < -maxChange) change = -maxChange;
+        jogVelocity[i] += change;
+
+        requested |= target != 0.0f;
+        moving |= jogVelocity[i] != 0.0f;
+    }
+
+    if (!moving) {
+        if (!requested) {
+            finish(CART_DONE, CART_OK);
+        }
+        return false;
+    }
+
+    float solution[KIN_AXES];
+    float scale = 1.0f;
+    for (int attempt = 0; ; attempt++) {
+        IkTarget target;
+        target.x = position[0] + jogVelocity[0] * dt * scale;
+        target.y = position[1] + jogVelocity[1] * dt * scale;
+        target.z = position[2] + jogVelocity[2] * dt * scale;
+        target.hasPitch = false;
+        target.pitch = 0.0f;
+        target.branch = IK_ELBOW_ANY;
+
+        ikResult = kinematics->inverse(target, limits, angles, solution);
+        float ratio = ikResult == IK_OK ? jointRatio(solution, dt) : 0.0f;
+        if (ikResult == IK_OK && ratio <= 1.0f) {
+            position[0] = target.x;
+            position[1] = target.y;
+            position[2] = target.z;
+            break;
+        }
+
+        scale *= ikResult == IK_OK ? CART_SCALE_MARGIN / ratio : 0.0f;
+        if (ikResult != IK_OK || attempt + 1 >= CART_SCALE_ITERATIONS) {
+            // Bordo dello spazio o singolarità: fermo sul campione
+            // precedente, gli altri versi restano disponibili
+            for (int i = 0; i < 3; i++) {
+                jogVelocity[i] = 0.0f;
+                jogTarget[i] = 0.0f;
+            }
+            jogLimits++;
+            return false;
+        }
+    }
+
+    if (scale < 1.0f) {
+        scaledTicks++;
+        if (scale < minScale) minScale = scale;
+        for (int i = 0; i < 3; i++) {
+            jogVelocity[i] *= scale;
+        }
+    }
+
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        servoAngles[axis] = angles[axis] = solution[axis];
+    }
+    return true;
+}
+
+/**
+ * Soluzione nella posizione lungo la retta, vicina a previous
+ */
+bool CartesianPath::solve(float distance, const float previous[KIN_AXES], float solution[KIN_AXES]) {
+    IkTarget target;
+    target.x = start[0] + direction[0] * distance;
+    target.y = start[1] + direction[1] * distance;
+    target.z = start[2] + direction[2] * distance;
+    target.hasPitch = false;
+    target.pitch = 0.0f;
+    target.branch = IK_ELBOW_ANY;
+
+    ikResult = kinematics->inverse(target, limits, previous, solution);
+    return ikResult == IK_OK;
+}
+
+/**
+ * Rapporto tra la velocità richiesta e quella massima del giunto più
+ * sollecitato (> 1: passo troppo lungo)
+ */
+float CartesianPath::jointRatio(const float solution[KIN_AXES], float dt) const {
+    float worst = 0.0f;
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        if (maxJointVelocity[axis] <= 0.0f) {
+            continue;
+        }
+        float ratio = fabsf(solution[axis] - angles[axis]) / (maxJointVelocity[axis] * dt);
+        if (ratio > worst) worst = ratio;
+    }
+    return worst;
+}
+
+// ============================================================================
+// ARRESTO
+// ============================================================================
+
+void CartesianPath::stop() {
+    if (state == CART_RUNNING) {
+        state = CART_STOPPING;
+    }
+    else if (state == CART_JOGGING) {
+        for (int i = 0; i < 3; i++) {
+            jogTarget[i] = 0.0f;
+        }
+    }
+}
+
+void CartesianPath::abort() {
+    if (isActive()) {
+        velocity = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            jogVelocity[i] = 0.0f;
+            jogTarget[i] = 0.0f;
+        }
+        finish(CART_DONE, CART_OK);
+    }
+}
+
+void CartesianPath::finish(int newState, int newError) {
+    state = newState;
+    error = newError;
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+bool CartesianPath::isActive() const {
+    return state == CART_RUNNING || state == CART_STOPPING || state == CART_JOGGING;
+}
+
+bool CartesianPath::isJogging() const {
+    return state == CART_JOGGING;
+}
+
+int CartesianPath::getState() const {
+    return state;
+}
+
+int CartesianPath::getError() const {
+    return error;
+}
+
+int CartesianPath::getIkResult() const {
+    return ikResult;
+}
+
+float CartesianPath::getLength() const {
+    return length;
+}
+
+float CartesianPath::getTravelled() const {
+    return travelled;
+}
+
+float CartesianPath::getSpeed() const {
+    return velocity;
+}
+
+unsigned long CartesianPath::getScaledTicks() const {
+    return scaledTicks;
+}
+
+float CartesianPath::getMinScale() const {
+    return minScale;
+}
+
+unsigned long CartesianPath::getPaths() const {
+    return paths;
+}
+
+unsigned long CartesianPath::getJogLimits() const {
+    return jogLimits;
+}
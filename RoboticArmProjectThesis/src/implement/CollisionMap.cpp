@@ -0,0 +1,130 @@
+#include "include/CollisionMap.h"
+#include <math.h>
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+CollisionMap::CollisionMap(const uint8_t* grid) {
+    this->grid = grid;
+}
+
+// ============================================================================
+// CONSULTAZIONE
+// ============================================================================
+
+bool CollisionMap::isSafe(float elbow, float wrist) const {
+    if (elbow < 0.0f || wrist < 0.0f) {
+        return false;
+    }
+    return isCellSafe(cellOf(elbow), cellOf(wrist));
+}
+
+bool CollisionMap::isCellSafe(int elbowCell, int wristCell) const {
+    if (elbowCell < 0 || elbowCell >= COLLISION_ELBOW_CELLS ||
+        wristCell < 0 || wristCell >= COLLISION_WRIST_CELLS) {
+        return false;
+    }
+
+    int bit = elbowCell * COLLISION_WRIST_CELLS + wristCell;
+    return (grid[bit >> 3] >> (bit & 7)) & 1;
+}
+
+int CollisionMap::cellOf(float angle) {
+    return (int)(angle / COLLISION_STEP_DEG);
+}
+
+// ============================================================================
+// SEGMENTI E INTERVALLI
+// ============================================================================
+
+float CollisionMap::clip(float elbowStart, float wristStart, float elbowEnd, float wristEnd) const {
+    if (!isSafe(elbowStart, wristStart)) {
+        return isSafe(elbowEnd, wristEnd) ? 1.0f : 0.0f;
+    }
+
+    // Mezza cella per passo: nessuna cella attraversata viene saltata
+    float span = fmaxf(fabsf(elbowEnd - elbowStart), fabsf(wristEnd - wristStart));
+    int steps = (int)ceilf(span / (0.5f * COLLISION_STEP_DEG));
+    if (steps == 0) {
+        return 1.0f;
+    }
+
+    for (int i = 1; i <= steps; i++) {
+        float t = (float)i / steps;
+        if (!isSafe(elbowStart + (elbowEnd - elbowStart) * t, wristStart + (wristEnd - wristStart) * t)) {
+            return (float)(i - 1) / steps;
+        }
+    }
+    return 1.0f;
+}
+
+void CollisionMap::window(int axis, float elbow, float wrist, float& minAngle, float& maxAngle) const {
+    int elbowCell = cellOf(elbow);
+    int wristCell = cellOf(wrist);
+    int cell = axis == KIN_ELBOW ? elbowCell : wristCell;
+    int cells = axis == KIN_ELBOW ? COLLISION_ELBOW_CELLS : COLLISION_WRIST_CELLS;
+    float current = axis == KIN_ELBOW ? elbow : wrist;
+    int low = cell;
+    int high = cell;
+
+    if (!isSafeAlong(axis, cell, elbowCell, wristCell)) {
+        // Zona sicura più vicina: il giunto può solo andarci
+        int below = cell - 1;
+        int above = cell + 1;
+        while (below >= 0 && !isSafeAlong(axis, below, elbowCell, wristCell)) below--;
+        while (above < cells && !isSafeAlong(axis, above, elbowCell, wristCell)) above++;
+
+        bool hasBelow = below >= 0;
+        bool hasAbove = above < cells;
+        if (!hasBelow && !hasAbove) {
+            minAngle = maxAngle = current;
+            return;
+        }
+
+        if (hasAbove && (!hasBelow || above - cell <= cell - below)) {
+            high = above;
+            while (high + 1 < cells && isSafeAlong(axis, high + 1, elbowCell, wristCell)) high++;
+            minAngle = current;
+            maxAngle = (float)(high + 1) * COLLISION_STEP_DEG;
+        }
+        else {
+            low = below;
+            while (low > 0 && isSafeAlong(axis, low - 1, elbowCell, wristCell)) low--;
+            minAngle = (float)low * COLLISION_STEP_DEG;
+            maxAngle = current;
+        }
+        return;
+    }
+
+    while (low > 0 && isSafeAlong(axis, low - 1, elbowCell, wristCell)) low--;
+    while (high + 1 < cells && isSafeAlong(axis, high + 1, elbowCell, wristCell)) high++;
+
+    minAngle = (float)low * COLLISION_STEP_DEG;
+    maxAngle = (float)(high + 1) * COLLISION_STEP_DEG;
+}
+
+/**
+ * Cella lungo l'asse del giunto che si muove, l'altro resta nella sua
+ */
+bool CollisionMap::isSafeAlong(int axis, int cell, int elbowCell, int wristCell) const {
+    return axis == KIN_ELBOW ? isCellSafe(cell, wristCell) : isCellSafe(elbowCell, cell);
+}
+
+// ============================================================================
+// GEOMETRIA E FILTRO IK
+// ============================================================================
+
+bool CollisionMap::matches(const ArmGeometry& geometry) {
+    const ArmGeometry& built = COLLISION_GRID_GEOMETRY;
+    return geometry.baseHeight == built.baseHeight && geometry.upperArm == built.upperArm &&
+           geometry.forearm == built.forearm && geometry.baseOffset == built.baseOffset &&
+           geometry.elbowOffset == built.elbowOffset && geometry.wristOffset == built.wristOffset &&
+           geometry.baseSign == built.baseSign && geometry.elbowSign == built.elbowSign &&
+           geometry.wristSign == built.wristSign;
+}
+
+bool CollisionMap::filter(void* context, const float servoAngles[KIN_AXES]) {
+    const CollisionMap* map = (const CollisionMap*)context;
+    return map->isSafe(servoAngles[KIN_ELBOW], servoAngles[KIN_WRIST]);
+}
@@ -0,0 +1,318 @@
+#include "include/GcodeStream.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// BUFFER DELLE RIGHE
+// ============================================================================
+
+GcodeStream::GcodeStream() {
+    this->head = 0;
+    this->count = 0;
+    this->received = 0;
+    this->overflows = 0;
+    this->parsed = false;
+    this->jointCount = GCODE_MAX_JOINTS;
+    this->relative = false;
+    this->rapid = true;
+    this->hasMotion = false;
+    this->feed = 0.0f;
+    this->halted = false;
+}
+
+void GcodeStream::configure(int jointCount) {
+    this->jointCount = (jointCount < GCODE_MAX_JOINTS) ? jointCount : GCODE_MAX_JOINTS;
+}
+
+bool GcodeStream::isGcode(const char* line) {
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    if (*line == ';' || *line == '(') {
+        return true;
+    }
+
+    char letter = (char)toupper((unsigned char)*line);
+    char next = line[1];
+    if (letter == '\0' || strchr("GMNXYZPF" GCODE_JOINT_WORDS, letter) == nullptr) {
+        return false;
+    }
+    return (next >= '0' && next <= '9') || next == '-' || next == '+' || next == '.';
+}
+
+bool GcodeStream::push(const char* line) {
+    if (count == GCODE_BUFFER_LINES) {
+        overflows++;
+        return false;
+    }
+
+    int slot = (head + count) % GCODE_BUFFER_LINES;
+    size_t length = strlen(line);
+    overlong[slot] = length >= GCODE_LINE_LENGTH;
+    if (overlong[slot]) {
+        lines[slot][0] = '\0';
+    }
+    else {
+        memcpy(lines[slot], line, length + 1);
+    }
+
+    count++;
+    received++;
+    return true;
+}
+
+const GcodeBlock* GcodeStream::peek() {
+    if (count == 0) {
+        return nullptr;
+    }
+
+    if (!parsed) {
+        if (overlong[head]) {
+            memset(&current, 0, sizeof(current));
+            fail(current, "riga troppo lunga");
+        }
+        else {
+            parse(lines[head], current);
+        }
+        parsed = true;
+    }
+    return &current;
+}
+
+void GcodeStream::pop() {
+    if (count == 0) {
+        return;
+    }
+    head = (head + 1) % GCODE_BUFFER_LINES;
+    count--;
+    parsed = false;
+}
+
+void GcodeStream::halt() {
+    // Anche la riga in testa viene reinterpretata (e rifiutata)
+    halted = true;
+    parsed = false;
+}
+
+bool GcodeStream::isHalted() const {
+    return halted;
+}
+
+bool GcodeStream::isEmpty() const {
+    return count == 0;
+}
+
+int GcodeStream::getCount() const {
+    return count;
+}
+
+int GcodeStream::getCapacity() const {
+    return GCODE_BUFFER_LINES;
+}
+
+unsigned long GcodeStream::getReceived() const {
+    return received;
+}
+
+unsigned long GcodeStream::getOverflows() const {
+    return overflows;
+}
+
+// ============================================================================
+// INTERPRETE
+// ============================================================================
+
+bool GcodeStream::parse(const char* line, GcodeBlock& block) {
+    memset(&block, 0, sizeof(block));
+    block.command = GCODE_NONE;
+
+    bool newRelative = relative;
+    bool newRapid = rapid;
+    float newFeed = feed;
+    bool motion = false;
+    bool dwell = false;
+    int mCode = -1;
+    bool hasP = false;
+    bool hasS = false;
+    float pValue = 0.0f;
+    float sValue = 0.0f;
+
+    const char* cursor = line;
+    while (*cursor != '\0') {
+        char letter = (char)toupper((unsigned char)*cursor);
+        if (letter == ' ' || letter == '\t' || letter == '\r') {
+            cursor++;
+            continue;
+        }
+        if (letter == ';' || letter == '*') {
+            break;
+        }
+        if (letter == '(') {
+            const char* close = strchr(cursor, ')');
+            if (close == nullptr) {
+                return fail(block, "commento non chiuso");
+            }
+            cursor = close + 1;
+            continue;
+        }
+        if (letter < 'A' || letter > 'Z') {
+            return fail(block, "parola non valida");
+        }
+
+        char* end;
+        float value = strtof(cursor + 1, &end);
+        if (end == cursor + 1) {
+            return fail(block, "numero mancante");
+        }
+        cursor = end;
+
+        if (letter == 'N') {
+            continue;
+        }
+
+        if (letter == 'G') {
+            int code = (int)value;
+            if ((float)code != value) {
+                return fail(block, "G non supportato");
+            }
+            if (code == 0 || code == 1) {
+                if (motion) {
+                    return fail(block, "due movimenti nella riga");
+                }
+                motion = true;
+                newRapid = (code == 0);
+            }
+            else if (code == 4) {
+                dwell = true;
+            }
+            else if (code == 90 || code == 91) {
+                newRelative = (code == 91);
+            }
+            else if (code == 20) {
+                return fail(block, "pollici non supportati (G21)");
+            }
+            else if (code != 21) {
+                return fail(block, "G non supportato");
+            }
+        }
+        else if (letter == 'M') {
+            if (mCode >= 0) {
+                return fail(block, "un solo M per riga");
+            }
+            mCode = (int)value;
+        }
+        else if (letter == 'F') {
+            if (value <= 0.0f) {
+                return fail(block, "F non valido");
+            }
+            newFeed = value / 60.0f;
+        }
+        else if (letter == 'P') {
+            if (hasP) {
+                return fail(block, "parola ripetuta");
+            }
+            hasP = true;
+            pValue = value;
+        }
+        else if (letter == 'S') {
+            if (hasS) {
+                return fail(block, "parola ripetuta");
+            }
+            hasS = true;
+            sValue = value;
+        }
+        else if (letter >= 'X' && letter <= 'Z') {
+            int axis = letter - 'X';
+            if (block.toolMask & (1 << axis)) {
+                return fail(block, "parola ripetuta");
+            }
+            block.toolMask |= 1 << axis;
+            block.tool[axis] = value;
+        }
+        else {
+            const char* word = strchr(GCODE_JOINT_WORDS, letter);
+            int joint = (word != nullptr) ? (int)(word - GCODE_JOINT_WORDS) : -1;
+            if (joint < 0 || joint >= jointCount) {
+                return fail(block, "parola non supportata");
+            }
+            if (block.jointMask & (1 << joint)) {
+                return fail(block, "parola ripetuta");
+            }
+            block.jointMask |= 1 << joint;
+            block.joints[joint] = value;
+        }
+    }
+
+    bool axes = block.toolMask != 0 || block.jointMask != 0;
+
+    // Fermato: nessuna riga riparte senza conferma dell'host
+    if (halted && mCode != 999) {
+        return fail(block, "halt, M999 per riprendere");
+    }
+
+    if (mCode >= 0) {
+        if (motion || dwell || axes || hasP || hasS) {
+            return fail(block, "M con altre parole");
+        }
+        switch (mCode) {
+            case 114: block.command = GCODE_REPORT; break;
+            case 115: block.command = GCODE_INFO; break;
+            case 400: block.command = GCODE_SYNC; break;
+            case 999: block.command = GCODE_RESUME; break;
+            default: return fail(block, "M non supportato");
+        }
+    }
+    else if (dwell) {
+        if (motion || axes || hasP == hasS) {
+            return fail(block, "G4 vuole solo P<ms> o S<s>");
+        }
+        float ms = hasP ? pValue : sValue * 1000.0f;
+        if (ms < 0.0f) {
+            return fail(block, "pausa negativa");
+        }
+        block.command = GCODE_DWELL;
+        block.dwellMs = (unsigned long)ms;
+    }
+    else if (axes || hasP) {
+        if (hasS) {
+            return fail(block, "S non supportato nei movimenti");
+        }
+        if (hasP) {
+            block.toolMask |= 1 << GCODE_PITCH;
+            block.tool[GCODE_PITCH] = pValue;
+        }
+        if (!motion && !hasMotion) {
+            return fail(block, "movimento senza G0/G1");
+        }
+        if (!newRapid && newFeed <= 0.0f) {
+            return fail(block, "F non impostato");
+        }
+        block.command = GCODE_MOVE;
+    }
+    else if (hasS) {
+        return fail(block, "S non supportato");
+    }
+
+    // Riga valida: lo stato modale vale da qui in avanti
+    relative = newRelative;
+    feed = newFeed;
+    if (motion) {
+        rapid = newRapid;
+        hasMotion = true;
+    }
+    if (block.command == GCODE_RESUME) {
+        halted = false;
+    }
+
+    block.rapid = rapid;
+    block.relative = relative;
+    block.feed = feed;
+    return true;
+}
+
+bool GcodeStream::fail(GcodeBlock& block, const char* error) {
+    block.command = GCODE_ERROR;
+    block.error = error;
+    return false;
+}
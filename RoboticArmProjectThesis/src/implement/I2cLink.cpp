@@ -0,0 +1,156 @@
+#include "include/I2cLink.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+I2cLink::I2cLink(I2cBus& bus) : bus(bus) {
+    this->state = LINK_READY;
+    this->pulses = 0;
+    this->backoff = 0;
+    resetCounters();
+}
+
+// ============================================================================
+// TRASMISSIONE
+// ============================================================================
+
+uint8_t I2cLink::send(uint8_t address, const uint8_t* data, int length) {
+    if (state != LINK_READY) {
+        errors[I2C_BUS_DOWN]++;
+        failures++;
+        return I2C_BUS_DOWN;
+    }
+
+    uint8_t result = I2C_OK;
+    for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+        if (attempt > 0) {
+            retries++;
+        }
+
+        result = bus.transmit(address, data, length);
+        if (result == I2C_OK) {
+            return I2C_OK;
+        }
+
+        errors[(result < I2C_ERROR_CLASSES) ? result : (uint8_t)I2C_OTHER]++;
+
+        // Errore del chiamante: ritentare non serve
+        if (result == I2C_TOO_LONG) {
+            break;
+        }
+
+        // SDA bloccata: nessun retry finché il bus non è libero
+        if ((result == I2C_TIMEOUT || result == I2C_OTHER) && bus.isSdaLow()) {
+            stuckEvents++;
+            beginRecovery();
+            break;
+        }
+    }
+
+    failures++;
+    return result;
+}
+
+// ============================================================================
+// RECUPERO DEL BUS
+// ============================================================================
+
+void I2cLink::beginRecovery() {
+    bus.releasePins();
+    state = LINK_CLEARING;
+    pulses = 0;
+}
+
+bool I2cLink::step() {
+    switch (state) {
+    case LINK_CLEARING:
+        if (!bus.isSdaLow()) {
+            // Lo slave ha finito il byte: STOP e driver di nuovo attivo
+            bus.reattach();
+            recoveries++;
+            state = LINK_READY;
+        }
+        else if (pulses < I2C_CLEAR_PULSES) {
+            bus.clockPulse();
+            clockPulses++;
+            pulses++;
+        }
+        else {
+            bus.reattach();
+            failedRecoveries++;
+            backoff = I2C_RECOVERY_BACKOFF;
+            state = LINK_BACKOFF;
+        }
+        break;
+
+    case LINK_BACKOFF:
+        if (--backoff <= 0) {
+            if (bus.isSdaLow()) {
+                stuckEvents++;
+                beginRecovery();
+            }
+            else {
+                state = LINK_READY;
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return state == LINK_READY;
+}
+
+bool I2cLink::isReady() const {
+    return state == LINK_READY;
+}
+
+int I2cLink::getState() const {
+    return state;
+}
+
+// ============================================================================
+// CONTATORI
+// ============================================================================
+
+unsigned long I2cLink::getErrors(int errorClass) const {
+    return (errorClass >= 0 && errorClass < I2C_ERROR_CLASSES) ? errors[errorClass] : 0;
+}
+
+unsigned long I2cLink::getRetries() const {
+    return retries;
+}
+
+unsigned long I2cLink::getFailures() const {
+    return failures;
+}
+
+unsigned long I2cLink::getStuckEvents() const {
+    return stuckEvents;
+}
+
+unsigned long I2cLink::getRecoveries() const {
+    return recoveries;
+}
+
+unsigned long I2cLink::getFailedRecoveries() const {
+    return failedRecoveries;
+}
+
+unsigned long I2cLink::getClockPulses() const {
+    return clockPulses;
+}
+
+void I2cLink::resetCounters() {
+    for (int i = 0; i < I2C_ERROR_CLASSES; i++) {
+        errors[i] = 0;
+    }
+    retries = 0;
+    failures = 0;
+    stuckEvents = 0;
+    recoveries = 0;
+    failedRecoveries = 0;
+    clockPulses = 0;
+}
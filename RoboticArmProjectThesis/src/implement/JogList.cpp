@@ -0,0 +1,100 @@
+#include "include/JogList.h"
+#include <string.h>
+
+static const char AXIS_NAMES[] = "XYZ";
+
+/**
+ * Copia in word la parola successiva a pos (spazi multipli ignorati);
+ * una parola troppo lunga diventa vuota e non corrisponde a nulla
+ * @return Posizione dopo la parola, 0 se il testo è finito
+ */
+static int nextWord(const char* text, int pos, char word[JOG_WORD_LENGTH]) {
+    while (text[pos] == ' ') {
+        pos++;
+    }
+    if (text[pos] == '\0') {
+        return 0;
+    }
+
+    int length = 0;
+    while (text[pos + length] != '\0' && text[pos + length] != ' ') {
+        length++;
+    }
+    if (length >= JOG_WORD_LENGTH) {
+        length = 0;
+    }
+    memcpy(word, text + pos, length);
+    word[length] = '\0';
+
+    while (text[pos] != '\0' && text[pos] != ' ') {
+        pos++;
+    }
+    return pos;
+}
+
+static int reject(ArmFrame& frame) {
+    frame.mask = 0;
+    return 0;
+}
+
+int JogList::parse(const char* text, const char* const names[], int jointCount, ArmFrame& frame) {
+    memset(&frame, 0, sizeof(frame));
+    frame.type = FRAME_JOG;
+
+    char word[JOG_WORD_LENGTH];
+    char action[JOG_WORD_LENGTH];
+    int count = 0;
+    int pos = 0;
+
+    while ((pos = nextWord(text, pos, word)) > 0) {
+        int bit = -1;
+        const char* forward;
+        const char* backward;
+
+        if (strcmp(word, "CJOG") == 0) {
+            pos = nextWord(text, pos, word);
+            const char* axis = (pos > 0 && word[0] != '\0') ? strchr(AXIS_NAMES, word[0]) : nullptr;
+            if (axis == nullptr) {
+                return reject(frame);
+            }
+            strcpy(action, word + 1);
+            if (action[0] == '\0' && (pos = nextWord(text, pos, action)) == 0) {
+                return reject(frame);
+            }
+            bit = ARM_FRAME_AXIS_BIT(axis - AXIS_NAMES);
+            forward = "+";
+            backward = "-";
+        }
+        else {
+            for (int joint = 0; joint < jointCount && joint < ARM_FRAME_MAX_JOINTS && bit < 0; joint++) {
+                if (strcmp(word, names[joint]) == 0) {
+                    bit = joint;
+                }
+            }
+            if (bit < 0 || (pos = nextWord(text, pos, action)) == 0) {
+                return reject(frame);
+            }
+            forward = (strcmp(action, "Open") == 0) ? "Open" : "DX";
+            backward = (strcmp(action, "Close") == 0) ? "Close" : "SX";
+        }
+
+        int8_t value;
+        if (strcmp(action, "STOP") == 0) {
+            value = 0;
+        }
+        else if (strcmp(action, forward) == 0) {
+            value = ARM_FRAME_FULL_SCALE;
+        }
+        else if (strcmp(action, backward) == 0) {
+            value = -ARM_FRAME_FULL_SCALE;
+        }
+        else {
+            return reject(frame);
+        }
+
+        frame.mask |= (1 << bit);
+        frame.values[bit] = value;
+        count++;
+    }
+    return count;
+}
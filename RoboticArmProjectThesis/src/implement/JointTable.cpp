@@ -0,0 +1,302 @@
+#include "include/JointTable.h"
+#include "include/Servo20Diy.h"
+#include "include/ServoMG66R.h"
+
+// Sotto questo spostamento (gradi) un giunto del waypoint resta fermo
+#define SYNC_MIN_DISTANCE 0.001f
+
+// Ultimo waypoint di più giunti accodato (0 = nessuno)
+static uint16_t lastGroup = 0;
+
+// ============================================================================
+// COSTRUTTORE E CONFIGURAZIONE
+// ============================================================================
+
+JointTable::JointTable() {
+    this->count = 0;
+    this->movingMask = 0;
+    this->unsafeMask = 0;
+    this->safetyEnabled = true;
+}
+
+int JointTable::configure(const JointConfig* table, int count) {
+    if (count > MAX_JOINTS) {
+        count = MAX_JOINTS;
+    }
+
+    for (int joint = 0; joint < count; joint++) {
+        servos[joint] = createServo(table[joint]);
+        servos[joint]->setBoard(table[joint].board);
+        names[joint] = table[joint].name;
+        parkAngles[joint] = table[joint].parkAngle;
+        safeMin[joint] = servos[joint]->getSafeMinAngle();
+        safeMax[joint] = servos[joint]->getSafeMaxAngle();
+    }
+
+    this->count = count;
+    sync();
+    return count;
+}
+
+ServoMotor* JointTable::createServo(const JointConfig& config) {
+    switch (config.model) {
+    case SERVO_MODEL_MG66R:
+        return new ServoMotorMG66R(config.channel, config.safeMin, config.safeMax);
+    case SERVO_MODEL_20KG:
+    default:
+        return new ServoMotor20Diy(config.channel, config.safeMin, config.safeMax);
+    }
+}
+
+// ============================================================================
+// AGGIORNAMENTO
+// ============================================================================
+
+void JointTable::update(ServoOutput& pwm) {
+    for (int joint = 0; joint < count; joint++) {
+        servos[joint]->updateSmoothMove(pwm);
+    }
+    sync();
+}
+
+void JointTable::sync() {
+    JointMask moving = 0;
+    JointMask unsafe = 0;
+
+    for (int joint = 0; joint < count; joint++) {
+        const ServoMotor* servo = servos[joint];
+        float position = servo->getPosition();
+
+        positions[joint] = position;
+        targets[joint] = servo->getTargetAngle();
+        moving |= (JointMask)servo->isMoving() << joint;
+        unsafe |= (JointMask)((position < safeMin[joint]) | (position > safeMax[joint])) << joint;
+    }
+
+    movingMask = moving;
+    unsafeMask = safetyEnabled ? unsafe : 0;
+}
+
+// ============================================================================
+// WAYPOINT DI PIÙ GIUNTI
+// ============================================================================
+
+/**
+ * Velocità di raccordo (frazioni/s) tra l'ultimo waypoint in coda e
+ * uno nuovo con spostamenti distance: 0 se i giunti non sono gli stessi
+ * o qualcuno inverte, altrimenti limitata dal salto di velocità
+ */
+static float blendLimit(ServoMotor* const servos[], int count, JointMask mask, const float distance[], float velocity) {
+    MotionSegment tail;
+    uint16_t previous = 0;
+
+    for (int joint = 0; joint < count; joint++) {
+        if (!(mask & (1 << joint))) {
+            continue;
+        }
+        if (!servos[joint]->getLastSegment(tail) || tail.group == 0) {
+            return 0.0f;
+        }
+        if (previous != 0 && tail.group != previous) {
+            return 0.0f;
+        }
+        previous = tail.group;
+    }
+
+    float limit = velocity;
+    for (int joint = 0; joint < count; joint++) {
+        bool hasPrevious = servos[joint]->getLastSegment(tail) && tail.group == previous;
+        if (!(mask & (1 << joint))) {
+            if (hasPrevious) {
+                return 0.0f;  // Si ferma qui: tutti si fermano
+            }
+            continue;
+        }
+
+        // Gradi per frazione prima e dopo il waypoint
+        float before = (tail.targetAngle - tail.startAngle) / tail.length;
+        float after = distance[joint];
+        if (before * after < 0.0f) {
+            return 0.0f;
+        }
+
+        float jump = fabsf(after - before);
+        float allowed = servos[joint]->getMaxAccel() * MOTION_PERIOD_S;
+        if (jump * limit > allowed) {
+            limit = allowed / jump;
+        }
+    }
+    return limit;
+}
+
+bool JointTable::queueSync(
+    ServoMotor* const servos[],
+    int count,
+    const float targets[],
+    JointMask mask,
+    float maxVelocity,
+    float cruiseTime
+) {
+    if (count > MAX_JOINTS) {
+        count = MAX_JOINTS;
+    }
+
+    // Limiti comuni in frazioni del tratto: quelli del giunto più limitato
+    float distance[MAX_JOINTS];
+    float velocity = 0.0f;
+    float accel = 0.0f;
+    for (int joint = 0; joint < count; joint++) {
+        if (!(mask & (1 << joint))) {
+            continue;
+        }
+
+        ServoMotor* servo = servos[joint];
+        if (servo->isJogging() || !servo->canQueueMove()) {
+            Serial.printf("Ch%d: jog attivo o coda piena, waypoint scartato\n", servo->getChannel());
+            return false;
+        }
+
+        distance[joint] = servo->getMoveDistance(targets[joint]);
+        float d = fabsf(distance[joint]);
+        if (d < SYNC_MIN_DISTANCE) {
+            continue;
+        }
+
+        float limit = servo->getMaxVelocity();
+        float v = (cruiseTime > 0.0f) ? d / cruiseTime : maxVelocity;
+        if (v <= 0.0f || v > limit) {
+            v = limit;
+        }
+        v *= servo->getFeedRate();
+
+        if (velocity == 0.0f || v / d < velocity) {
+            velocity = v / d;
+        }
+        if (accel == 0.0f || servo->getAccelLimit() / d < accel) {
+            accel = servo->getAccelLimit() / d;
+        }
+    }
+
+    // Nessun giunto si sposta: niente da accodare
+    if (velocity == 0.0f) {
+        return true;
+    }
+
+    SyncProfile sync;
+    sync.maxVelocity = velocity;
+    sync.maxAccel = accel;
+    sync.junction = blendLimit(servos, count, mask, distance, velocity);
+    sync.group = (lastGroup == 0xFFFF) ? 1 : lastGroup + 1;
+
+    for (int joint = 0; joint < count; joint++) {
+        if (!(mask & (1 << joint))) {
+            continue;
+        }
+
+        // Nessun waypoint parziale: si tolgono quelli già accodati
+        if (!servos[joint]->queueSyncMove(targets[joint], sync)) {
+            for (int done = 0; done < joint; done++) {
+                if (mask & (1 << done)) {
+                    servos[done]->dropLastMove();
+                }
+            }
+            return false;
+        }
+    }
+
+    lastGroup = sync.group;
+    return true;
+}
+
+void JointTable::holdIncompleteGroups() {
+    // Waypoint di più giunti pronto a partire da fermo, per giunto
+    uint16_t ready[MAX_JOINTS];
+    for (int joint = 0; joint < count; joint++) {
+        MotionSegment segment;
+        bool starting = servos[joint]->isStarting() && servos[joint]->getNextSegment(segment);
+        ready[joint] = starting ? segment.group : 0;
+    }
+
+    for (int joint = 0; joint < count; joint++) {
+        bool hold = false;
+        for (int other = 0; other < count && ready[joint] != 0 && !hold; other++) {
+            hold = ready[other] != ready[joint] && servos[other]->hasWaypoint(ready[joint]);
+        }
+        servos[joint]->setSyncHold(hold);
+    }
+}
+
+// ============================================================================
+// ACCESSO
+// ============================================================================
+
+int JointTable::getCount() const {
+    return count;
+}
+
+ServoMotor* JointTable::get(int joint) const {
+    return (joint >= 0 && joint < count) ? servos[joint] : nullptr;
+}
+
+ServoMotor* const* JointTable::getServos() const {
+    return servos;
+}
+
+const char* JointTable::getName(int joint) const {
+    return (joint >= 0 && joint < count) ? names[joint] : "";
+}
+
+int JointTable::find(const String& name) const {
+    for (int joint = 0; joint < count; joint++) {
+        if (name == names[joint]) {
+            return joint;
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// STATO
+// ============================================================================
+
+float JointTable::getPosition(int joint) const {
+    return positions[joint];
+}
+
+float JointTable::getTarget(int joint) const {
+    return targets[joint];
+}
+
+float JointTable::getParkAngle(int joint) const {
+    return parkAngles[joint];
+}
+
+JointMask JointTable::getAllMask() const {
+    return (JointMask)((1UL << count) - 1);
+}
+
+JointMask JointTable::getMovingMask() const {
+    return movingMask;
+}
+
+JointMask JointTable::getUnsafeMask() const {
+    return unsafeMask;
+}
+
+// ============================================================================
+// IMPOSTAZIONI
+// ============================================================================
+
+void JointTable::setSafetyEnabled(bool enabled) {
+    safetyEnabled = enabled;
+    for (int joint = 0; joint < count; joint++) {
+        servos[joint]->setSafetyEnabled(enabled);
+    }
+    sync();
+}
+
+void JointTable::setFeedRate(float rate) {
+    for (int joint = 0; joint < count; joint++) {
+        servos[joint]->setFeedRate(rate);
+    }
+}
@@ -0,0 +1,294 @@
+#include "include/Kinematics.h"
+#include <math.h>
+
+#define RAD_TO_DEGREES 57.29577951f
+
+// Seno su un quarto d'onda, 256 intervalli (Q14)
+static const int16_t SIN_QUARTER[257] = {
+        0,   101,   201,   302,   402,   503,   603,   704,   804,   904,  1005,  1105,
+     1205,  1306,  1406,  1506,  1606,  1706,  1806,  1906,  2006,  2105,  2205,  2305,
+     2404,  2503,  2603,  2702,  2801,  2900,  2999,  3098,  3196,  3295,  3393,  3492,
+     3590,  3688,  3786,  3883,  3981,  4078,  4176,  4273,  4370,  4467,  4563,  4660,
+     4756,  4852,  4948,  5044,  5139,  5235,  5330,  5425,  5520,  5614,  5708,  5803,
+     5897,  5990,  6084,  6177,  6270,  6363,  6455,  6547,  6639,  6731,  6823,  6914,
+     7005,  7096,  7186,  7276,  7366,  7456,  7545,  7635,  7723,  7812,  7900,  7988,
+     8076,  8163,  8250,  8337,  8423,  8509,  8595,  8680,  8765,  8850,  8935,  9019,
+     9102,  9186,  9269,  9352,  9434,  9516,  9598,  9679,  9760,  9841,  9921, 10001,
+    10080, 10159, 10238, 10316, 10394, 10471, 10549, 10625, 10702, 10778, 10853, 10928,
+    11003, 11077, 11151, 11224, 11297, 11370, 11442, 11514, 11585, 11656, 11727, 11797,
+    11866, 11935, 12004, 12072, 12140, 12207, 12274, 12340, 12406, 12472, 12537, 12601,
+    12665, 12729, 12792, 12854, 12916, 12978, 13039, 13100, 13160, 13219, 13279, 13337,
+    13395, 13453, 13510, 13567, 13623, 13678, 13733, 13788, 13842, 13896, 13949, 14001,
+    14053, 14104, 14155, 14206, 14256, 14305, 14354, 14402, 14449, 14497, 14543, 14589,
+    14635, 14680, 14724, 14768, 14811, 14854, 14896, 14937, 14978, 15019, 15059, 15098,
+    15137, 15175, 15213, 15250, 15286, 15322, 15357, 15392, 15426, 15460, 15493, 15525,
+    15557, 15588, 15619, 15649, 15679, 15707, 15736, 15763, 15791, 15817, 15843, 15868,
+    15893, 15917, 15941, 15964, 15986, 16008, 16029, 16049, 16069, 16088, 16107, 16125,
+    16143, 16160, 16176, 16192, 16207, 16221, 16235, 16248, 16261, 16273, 16284, 16295,
+    16305, 16315, 16324, 16332, 16340, 16347, 16353, 16359, 16364, 16369, 16373, 16376,
+    16379, 16381, 16383, 16384, 16384,
+};
+
+// ============================================================================
+// COSTRUTTORE E CONFIGURAZIONE
+// ============================================================================
+
+Kinematics::Kinematics() {
+    ArmGeometry none = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1, 1, 1};
+    configure(none);
+}
+
+void Kinematics::configure(const ArmGeometry& geometry) {
+    this->geometry = geometry;
+    this->baseHeight = (int32_t)(geometry.baseHeight * KIN_MM_SCALE + 0.5f);
+    this->upperArm = (int32_t)(geometry.upperArm * KIN_MM_SCALE + 0.5f);
+    this->forearm = (int32_t)(geometry.forearm * KIN_MM_SCALE + 0.5f);
+}
+
+const ArmGeometry& Kinematics::getGeometry() const {
+    return geometry;
+}
+
+// ============================================================================
+// CINEMATICA DIRETTA
+// ============================================================================
+
+void Kinematics::forward(const float servoAngles[KIN_AXES], ToolPose& pose) const {
+    uint16_t angles[KIN_AXES];
+    for (int axis = 0; axis < KIN_AXES; axis++) {
+        angles[axis] = toKinematic(axis, servoAngles[axis]);
+    }
+    forwardFixed(angles, pose);
+}
+
+void Kinematics::forwardFixed(const uint16_t angles[KIN_AXES], ToolPose& pose) const {
+    uint16_t shoulder = angles[KIN_ELBOW];
+    uint16_t tool = (uint16_t)(angles[KIN_ELBOW] + angles[KIN_WRIST]);  // Modulo 2π
+
+    // Piano del braccio: distanza dall'asse della base e quota
+    int32_t reach = (int32_t)(((int64_t)upperArm * cosQ14(shoulder) +
+                               (int64_t)forearm * cosQ14(tool)) >> 14);
+    int32_t height = (int32_t)(((int64_t)upperArm * sinQ14(shoulder) +
+                                (int64_t)forearm * sinQ14(tool)) >> 14);
+
+    pose.x = (int32_t)(((int64_t)reach * cosQ14(angles[KIN_BASE])) >> 14);
+    pose.y = (int32_t)(((int64_t)reach * sinQ14(angles[KIN_BASE])) >> 14);
+    pose.z = baseHeight + height;
+    pose.pitch = tool;
+}
+
+uint16_t Kinematics::toKinematic(int axis, float servoAngle) const {
+    float offset;
+    int sign;
+
+    switch (axis) {
+    case KIN_BASE:
+        offset = geometry.baseOffset;
+        sign = geometry.baseSign;
+        break;
+    case KIN_ELBOW:
+        offset = geometry.elbowOffset;
+        sign = geometry.elbowSign;
+        break;
+    default:
+        offset = geometry.wristOffset;
+        sign = geometry.wristSign;
+        break;
+    }
+
+    return degToAngle(sign * (servoAngle - offset));
+}
+
+// ============================================================================
+// CINEMATICA INVERSA
+// ============================================================================
+
+int Kinematics::inverse(const IkTarget& target, const IkLimits& limits,
+                        const float current[KIN_AXES], float servoAngles[KIN_AXES]) const {
+    float l1 = geometry.upperArm;
+    float l2 = geometry.forearm;
+    float radius = sqrtf(target.x * target.x + target.y * target.y);
+    float height = target.z - geometry.baseHeight;
+
+    // Angolo tra i link, uguale per tutte le soluzioni
+    float cosine = (radius * radius + height * height - l1 * l1 - l2 * l2) / (2.0f * l1 * l2);
+    float slack = IK_REACH_EPSILON * (l1 + l2) / (l1 * l2);
+    if (cosine > 1.0f + slack || cosine < -1.0f - slack) {
+        return IK_UNREACHABLE;
+    }
+    cosine = cosine > 1.0f ? 1.0f : (cosine < -1.0f ? -1.0f : cosine);
+    float bend = acosf(cosine);
+    float heading = atan2f(target.y, target.x) * RAD_TO_DEGREES;
+
+    int result = IK_OUT_OF_LIMITS;
+    float bestCost = 0.0f;
+    bool bestPreferred = false;
+
+    // Base diretta (reach > 0) o girata (reach < 0), gomito alto o basso
+    for (int flip = 0; flip < 2; flip++) {
+        float reach = flip ? -radius : radius;
+        float base = flip ? heading + 180.0f : heading;
+
+        for (int branch = IK_ELBOW_UP; branch <= IK_ELBOW_DOWN; branch++) {
+            // Giunto sopra la retta: verso opposto al lato del bersaglio
+            float relative = (branch == IK_ELBOW_UP) == (reach >= 0.0f) ? -bend : bend;
+            float shoulder = atan2f(height, reach) -
+                             atan2f(l2 * sinf(relative), l1 + l2 * cosf(relative));
+
+            float angles[KIN_AXES];
+            if (!toServo(KIN_BASE, base, limits, angles[KIN_BASE]) ||
+                !toServo(KIN_ELBOW, shoulder * RAD_TO_DEGREES, limits, angles[KIN_ELBOW]) ||
+                !toServo(KIN_WRIST, relative * RAD_TO_DEGREES, limits, angles[KIN_WRIST])) {
+                continue;
+            }
+
+            if (limits.filter != nullptr && !limits.filter(limits.filterContext, angles)) {
+                if (result == IK_OUT_OF_LIMITS) {
+                    result = IK_COLLISION;
+                }
+                continue;
+            }
+
+            if (target.hasPitch) {
+                float pitch = remainderf((shoulder + relative) * RAD_TO_DEGREES - target.pitch, 360.0f);
+                if (fabsf(pitch) > IK_PITCH_TOLERANCE) {
+                    if (result == IK_OUT_OF_LIMITS || result == IK_COLLISION) {
+                        result = IK_PITCH_MISMATCH;
+                    }
+                    continue;
+                }
+            }
+
+            bool preferred = target.branch == IK_ELBOW_ANY || target.branch == branch;
+            float cost = 0.0f;
+            for (int axis = 0; axis < KIN_AXES; axis++) {
+                cost += fabsf(angles[axis] - current[axis]);
+            }
+
+            if (result == IK_OK &&
+                (bestPreferred > preferred || (bestPreferred == preferred && cost >= bestCost))) {
+                continue;
+            }
+
+            result = IK_OK;
+            bestCost = cost;
+            bestPreferred = preferred;
+            for (int axis = 0; axis < KIN_AXES; axis++) {
+                servoAngles[axis] = angles[axis];
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Angolo cinematico (gradi) → angolo servo nei limiti, provando
+ * anche i giri equivalenti
+ */
+bool Kinematics::toServo(int axis, float kinematic, const IkLimits& limits, float& servoAngle) const {
+    float offset;
+    int sign;
+
+    switch (axis) {
+    case KIN_BASE:
+        offset = geometry.baseOffset;
+        sign = geometry.baseSign;
+        break;
+    case KIN_ELBOW:
+        offset = geometry.elbowOffset;
+        sign = geometry.elbowSign;
+        break;
+    default:
+        offset = geometry.wristOffset;
+        sign = geometry.wristSign;
+        break;
+    }
+
+    float angle = offset + sign * remainderf(kinematic, 360.0f);
+    float minAngle = limits.minAngle[axis];
+    float maxAngle = limits.maxAngle[axis];
+
+    for (int turn = -1; turn <= 1; turn++) {
+        float candidate = angle + turn * 360.0f;
+        if (candidate >= minAngle - IK_LIMIT_EPSILON && candidate <= maxAngle + IK_LIMIT_EPSILON) {
+            // Arrotondamenti sul bordo: dentro il limite
+            servoAngle = candidate < minAngle ? minAngle : (candidate > maxAngle ? maxAngle : candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Kinematics::resultName(int result) {
+    switch (result) {
+    case IK_OK:
+        return "OK";
+    case IK_UNREACHABLE:
+        return "Fuori portata";
+    case IK_OUT_OF_LIMITS:
+        return "Fuori dai limiti dei servo";
+    case IK_PITCH_MISMATCH:
+        return "Pitch non raggiungibile";
+    case IK_COLLISION:
+        return "Collisione";
+    default:
+        return "Sconosciuto";
+    }
+}
+
+// ============================================================================
+// TRIGONOMETRIA
+// ============================================================================
+
+/**
+ * Seno nel primo quadrante, index 0..0x4000 (0..90°)
+ */
+int32_t Kinematics::quarterSin(uint16_t index) {
+    uint16_t slot = index >> 6;
+    uint16_t frac = index & 0x3F;
+    if (frac == 0) {
+        return SIN_QUARTER[slot];
+    }
+
+    int32_t a = SIN_QUARTER[slot];
+    int32_t b = SIN_QUARTER[slot + 1];
+    return a + (((b - a) * frac) >> 6);
+}
+
+int16_t Kinematics::sinQ14(uint16_t angle) {
+    uint16_t index = angle & 0x3FFF;
+
+    switch (angle >> 14) {
+    case 0:
+        return quarterSin(index);
+    case 1:
+        return quarterSin(0x4000 - index);
+    case 2:
+        return -quarterSin(index);
+    default:
+        return -quarterSin(0x4000 - index);
+    }
+}
+
+int16_t Kinematics::cosQ14(uint16_t angle) {
+    return sinQ14((uint16_t)(angle + 0x4000));
+}
+
+// ============================================================================
+// CONVERSIONI
+// ============================================================================
+
+uint16_t Kinematics::degToAngle(float degrees) {
+    float turns = degrees * (KIN_FULL_TURN / 360.0f);
+    int32_t value = (int32_t)(turns < 0.0f ? turns - 0.5f : turns + 0.5f);
+    return (uint16_t)value;
+}
+
+float Kinematics::angleToDeg(uint16_t angle) {
+    return (int16_t)angle * (360.0f / KIN_FULL_TURN);
+}
+
+float Kinematics::toMm(int32_t length) {
+    return (float)length / KIN_MM_SCALE;
+}
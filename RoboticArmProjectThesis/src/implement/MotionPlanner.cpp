@@ -0,0 +1,431 @@
+#include "include/MotionPlanner.h"
+#include <math.h>
+
+// Sotto questa distanza (gradi) un segmento è considerato nullo
+#define PLANNER_EPSILON 0.001f
+
+static float directionOf(float from, float to) {
+    return (to >= from) ? 1.0f : -1.0f;
+}
+
+// ============================================================================
+// PROFILO TRAPEZOIDALE
+// ============================================================================
+
+float MotionProfile::travel(float t) const {
+    float s;
+
+    if (t <= 0.0f) {
+        s = 0.0f;
+    }
+    else if (t >= duration) {
+        s = distance;
+    }
+    else if (t < t1) {
+        s = entryVelocity * t + 0.5f * accelIn * t * t;
+    }
+    else if (t < t1 + t2) {
+        s = d1 + cruiseVelocity * (t - t1);
+    }
+    else {
+        float u = t - t1 - t2;
+        s = d1 + d2 + cruiseVelocity * u + 0.5f * accelOut * u * u;
+    }
+
+    return (s > distance) ? distance : s;
+}
+
+float MotionProfile::speed(float t) const {
+    float v;
+
+    if (t <= 0.0f) {
+        v = entryVelocity;
+    }
+    else if (t >= duration) {
+        v = exitVelocity;
+    }
+    else if (t < t1) {
+        v = entryVelocity + accelIn * t;
+    }
+    else if (t < t1 + t2) {
+        v = cruiseVelocity;
+    }
+    else {
+        v = cruiseVelocity + accelOut * (t - t1 - t2);
+    }
+
+    return (v < 0.0f) ? 0.0f : v;
+}
+
+float MotionProfile::position(float t) const {
+    return startAngle + direction * travel(t);
+}
+
+float MotionProfile::velocity(float t) const {
+    return direction * speed(t);
+}
+
+// ============================================================================
+// COSTRUTTORE E LIMITI
+// ============================================================================
+
+MotionPlanner::MotionPlanner() {
+    this->maxVelocity = 180.0f;
+    this->maxAccel = 720.0f;
+    this->accelScale = 1.0f;
+    reset(0.0f);
+}
+
+void MotionPlanner::setLimits(float maxVelocity, float maxAccel, float accelScale) {
+    this->maxVelocity = (maxVelocity > 0.0f) ? maxVelocity : 1.0f;
+    this->accelScale = (accelScale > 0.0f) ? accelScale : 1.0f;
+    this->maxAccel = ((maxAccel > 0.0f) ? maxAccel : 1.0f) * this->accelScale;
+
+    // I segmenti già in coda si adeguano ai nuovi limiti
+    recalculate();
+}
+
+float MotionPlanner::getMaxVelocity() const {
+    return maxVelocity;
+}
+
+float MotionPlanner::getMaxAccel() const {
+    return maxAccel;
+}
+
+void MotionPlanner::reset(float position) {
+    head = 0;
+    count = 0;
+    entryVelocity = 0.0f;
+    active.startAngle = position;
+    active.targetAngle = position;
+    active.length = 0.0f;
+    active.maxVelocity = maxVelocity;
+    active.maxAccel = 0.0f;
+    active.junction = 0.0f;
+    active.group = 0;
+    active.entryVelocity = 0.0f;
+    active.exitVelocity = 0.0f;
+    endPosition = position;
+}
+
+// ============================================================================
+// CODA
+// ============================================================================
+
+bool MotionPlanner::push(float targetAngle, float velocity) {
+    if (isFull()) {
+        return false;
+    }
+
+    float cap = maxVelocity;
+    if (velocity > 0.0f && velocity < cap) {
+        cap = velocity;
+    }
+
+    MotionSegment& segment = append(targetAngle);
+    segment.length = fabsf(segment.targetAngle - segment.startAngle);
+    segment.maxVelocity = cap;
+
+    recalculate();
+    return true;
+}
+
+bool MotionPlanner::pushSync(float targetAngle, const SyncProfile& sync) {
+    if (isFull()) {
+        return false;
+    }
+
+    MotionSegment& segment = append(targetAngle);
+    segment.length = 1.0f;
+    segment.maxVelocity = sync.maxVelocity;
+    segment.maxAccel = sync.maxAccel;
+    segment.junction = sync.junction;
+    segment.group = sync.group;
+
+    recalculate();
+    return true;
+}
+
+bool MotionPlanner::dropLast() {
+    if (isEmpty()) {
+        return false;
+    }
+
+    count--;
+    endPosition = at(count).startAngle;
+
+    recalculate();
+    return true;
+}
+
+bool MotionPlanner::next(MotionProfile& profile) {
+    if (isEmpty()) {
+        return false;
+    }
+
+    MotionSegment segment = at(0);
+    head = (head + 1) % PLANNER_QUEUE_SIZE;
+    count--;
+
+    buildProfile(segment, profile);
+
+    // L'uscita del segmento attivo diventa l'ingresso (fisso) della coda
+    active = segment;
+    entryVelocity = segment.exitVelocity;
+
+    return true;
+}
+
+void MotionPlanner::resume(float travelled, float speed) {
+    float remaining = active.length - travelled;
+    if (isFull() || remaining < PLANNER_EPSILON) {
+        return;
+    }
+
+    // Inserisce in testa il resto del segmento attivo (stesso waypoint,
+    // stessi limiti: per un waypoint di più giunti resta sincronizzato)
+    head = (head + PLANNER_QUEUE_SIZE - 1) % PLANNER_QUEUE_SIZE;
+    count++;
+
+    MotionSegment& segment = at(0);
+    segment = active;
+    segment.startAngle = active.startAngle + (active.targetAngle - active.startAngle) / active.length * travelled;
+    segment.length = remaining;
+    segment.entryVelocity = 0.0f;
+    segment.exitVelocity = 0.0f;
+
+    entryVelocity = speed;
+
+    recalculate();
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+bool MotionPlanner::isFull() const {
+    return count >= PLANNER_QUEUE_SIZE;
+}
+
+bool MotionPlanner::isEmpty() const {
+    return count == 0;
+}
+
+int MotionPlanner::getCount() const {
+    return count;
+}
+
+float MotionPlanner::getEndPosition() const {
+    return endPosition;
+}
+
+bool MotionPlanner::peek(MotionSegment& segment) const {
+    if (isEmpty()) {
+        return false;
+    }
+    segment = at(0);
+    return true;
+}
+
+bool MotionPlanner::getTail(MotionSegment& segment, bool activeRunning) const {
+    if (count > 0) {
+        segment = at(count - 1);
+        return true;
+    }
+    if (activeRunning) {
+        segment = active;
+        return true;
+    }
+    return false;
+}
+
+bool MotionPlanner::contains(uint16_t group) const {
+    for (int i = 0; i < count; i++) {
+        if (at(i).group == group) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float MotionPlanner::restToRestTime(float distance, float velocity) const {
+    float v = (velocity > 0.0f && velocity < maxVelocity) ? velocity : maxVelocity;
+    if (distance < 0.0f) distance = -distance;
+
+    // Profilo triangolare se non si raggiunge la velocità di crociera
+    if (distance <= v * v / maxAccel) {
+        return 2.0f * sqrtf(distance / maxAccel);
+    }
+    return distance / v + v / maxAccel;
+}
+
+float MotionPlanner::velocityForDuration(float distance, float duration) const {
+    if (distance < 0.0f) distance = -distance;
+    if (distance < PLANNER_EPSILON || duration <= 0.0f) {
+        return maxVelocity;
+    }
+
+    // T = d/v + v/a  →  v² - aTv + ad = 0
+    float aT = maxAccel * duration;
+    float disc = aT * aT - 4.0f * maxAccel * distance;
+    if (disc < 0.0f) {
+        return maxVelocity;  // Troppo corto: va alla massima velocità
+    }
+
+    float v = (aT - sqrtf(disc)) / 2.0f;
+    return (v < maxVelocity) ? v : maxVelocity;
+}
+
+void MotionPlanner::buildProfile(const MotionSegment& segment, MotionProfile& profile) const {
+    float a = accelOf(segment);
+    float v0 = segment.entryVelocity;
+    float v1 = segment.exitVelocity;
+    float d = segment.length;
+
+    profile.startAngle = segment.startAngle;
+    profile.distance = d;
+    profile.entryVelocity = v0;
+    profile.exitVelocity = v1;
+
+    if (d < PLANNER_EPSILON) {
+        profile.direction = directionOf(segment.startAngle, segment.targetAngle);
+        profile.cruiseVelocity = 0.0f;
+        profile.accelIn = profile.accelOut = 0.0f;
+        profile.t1 = profile.t2 = profile.duration = 0.0f;
+        profile.d1 = profile.d2 = 0.0f;
+        return;
+    }
+    profile.direction = (segment.targetAngle - segment.startAngle) / d;
+
+    float delta = v1 * v1 - v0 * v0;
+    if (delta > 2.0f * a * d || -delta > 2.0f * a * d) {
+        // Non raggiungibile entro i limiti: unica rampa da v0 a v1
+        profile.cruiseVelocity = v0;
+        profile.accelIn = 0.0f;
+        profile.accelOut = delta / (2.0f * d);
+        profile.t1 = profile.t2 = 0.0f;
+        profile.d1 = profile.d2 = 0.0f;
+        profile.duration = 2.0f * d / (v0 + v1);
+        return;
+    }
+
+    // Velocità di picco del profilo triangolare
+    float cap = segment.maxVelocity;
+    if (cap < v0) cap = v0;
+    if (cap < v1) cap = v1;
+    float peak = sqrtf(a * d + (v0 * v0 + v1 * v1) / 2.0f);
+    float vc = (peak < cap) ? peak : cap;
+
+    profile.cruiseVelocity = vc;
+    profile.accelIn = (vc >= v0) ? a : -a;
+    profile.accelOut = (v1 >= vc) ? a : -a;
+
+    profile.t1 = fabsf(vc - v0) / a;
+    float t3 = fabsf(vc - v1) / a;
+    profile.d1 = (v0 + vc) / 2.0f * profile.t1;
+    float d3 = (vc + v1) / 2.0f * t3;
+
+    profile.d2 = d - profile.d1 - d3;
+    if (profile.d2 < 0.0f) profile.d2 = 0.0f;
+    profile.t2 = (vc > 0.0f) ? profile.d2 / vc : 0.0f;
+
+    profile.duration = profile.t1 + profile.t2 + t3;
+}
+
+// ============================================================================
+// LOOKAHEAD
+// ============================================================================
+
+MotionSegment& MotionPlanner::at(int index) {
+    return queue[(head + index) % PLANNER_QUEUE_SIZE];
+}
+
+const MotionSegment& MotionPlanner::at(int index) const {
+    return queue[(head + index) % PLANNER_QUEUE_SIZE];
+}
+
+/**
+ * Nuovo segmento in fondo alla coda, dalla fine dell'ultimo
+ */
+MotionSegment& MotionPlanner::append(float targetAngle) {
+    MotionSegment& segment = at(count);
+    segment.startAngle = endPosition;
+    segment.targetAngle = targetAngle;
+    segment.maxAccel = 0.0f;
+    segment.junction = 0.0f;
+    segment.group = 0;
+    segment.entryVelocity = 0.0f;
+    segment.exitVelocity = 0.0f;
+
+    count++;
+    endPosition = targetAngle;
+    return segment;
+}
+
+/**
+ * Accelerazione sul percorso: quella del giunto, o per un waypoint di
+ * più giunti quella comune, con la stessa scala di ammissione
+ */
+float MotionPlanner::accelOf(const MotionSegment& segment) const {
+    return (segment.group != 0) ? segment.maxAccel * accelScale : maxAccel;
+}
+
+/**
+ * Velocità massima al passaggio tra due segmenti: zero se cambia
+ * direzione, altrimenti il minore dei due limiti. Tra waypoint di più
+ * giunti vale il limite deciso per tutto il braccio (SyncProfile);
+ * tra un waypoint di più giunti e uno di un giunto solo ci si ferma
+ */
+float MotionPlanner::junctionVelocity(const MotionSegment& prev, const MotionSegment& next) const {
+    float limit = (prev.maxVelocity < next.maxVelocity) ? prev.maxVelocity : next.maxVelocity;
+
+    if (prev.group != 0 || next.group != 0) {
+        if (prev.group == 0 || next.group == 0) {
+            return 0.0f;
+        }
+        return (next.junction < limit) ? next.junction : limit;
+    }
+
+    if (next.length < PLANNER_EPSILON) {
+        return 0.0f;
+    }
+    if (directionOf(next.startAngle, next.targetAngle) != directionOf(prev.startAngle, prev.targetAngle)) {
+        return 0.0f;
+    }
+    return limit;
+}
+
+void MotionPlanner::recalculate() {
+    if (count == 0) {
+        return;
+    }
+
+    // Passata all'indietro: l'ultimo segmento termina da fermo, ogni
+    // ingresso è limitato dalla giunzione e dalla frenata possibile
+    float nextEntry = 0.0f;
+    for (int i = count - 1; i >= 0; i--) {
+        MotionSegment& segment = at(i);
+
+        segment.exitVelocity = nextEntry;
+
+        float junction = (i == 0) ? entryVelocity : junctionVelocity(at(i - 1), segment);
+        float reachable = sqrtf(nextEntry * nextEntry + 2.0f * accelOf(segment) * segment.length);
+        segment.entryVelocity = (junction < reachable) ? junction : reachable;
+        nextEntry = segment.entryVelocity;
+    }
+
+    // Passata in avanti: l'ingresso del primo è fissato dal segmento attivo,
+    // ogni uscita è limitata da quanto si riesce ad accelerare
+    float v = entryVelocity;
+    for (int i = 0; i < count; i++) {
+        MotionSegment& segment = at(i);
+
+        segment.entryVelocity = v;
+        float reachable = sqrtf(v * v + 2.0f * accelOf(segment) * segment.length);
+        if (segment.exitVelocity > reachable) {
+            segment.exitVelocity = reachable;
+        }
+        v = segment.exitVelocity;
+    }
+}
@@ -0,0 +1,539 @@
+#include "include/MotionScript.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SCRIPT_MAX_TOKENS 8
+
+static bool parseNumber(const char* text, float& value) {
+    char* end;
+    value = strtof(text, &end);
+    return end != text && *end == '\0';
+}
+
+/**
+ * Divide una riga in parole (in place); '#' inizia un commento
+ * @return Numero di parole, -1 se troppe
+ */
+static int tokenize(char* line, char* tokens[]) {
+    char* comment = strchr(line, '#');
+    if (comment != nullptr) {
+        *comment = '\0';
+    }
+
+    int count = 0;
+    char* cursor = line;
+    while (*cursor != '\0') {
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+            *cursor++ = '\0';
+        }
+        if (*cursor == '\0') {
+            break;
+        }
+        if (count == SCRIPT_MAX_TOKENS) {
+            return -1;
+        }
+        tokens[count++] = cursor;
+        while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') {
+            cursor++;
+        }
+    }
+    return count;
+}
+
+// ============================================================================
+// COMPILAZIONE
+// ============================================================================
+
+MotionScript::MotionScript() {
+    this->opCount = 0;
+    this->poseCount = 0;
+    this->jointCount = 0;
+    this->valid = false;
+    this->errorLine = 0;
+    this->error = nullptr;
+}
+
+bool MotionScript::compile(const char* source, const ScriptConfig& config) {
+    opCount = 0;
+    poseCount = 0;
+    valid = false;
+    errorLine = 0;
+    error = nullptr;
+
+    if (config.jointCount <= 0 || config.jointCount > SCRIPT_MAX_JOINTS) {
+        return fail(0, "numero di giunti non supportato");
+    }
+    jointCount = config.jointCount;
+
+    int loops[SCRIPT_MAX_DEPTH];
+    int depth = 0;
+    int number = 0;
+    char line[SCRIPT_LINE_LENGTH];
+    const char* cursor = source;
+
+    while (*cursor != '\0') {
+        number++;
+        const char* end = strchr(cursor, '\n');
+        int length = (end != nullptr) ? (int)(end - cursor) : (int)strlen(cursor);
+        if (length >= SCRIPT_LINE_LENGTH) {
+            return fail(number, "riga troppo lunga");
+        }
+
+        memcpy(line, cursor, length);
+        line[length] = '\0';
+        if (!compileLine(line, number, config, loops, depth)) {
+            return false;
+        }
+
+        cursor += length;
+        if (*cursor == '\n') {
+            cursor++;
+        }
+    }
+
+    if (depth > 0) {
+        return fail(number, "REPEAT senza END");
+    }
+    if (addOp(OP_END, number) == nullptr) {
+        return false;
+    }
+
+    valid = true;
+    return true;
+}
+
+bool MotionScript::compileLine(char* line, int number, const ScriptConfig& config, int* loops, int& depth) {
+    char* tokens[SCRIPT_MAX_TOKENS];
+    int count = tokenize(line, tokens);
+    if (count < 0) {
+        return fail(number, "troppi argomenti");
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    const char* command = tokens[0];
+    ScriptOp* op;
+
+    if (strcmp(command, "POSE") == 0) {
+        if (count != 2 + jointCount) {
+            return fail(number, "POSE vuole un nome e un angolo per giunto");
+        }
+        if (strlen(tokens[1]) >= SCRIPT_NAME_LENGTH) {
+            return fail(number, "nome della posa troppo lungo");
+        }
+        if (findPose(tokens[1]) >= 0) {
+            return fail(number, "posa già definita");
+        }
+        if (poseCount == SCRIPT_MAX_POSES) {
+            return fail(number, "troppe pose");
+        }
+        for (int joint = 0; joint < jointCount; joint++) {
+            if (!parseNumber(tokens[2 + joint], poses[poseCount][joint])) {
+                return fail(number, "angolo non valido");
+            }
+        }
+        strcpy(poseNames[poseCount], tokens[1]);
+        poseCount++;
+        return true;
+    }
+
+    if (strcmp(command, "GO") == 0) {
+        int pose = (count == 2) ? findPose(tokens[1]) : -1;
+        if (pose < 0) {
+            return fail(number, "GO vuole una posa già definita");
+        }
+        op = addOp(OP_GO, number);
+        if (op == nullptr) {
+            return false;
+        }
+        op->arg = pose;
+        return true;
+    }
+
+    if (strcmp(command, "JOINT") == 0 || strcmp(command, "CLAW") == 0) {
+        bool claw = command[0] == 'C';
+        int joint = -1;
+        float angle;
+        const char* value = tokens[claw ? 1 : 2];
+
+        if (count != (claw ? 2 : 3)) {
+            return fail(number, claw ? "uso: CLAW OPEN|CLOSE|<angolo>" : "uso: JOINT <giunto> <angolo>");
+        }
+        if (claw) {
+            joint = config.clawJoint;
+            if (joint < 0) {
+                return fail(number, "nessuna pinza configurata");
+            }
+        }
+        else {
+            for (int i = 0; i < config.jointCount && joint < 0; i++) {
+                if (strcmp(tokens[1], config.jointNames[i]) == 0) {
+                    joint = i;
+                }
+            }
+            if (joint < 0) {
+                return fail(number, "giunto sconosciuto");
+            }
+        }
+
+        if (claw && strcmp(value, "OPEN") == 0) {
+            angle = config.clawOpen;
+        }
+        else if (claw && strcmp(value, "CLOSE") == 0) {
+            angle = config.clawClose;
+        }
+        else if (!parseNumber(value, angle)) {
+            return fail(number, "angolo non valido");
+        }
+
+        op = addOp(OP_JOINT, number);
+        if (op == nullptr) {
+            return false;
+        }
+        op->joint = (uint8_t)joint;
+        op->values[0] = angle;
+        return true;
+    }
+
+    if (strcmp(command, "MOVE") == 0 || strcmp(command, "LINE") == 0) {
+        if (count != 4 && count != 5) {
+            return fail(number, "uso: MOVE|LINE x y z [pitch]");
+        }
+        op = addOp(command[0] == 'M' ? OP_MOVE : OP_LINE, number);
+        if (op == nullptr) {
+            return false;
+        }
+        for (int i = 1; i < count; i++) {
+            if (!parseNumber(tokens[i], op->values[i - 1])) {
+                return fail(number, "coordinata non valida");
+            }
+        }
+        op->hasPitch = (count == 5);
+        return true;
+    }
+
+    if (strcmp(command, "WAIT") == 0) {
+        float ms;
+        if (count != 2 || !parseNumber(tokens[1], ms) || ms < 0.0f) {
+            return fail(number, "uso: WAIT <ms>");
+        }
+        op = addOp(OP_WAIT, number);
+        if (op == nullptr) {
+            return false;
+        }
+        op->values[0] = ms;
+        return true;
+    }
+
+    if (strcmp(command, "REPEAT") == 0) {
+        float times = 0.0f;
+        if (count > 2 || (count == 2 && (!parseNumber(tokens[1], times) || times < 1.0f || times > 32767.0f))) {
+            return fail(number, "uso: REPEAT [n], n >= 1");
+        }
+        if (depth == SCRIPT_MAX_DEPTH) {
+            return fail(number, "troppi REPEAT annidati");
+        }
+        op = addOp(OP_REPEAT, number);
+        if (op == nullptr) {
+            return false;
+        }
+        op->arg = (int16_t)times;
+        loops[depth++] = opCount;   // Prima istruzione del corpo
+        return true;
+    }
+
+    if (strcmp(command, "END") == 0) {
+        if (count != 1 || depth == 0) {
+            return fail(number, "END senza REPEAT");
+        }
+        op = addOp(OP_LOOP, number);
+        if (op == nullptr) {
+            return false;
+        }
+        op->arg = (int16_t)loops[--depth];
+        return true;
+    }
+
+    return fail(number, "istruzione sconosciuta");
+}
+
+ScriptOp* MotionScript::addOp(uint8_t code, int number) {
+    if (opCount == SCRIPT_MAX_OPS) {
+        fail(number, "programma troppo lungo");
+        return nullptr;
+    }
+
+    ScriptOp* op = &ops[opCount++];
+    memset(op, 0, sizeof(ScriptOp));
+    op->code = code;
+    op->line = (uint16_t)number;
+    return op;
+}
+
+int MotionScript::findPose(const char* name) const {
+    for (int pose = 0; pose < poseCount; pose++) {
+        if (strcmp(poseNames[pose], name) == 0) {
+            return pose;
+        }
+    }
+    return -1;
+}
+
+bool MotionScript::fail(int number, const char* message) {
+    valid = false;
+    errorLine = number;
+    error = message;
+    return false;
+}
+
+bool MotionScript::isValid() const {
+    return valid;
+}
+
+int MotionScript::getOpCount() const {
+    return opCount;
+}
+
+const ScriptOp& MotionScript::getOp(int index) const {
+    return ops[index];
+}
+
+const float* MotionScript::getPose(int index) const {
+    return poses[index];
+}
+
+int MotionScript::getJointCount() const {
+    return jointCount;
+}
+
+int MotionScript::getErrorLine() const {
+    return errorLine;
+}
+
+const char* MotionScript::getError() const {
+    return error;
+}
+
+// ============================================================================
+// ESECUZIONE
+// ============================================================================
+
+ScriptRunner::ScriptRunner() {
+    this->script = nullptr;
+    this->target = nullptr;
+    this->state = SCRIPT_IDLE;
+    this->pc = 0;
+    this->depth = 0;
+    this->waiting = false;
+    this->waitStart = 0;
+    this->cycles = 0;
+}
+
+bool ScriptRunner::start(const MotionScript* script, ScriptTarget* target) {
+    if (script == nullptr || target == nullptr || !script->isValid()) {
+        return false;
+    }
+
+    this->script = script;
+    this->target = target;
+    state = SCRIPT_RUNNING;
+    pc = 0;
+    depth = 0;
+    waiting = false;
+    cycles = 0;
+    return true;
+}
+
+void ScriptRunner::stop() {
+    if (state == SCRIPT_RUNNING) {
+        state = SCRIPT_IDLE;
+    }
+}
+
+int ScriptRunner::step(unsigned long now) {
+    for (int i = 0; i < SCRIPT_OPS_PER_STEP && state == SCRIPT_RUNNING; i++) {
+        const ScriptOp& op = script->getOp(pc);
+
+        switch (op.code) {
+        case OP_REPEAT:
+            remaining[depth++] = op.arg;
+            pc++;
+            break;
+
+        case OP_LOOP:
+            // Fine del corpo: un giro in meno (0 = infinito)
+            if (depth == 1) {
+                cycles++;
+            }
+            if (remaining[depth - 1] == 0 || --remaining[depth - 1] > 0) {
+                pc = op.arg;
+            }
+            else {
+                depth--;
+                pc++;
+            }
+            break;
+
+        case OP_WAIT:
+            if (!target->isIdle()) {
+                return state;
+            }
+            if (!waiting) {
+                waiting = true;
+                waitStart = now;
+            }
+            if (now - waitStart < (unsigned long)op.values[0]) {
+                return state;
+            }
+            waiting = false;
+            pc++;
+            break;
+
+        case OP_END:
+            if (target->isIdle()) {
+                state = SCRIPT_DONE;
+            }
+            return state;
+
+        default:
+            // Un movimento per tick, a braccio fermo
+            if (!target->isIdle()) {
+                return state;
+            }
+            if (!issue(op)) {
+                state = SCRIPT_FAILED;
+                return state;
+            }
+            pc++;
+            return state;
+        }
+    }
+    return state;
+}
+
+bool ScriptRunner::issue(const ScriptOp& op) {
+    float angles[SCRIPT_MAX_JOINTS];
+
+    switch (op.code) {
+    case OP_GO:
+        return target->moveJoints(script->getPose(op.arg), (uint16_t)((1 << script->getJointCount()) - 1));
+    case OP_JOINT:
+        angles[op.joint] = op.values[0];
+        return target->moveJoints(angles, (uint16_t)(1 << op.joint));
+    case OP_MOVE:
+    case OP_LINE:
+        return target->moveTool(op.values, op.hasPitch, op.code == OP_LINE);
+    default:
+        return false;
+    }
+}
+
+int ScriptRunner::getState() const {
+    return state;
+}
+
+bool ScriptRunner::isRunning() const {
+    return state == SCRIPT_RUNNING;
+}
+
+int ScriptRunner::getLine() const {
+    return (script != nullptr) ? script->getOp(pc).line : 0;
+}
+
+unsigned long ScriptRunner::getCycles() const {
+    return cycles;
+}
+
+// ============================================================================
+// DRY-RUN
+// ============================================================================
+
+void ScriptRunner::dryRun(const MotionScript& script, ScriptTarget& target, const float start[], ScriptReport& report) {
+    report.ok = false;
+    report.cycleSeconds = 0.0f;
+    report.moves = 0;
+    report.endless = false;
+    report.errorLine = 0;
+    report.error = nullptr;
+
+    if (!script.isValid()) {
+        report.errorLine = script.getErrorLine();
+        report.error = script.getError();
+        return;
+    }
+
+    int joints = script.getJointCount();
+    float current[SCRIPT_MAX_JOINTS];
+    float next[SCRIPT_MAX_JOINTS];
+    int remaining[SCRIPT_MAX_DEPTH];
+    int depth = 0;
+    int pc = 0;
+    memcpy(current, start, joints * sizeof(float));
+
+    for (int steps = 0; steps < SCRIPT_DRY_RUN_STEPS; steps++) {
+        const ScriptOp& op = script.getOp(pc);
+        memcpy(next, current, joints * sizeof(float));
+
+        switch (op.code) {
+        case OP_END:
+            report.ok = true;
+            return;
+
+        case OP_REPEAT:
+            // Un REPEAT infinito conta per un giro (durata del ciclo)
+            if (op.arg == 0) {
+                report.endless = true;
+            }
+            remaining[depth++] = (op.arg == 0) ? 1 : op.arg;
+            pc++;
+            continue;
+
+        case OP_LOOP:
+            if (--remaining[depth - 1] > 0) {
+                pc = op.arg;
+            }
+            else {
+                depth--;
+                pc++;
+            }
+            continue;
+
+        case OP_WAIT:
+            report.cycleSeconds += op.values[0] / 1000.0f;
+            pc++;
+            continue;
+
+        case OP_GO:
+            memcpy(next, script.getPose(op.arg), joints * sizeof(float));
+            break;
+
+        case OP_JOINT:
+            next[op.joint] = op.values[0];
+            break;
+
+        default:
+            // Solo il punto finale: la retta viene verificata alla partenza
+            if (!target.solveTool(op.values, op.hasPitch, current, next)) {
+                report.errorLine = op.line;
+                report.error = "punto non raggiungibile";
+                return;
+            }
+            break;
+        }
+
+        if (!target.isPoseValid(next)) {
+            report.errorLine = op.line;
+            report.error = "posa fuori dai limiti o in collisione";
+            return;
+        }
+
+        report.cycleSeconds += target.estimateTime(current, next, op.code == OP_LINE);
+        report.moves++;
+        memcpy(current, next, joints * sizeof(float));
+        pc++;
+    }
+
+    report.errorLine = script.getOp(pc).line;
+    report.error = "programma troppo lungo per il dry-run";
+}
@@ -0,0 +1,180 @@
+#include "include/ParkingSequence.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+ParkingSequence::ParkingSequence() {
+    this->jointCount = 0;
+    this->stageCount = 0;
+    this->currentStage = 0;
+    this->launched = 0;
+    this->state = PARK_IDLE;
+    this->velocity = PARK_VELOCITY;
+    this->parallel = false;
+    this->startTime = 0;
+    this->budget = PARK_TIME_BUDGET_MS;
+}
+
+// ============================================================================
+// CONFIGURAZIONE E AVVIO
+// ============================================================================
+
+void ParkingSequence::setOrder(const JointMask* masks, int count) {
+    stageCount = (count < PARK_MAX_STAGES) ? count : PARK_MAX_STAGES;
+    for (int i = 0; i < stageCount; i++) {
+        stages[i] = masks[i];
+    }
+}
+
+void ParkingSequence::begin(
+    ServoMotor* const servos[],
+    const float targets[],
+    int count,
+    unsigned long now,
+    unsigned long budget
+) {
+    jointCount = (count < MAX_JOINTS) ? count : MAX_JOINTS;
+    for (int joint = 0; joint < jointCount; joint++) {
+        this->servos[joint] = servos[joint];
+        this->targets[joint] = targets[joint];
+    }
+
+    // Senza ordine configurato: un'unica fase con tutti i giunti
+    if (stageCount == 0) {
+        stages[stageCount++] = 0;
+    }
+
+    // I giunti dimenticati dall'ordine partono con l'ultima fase
+    JointMask all = (JointMask)((1UL << jointCount) - 1);
+    JointMask covered = 0;
+    for (int i = 0; i < stageCount; i++) {
+        covered |= stages[i];
+    }
+    stages[stageCount - 1] |= all & ~covered;
+
+    this->budget = budget;
+    this->startTime = now;
+    this->currentStage = 0;
+    this->launched = 0;
+    this->state = PARK_RUNNING;
+
+    // Chi si sta muovendo si ferma in rampa prima della sua fase
+    for (int joint = 0; joint < jointCount; joint++) {
+        servos[joint]->stopMove(STOP_RAMP);
+    }
+
+    // Velocità più bassa che sta nel budget (0 = limite dei giunti)
+    velocity = PARK_VELOCITY;
+    for (int attempt = 0; attempt < 3 && estimate(velocity) > budget; attempt++) {
+        velocity *= 2.0f;
+    }
+    if (estimate(velocity) > budget) {
+        velocity = 0.0f;
+    }
+    parallel = estimate(velocity) > budget;
+
+    Serial.printf("Parcheggio: %d fasi a %.0f°/s, stimato %lums (budget %lums)%s\n",
+                  stageCount, velocity, estimate(velocity), budget,
+                  parallel ? ", fasi sovrapposte" : "");
+}
+
+// ============================================================================
+// AGGIORNAMENTO
+// ============================================================================
+
+bool ParkingSequence::update(unsigned long now) {
+    if (state != PARK_RUNNING) {
+        return state != PARK_IDLE;
+    }
+
+    bool late = (now - startTime) > budget;
+    bool overlap = parallel || late;
+
+    // Una fase parte quando i suoi giunti sono fermi e le precedenti
+    // hanno finito; a budget scaduto non si aspettano più le precedenti
+    while (currentStage < stageCount) {
+        JointMask mask = stages[currentStage];
+        if (!isStageIdle(mask) || (!overlap && !isStageIdle(launched))) {
+            break;
+        }
+        startStage(mask);
+        launched |= mask;
+        currentStage++;
+    }
+
+    if (currentStage < stageCount || !isStageIdle(launched)) {
+        return false;
+    }
+
+    state = late ? PARK_LATE : PARK_DONE;
+    Serial.printf("Parcheggio completato in %lums%s\n",
+                  now - startTime, late ? " (oltre il budget)" : "");
+    return true;
+}
+
+void ParkingSequence::abort() {
+    if (state == PARK_RUNNING) {
+        state = PARK_IDLE;
+        Serial.println("Parcheggio interrotto");
+    }
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+bool ParkingSequence::isActive() const {
+    return state == PARK_RUNNING;
+}
+
+int ParkingSequence::getState() const {
+    return state;
+}
+
+int ParkingSequence::getCurrentStage() const {
+    return currentStage;
+}
+
+float ParkingSequence::getVelocity() const {
+    return velocity;
+}
+
+// ============================================================================
+// UTILITY PRIVATE
+// ============================================================================
+
+/**
+ * Durata stimata (ms) della sequenza: le fasi sono in serie,
+ * dentro una fase conta il giunto più lento
+ */
+unsigned long ParkingSequence::estimate(float velocity) const {
+    unsigned long total = 0;
+    for (int i = 0; i < stageCount; i++) {
+        unsigned long slowest = 0;
+        for (int joint = 0; joint < jointCount; joint++) {
+            if (stages[i] & (1 << joint)) {
+                unsigned long t = servos[joint]->getMinMoveTime(targets[joint], velocity);
+                if (t > slowest) slowest = t;
+            }
+        }
+        total += slowest;
+    }
+    return total;
+}
+
+bool ParkingSequence::isStageIdle(JointMask mask) const {
+    for (int joint = 0; joint < jointCount; joint++) {
+        if ((mask & (1 << joint)) && servos[joint]->isMoving()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParkingSequence::startStage(JointMask mask) {
+    // Profilo comune: i giunti della fase partono e arrivano insieme
+    JointTable::queueSync(servos, jointCount, targets, mask, velocity);
+
+    Serial.printf("Parcheggio: fase %d/%d avviata\n", currentStage + 1, stageCount);
+}
@@ -0,0 +1,204 @@
+#include "include/PowerBudget.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+PowerBudget::PowerBudget() {
+    this->budget = POWER_BUDGET_DEFAULT_MA;
+    for (int joint = 0; joint < MAX_JOINTS; joint++) {
+        this->reserved[joint] = false;
+        this->delayed[joint] = false;
+        this->reservation[joint] = 0.0f;
+    }
+    this->reservedCurrent = 0.0f;
+    resetStats();
+}
+
+void PowerBudget::setBudget(float milliAmps) {
+    budget = milliAmps;
+    Serial.printf("Budget alimentazione: %.0fmA\n", budget);
+}
+
+float PowerBudget::getBudget() const {
+    return budget;
+}
+
+// ============================================================================
+// MODELLO
+// ============================================================================
+
+float PowerBudget::jointCurrent(int loadClass, float accel, float velocity) {
+    if (accel < 0.0f) accel = -accel;
+    if (velocity < 0.0f) velocity = -velocity;
+
+    if (loadClass == LOAD_HEAVY) {
+        return POWER_IDLE_HEAVY_MA + POWER_ACCEL_HEAVY * accel + POWER_VELOCITY_HEAVY * velocity;
+    }
+    return POWER_IDLE_LIGHT_MA + POWER_ACCEL_LIGHT * accel + POWER_VELOCITY_LIGHT * velocity;
+}
+
+// ============================================================================
+// AMMISSIONE
+// ============================================================================
+
+void PowerBudget::admit(ServoMotor* const servos[], int count) {
+    if (count > MAX_JOINTS) {
+        count = MAX_JOINTS;
+    }
+
+    // Mantenimento di tutti i giunti + prenotazioni di quelli in moto
+    float total = 0.0f;
+    for (int joint = 0; joint < count; joint++) {
+        ServoMotor* servo = servos[joint];
+        float idle = jointCurrent(servo->getLoadClass(), 0.0f, 0.0f);
+
+        if (reserved[joint] && !servo->isMoving()) {
+            reserved[joint] = false;  // Tornato fermo: libera la prenotazione
+        }
+        if (!servo->isStarting()) {
+            delayed[joint] = false;
+        }
+        total += reserved[joint] ? reservation[joint] : idle;
+    }
+
+    bool done[MAX_JOINTS] = {};
+    for (int joint = 0; joint < count; joint++) {
+        // Giunti di un waypoint incompleto: li trattiene già JointTable
+        if (done[joint] || reserved[joint] || !servos[joint]->isStarting() || servos[joint]->isSyncHeld()) {
+            continue;
+        }
+
+        MotionSegment segment;
+        if (servos[joint]->getNextSegment(segment) && segment.group != 0) {
+            admitGroup(servos, count, joint, segment.group, done, total);
+        } else {
+            admitGroup(servos, count, joint, 0, done, total);
+        }
+    }
+
+    reservedCurrent = total;
+    if (total > peakCurrent) {
+        peakCurrent = total;
+    }
+}
+
+/**
+ * Ammette insieme i giunti che partono con il waypoint group (o il solo
+ * giunto first se group = 0): una sola scala per tutti, così i profili
+ * sincronizzati restano uguali e si allungano insieme; se non ci sta
+ * nemmeno alla scala minima aspettano tutti
+ */
+void PowerBudget::admitGroup(ServoMotor* const servos[], int count, int first, uint16_t group,
+                             bool done[], float& total) {
+    int members[MAX_JOINTS];
+    int memberCount = 0;
+    float idle = 0.0f;
+    float need = 0.0f;
+    float cruise = 0.0f;
+    float accel[MAX_JOINTS];
+    float velocity[MAX_JOINTS];
+
+    for (int joint = first; joint < count; joint++) {
+        ServoMotor* servo = servos[joint];
+        MotionSegment segment;
+        bool member = (joint == first);
+        if (!member && group != 0 && !reserved[joint] && servo->isStarting() && !servo->isSyncHeld()) {
+            member = servo->getNextSegment(segment) && segment.group == group;
+        }
+        if (!member) {
+            continue;
+        }
+
+        // Waypoint sincronizzato: carico del tratto di questo giunto
+        int load = servo->getLoadClass();
+        velocity[joint] = servo->getMaxVelocity() * servo->getFeedRate();
+        accel[joint] = servo->getAccelLimit();
+        if (group != 0 && servo->getNextSegment(segment) && segment.length > 0.0f) {
+            float degrees = fabsf(segment.targetAngle - segment.startAngle) / segment.length;
+            velocity[joint] = segment.maxVelocity * degrees;
+            accel[joint] = segment.maxAccel * degrees;
+        }
+
+        idle += jointCurrent(load, 0.0f, 0.0f);
+        need += jointCurrent(load, accel[joint], velocity[joint]);
+        cruise += jointCurrent(load, 0.0f, velocity[joint]);
+        members[memberCount++] = joint;
+        done[joint] = true;
+    }
+
+    // Non ci sta: riduce l'accelerazione quanto basta
+    float available = budget - total + idle;
+    float scale = 1.0f;
+    if (need > available) {
+        scale = (available - cruise) / (need - cruise);
+    }
+
+    if (scale < POWER_MIN_ACCEL_SCALE) {
+        // Nemmeno scalato: la partenza aspetta un giunto che si ferma
+        bool logged = false;
+        for (int i = 0; i < memberCount; i++) {
+            int joint = members[i];
+            servos[joint]->setStartHold(true);
+            if (!delayed[joint] && !logged) {
+                delayedStarts++;
+                logged = true;
+                Serial.printf("Ch%d: partenza rimandata (%.0f/%.0fmA)\n",
+                              servos[joint]->getChannel(), total, budget);
+            }
+            delayed[joint] = true;
+        }
+        delayedTicks++;
+        return;
+    }
+
+    if (scale < 1.0f) {
+        scaledStarts++;
+        Serial.printf("Ch%d: accelerazione al %.0f%% per il budget\n",
+                      servos[first]->getChannel(), scale * 100.0f);
+    }
+
+    for (int i = 0; i < memberCount; i++) {
+        int joint = members[i];
+        ServoMotor* servo = servos[joint];
+        int load = servo->getLoadClass();
+
+        servo->setAccelScale(scale);
+        servo->setStartHold(false);
+        delayed[joint] = false;
+        reserved[joint] = true;
+        reservation[joint] = jointCurrent(load, accel[joint] * scale, velocity[joint]);
+        total += reservation[joint] - jointCurrent(load, 0.0f, 0.0f);
+    }
+}
+
+// ============================================================================
+// STATISTICHE
+// ============================================================================
+
+float PowerBudget::getReservedCurrent() const {
+    return reservedCurrent;
+}
+
+float PowerBudget::getPeakCurrent() const {
+    return peakCurrent;
+}
+
+unsigned long PowerBudget::getScaledStarts() const {
+    return scaledStarts;
+}
+
+unsigned long PowerBudget::getDelayedStarts() const {
+    return delayedStarts;
+}
+
+unsigned long PowerBudget::getDelayedTicks() const {
+    return delayedTicks;
+}
+
+void PowerBudget::resetStats() {
+    peakCurrent = 0.0f;
+    scaledStarts = 0;
+    delayedStarts = 0;
+    delayedTicks = 0;
+}
@@ -0,0 +1,119 @@
+#include "include/PwmFrame.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+PwmFrame::PwmFrame() {
+    for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+        this->on[channel] = 0;
+        this->off[channel] = PWM_FULL_OFF;  // Stato del PCA9685 dopo il reset
+    }
+    this->dirty = 0;
+}
+
+// ============================================================================
+// REGISTRI
+// ============================================================================
+
+void PwmFrame::set(int channel, uint16_t onValue, uint16_t offValue) {
+    if (channel < 0 || channel >= PWM_CHANNELS) {
+        return;
+    }
+    if (on[channel] == onValue && off[channel] == offValue) {
+        return;
+    }
+
+    on[channel] = onValue;
+    off[channel] = offValue;
+    dirty |= (uint16_t)(1 << channel);
+}
+
+bool PwmFrame::isDirty() const {
+    return dirty != 0;
+}
+
+uint16_t PwmFrame::getDirtyMask() const {
+    return dirty;
+}
+
+void PwmFrame::clearDirty() {
+    dirty = 0;
+}
+
+void PwmFrame::markDirty(uint16_t mask) {
+    dirty |= mask;
+}
+
+uint16_t PwmFrame::getOn(int channel) const {
+    return on[channel];
+}
+
+uint16_t PwmFrame::getOff(int channel) const {
+    return off[channel];
+}
+
+// ============================================================================
+// PIANIFICAZIONE
+// ============================================================================
+
+int PwmFrame::plan(PwmRun* runs) const {
+    int count = 0;
+    int channel = 0;
+
+    while (channel < PWM_CHANNELS) {
+        if (!(dirty & (1 << channel))) {
+            channel++;
+            continue;
+        }
+
+        PwmRun run;
+        run.first = channel;
+        run.last = channel;
+
+        // Estende il gruppo finché il buco da riscrivere costa meno
+        // di una nuova transazione
+        int next = channel + 1;
+        while (next < PWM_CHANNELS) {
+            if (dirty & (1 << next)) {
+                int gap = next - run.last - 1;
+                if (gap * PWM_BYTES_PER_CHANNEL > I2C_TRANSACTION_OVERHEAD) {
+                    break;
+                }
+                run.last = next;
+            }
+            else if ((next - run.last) * PWM_BYTES_PER_CHANNEL > I2C_TRANSACTION_OVERHEAD) {
+                break;
+            }
+            next++;
+        }
+
+        runs[count++] = run;
+        channel = run.last + 1;
+    }
+
+    return count;
+}
+
+int PwmFrame::encode(const PwmRun& run, uint8_t* buffer) const {
+    int length = 0;
+    buffer[length++] = PCA9685_LED0_ON_L_REG + PWM_BYTES_PER_CHANNEL * run.first;
+
+    for (int channel = run.first; channel <= run.last; channel++) {
+        buffer[length++] = on[channel] & 0xFF;
+        buffer[length++] = on[channel] >> 8;
+        buffer[length++] = off[channel] & 0xFF;
+        buffer[length++] = off[channel] >> 8;
+    }
+
+    return length;
+}
+
+int PwmFrame::busBytes(const PwmRun* runs, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        int channels = runs[i].last - runs[i].first + 1;
+        total += I2C_TRANSACTION_OVERHEAD + PWM_BYTES_PER_CHANNEL * channels;
+    }
+    return total;
+}
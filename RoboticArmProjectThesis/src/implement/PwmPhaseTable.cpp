@@ -0,0 +1,71 @@
+#include "include/PwmPhaseTable.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+PwmPhaseTable::PwmPhaseTable() {
+    for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+        this->offsets[channel] = 0;
+        this->used[channel] = false;
+    }
+    this->count = 0;
+}
+
+// ============================================================================
+// CANALI
+// ============================================================================
+
+bool PwmPhaseTable::add(int channel) {
+    if (channel < 0 || channel >= PWM_CHANNELS || used[channel]) {
+        return false;
+    }
+
+    used[channel] = true;
+    count++;
+    rebuild();
+    return true;
+}
+
+bool PwmPhaseTable::contains(int channel) const {
+    return channel >= 0 && channel < PWM_CHANNELS && used[channel];
+}
+
+int PwmPhaseTable::getCount() const {
+    return count;
+}
+
+uint16_t PwmPhaseTable::getOffset(int channel) const {
+    return contains(channel) ? offsets[channel] : 0;
+}
+
+// ============================================================================
+// REGISTRI
+// ============================================================================
+
+void PwmPhaseTable::window(int channel, uint16_t pulse, uint16_t& on, uint16_t& off) const {
+    if (pulse == 0) {
+        on = 0;
+        off = PWM_FULL_OFF;
+        return;
+    }
+    if (pulse >= PWM_PERIOD_COUNTS) {
+        pulse = PWM_PERIOD_COUNTS - 1;
+    }
+
+    on = getOffset(channel);
+    off = (on + pulse) % PWM_PERIOD_COUNTS;
+}
+
+/**
+ * Slot equispaziati in ordine di canale
+ */
+void PwmPhaseTable::rebuild() {
+    int slot = 0;
+    for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+        if (used[channel]) {
+            offsets[channel] = (uint16_t)((uint32_t)slot * PWM_PERIOD_COUNTS / count);
+            slot++;
+        }
+    }
+}
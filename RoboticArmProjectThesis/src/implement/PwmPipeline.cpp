@@ -0,0 +1,270 @@
+#include "include/PwmPipeline.h"
+#include "include/set_up.h"
+
+// ============================================================================
+// BATCH
+// ============================================================================
+
+bool PwmBatch::add(int board, uint8_t address, uint16_t mask, const uint8_t* bytes, int size) {
+    if (count >= PWM_BATCH_TRANSFERS || length + size > PWM_BATCH_BYTES) {
+        return false;
+    }
+
+    PwmTransfer& transfer = transfers[count++];
+    transfer.board = board;
+    transfer.address = address;
+    transfer.length = size;
+    transfer.offset = length;
+    transfer.mask = mask;
+
+    memcpy(data + length, bytes, size);
+    length += size;
+    return true;
+}
+
+void PwmBatch::clear() {
+    count = 0;
+    length = 0;
+}
+
+// ============================================================================
+// COSTRUTTORE E AVVIO
+// ============================================================================
+
+PwmPipeline::PwmPipeline() : bus(SDA_PIN, SCL_PIN, I2C_CLOCK_HZ), link(bus) {
+    for (int board = 0; board < MAX_BOARDS; board++) {
+        this->failed[board] = 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        this->batches[i].clear();
+        this->batches[i].state = BATCH_FREE;
+        for (int board = 0; board < MAX_BOARDS; board++) {
+            this->batches[i].dirty[board] = 0;
+        }
+    }
+    this->task = nullptr;
+    this->lock = portMUX_INITIALIZER_UNLOCKED;
+    this->running = false;
+
+    this->completed = 0;
+    this->errors = 0;
+    this->lastError = 0;
+    this->lastErrorAddress = 0;
+    this->lastBusMicros = 0;
+    this->maxBusMicros = 0;
+    this->deferred = 0;
+    this->reclaimed = 0;
+}
+
+bool PwmPipeline::begin() {
+    if (running) {
+        return true;
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "pwm_i2c", PWM_PIPELINE_STACK,
+                                                this, PWM_PIPELINE_PRIORITY, &task,
+                                                PWM_PIPELINE_CORE);
+    running = (result == pdPASS);
+
+    if (!running) {
+        Serial.println("PWM pipeline: task non avviato, invio sincrono");
+    }
+    return running;
+}
+
+bool PwmPipeline::isRunning() const {
+    return running;
+}
+
+uint8_t PwmPipeline::probe(uint8_t address) {
+    uint8_t result = link.send(address, nullptr, 0);
+
+    // Bus bloccato all'avvio: bus-clear completo e un nuovo tentativo
+    for (int i = 0; i <= I2C_CLEAR_PULSES && link.getState() == LINK_CLEARING; i++) {
+        link.step();
+    }
+    if (result != I2C_OK && link.isReady()) {
+        result = link.send(address, nullptr, 0);
+    }
+    return result;
+}
+
+// ============================================================================
+// LATO MOTION TASK
+// ============================================================================
+
+PwmBatch* PwmPipeline::acquire() {
+    PwmBatch* batch = nullptr;
+
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < 2 && batch == nullptr; i++) {
+        if (batches[i].state == BATCH_READY) {
+            batch = &batches[i];
+        }
+    }
+    if (batch != nullptr) {
+        reclaimed++;
+    }
+    else {
+        for (int i = 0; i < 2 && batch == nullptr; i++) {
+            if (batches[i].state == BATCH_FREE) {
+                batch = &batches[i];
+                for (int board = 0; board < MAX_BOARDS; board++) {
+                    batch->dirty[board] = 0;
+                }
+            }
+        }
+    }
+    if (batch != nullptr) {
+        batch->state = BATCH_FILLING;
+    }
+    else {
+        deferred++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return batch;
+}
+
+void PwmPipeline::submit(PwmBatch* batch) {
+    if (batch->count == 0) {
+        batch->state = BATCH_FREE;
+        return;
+    }
+
+    if (!running) {
+        link.step();
+        transmit(*batch);
+        batch->state = BATCH_FREE;
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    batch->state = BATCH_READY;
+    portEXIT_CRITICAL(&lock);
+
+    xTaskNotifyGive(task);
+}
+
+bool PwmPipeline::isBusy() const {
+    return batches[0].state != BATCH_FREE || batches[1].state != BATCH_FREE;
+}
+
+uint16_t PwmPipeline::takeFailed(int board) {
+    portENTER_CRITICAL(&lock);
+    uint16_t mask = failed[board];
+    failed[board] = 0;
+    portEXIT_CRITICAL(&lock);
+    return mask;
+}
+
+const I2cLink& PwmPipeline::getLink() const {
+    return link;
+}
+
+// ============================================================================
+// TASK DI TRASMISSIONE
+// ============================================================================
+
+void PwmPipeline::taskEntry(void* param) {
+    static_cast<PwmPipeline*>(param)->run();
+}
+
+void PwmPipeline::run() {
+    while (true) {
+        // Durante il recupero del bus si avanza di un passo ogni tick RTOS
+        ulTaskNotifyTake(pdTRUE, link.isReady() ? portMAX_DELAY : 1);
+        if (!link.step()) {
+            continue;
+        }
+
+        // Svuota tutti i batch pronti (anche quelli arrivati durante l'invio)
+        PwmBatch* batch;
+        while ((batch = take()) != nullptr) {
+            transmit(*batch);
+
+            portENTER_CRITICAL(&lock);
+            batch->state = BATCH_FREE;
+            portEXIT_CRITICAL(&lock);
+        }
+    }
+}
+
+PwmBatch* PwmPipeline::take() {
+    PwmBatch* batch = nullptr;
+
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < 2 && batch == nullptr; i++) {
+        if (batches[i].state == BATCH_READY) {
+            batch = &batches[i];
+            batch->state = BATCH_SENDING;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return batch;
+}
+
+void PwmPipeline::transmit(PwmBatch& batch) {
+    unsigned long start = micros();
+
+    for (int i = 0; i < batch.count; i++) {
+        const PwmTransfer& transfer = batch.transfers[i];
+
+        uint8_t error = link.send(transfer.address, batch.data + transfer.offset, transfer.length);
+
+        if (error != I2C_OK) {
+            // Canali da reinviare al prossimo flush (nessun frame perso)
+            portENTER_CRITICAL(&lock);
+            failed[transfer.board] |= transfer.mask;
+            portEXIT_CRITICAL(&lock);
+
+            lastError = error;
+            lastErrorAddress = transfer.address;
+            errors = errors + 1;
+        }
+    }
+
+    unsigned long elapsed = micros() - start;
+    lastBusMicros = elapsed;
+    if (elapsed > maxBusMicros) {
+        maxBusMicros = elapsed;
+    }
+    completed = completed + 1;
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+unsigned long PwmPipeline::getCompleted() const {
+    return completed;
+}
+
+unsigned long PwmPipeline::getErrors() const {
+    return errors;
+}
+
+uint8_t PwmPipeline::getLastError() const {
+    return lastError;
+}
+
+uint8_t PwmPipeline::getLastErrorAddress() const {
+    return lastErrorAddress;
+}
+
+unsigned long PwmPipeline::getLastBusMicros() const {
+    return lastBusMicros;
+}
+
+unsigned long PwmPipeline::getMaxBusMicros() const {
+    return maxBusMicros;
+}
+
+unsigned long PwmPipeline::getDeferred() const {
+    return deferred;
+}
+
+unsigned long PwmPipeline::getReclaimed() const {
+    return reclaimed;
+}
@@ -0,0 +1,68 @@
+#include "include/PwmSync.h"
+
+// ============================================================================
+// COSTRUTTORE E AVVIO
+// ============================================================================
+
+PwmSync::PwmSync() {
+    this->pin = -1;
+    this->period = 20000;
+    this->lastEdge = 0;
+    this->edges = 0;
+}
+
+void PwmSync::begin(int pin, unsigned long periodMicros) {
+    this->pin = pin;
+    this->period = periodMicros;
+    if (pin < 0) {
+        return;
+    }
+
+    pinMode(pin, INPUT);
+    attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, RISING);
+    Serial.printf("PWM sync: GPIO%d, periodo %luus\n", pin, periodMicros);
+}
+
+void PwmSync::setPeriod(unsigned long periodMicros) {
+    period = periodMicros;
+}
+
+void IRAM_ATTR PwmSync::onEdge(void* arg) {
+    PwmSync* sync = static_cast<PwmSync*>(arg);
+    sync->lastEdge = micros();
+    sync->edges = sync->edges + 1;
+}
+
+// ============================================================================
+// FASE
+// ============================================================================
+
+bool PwmSync::isLocked(unsigned long now) const {
+    return pin >= 0 && edges > 1 && now - lastEdge < period * PWM_SYNC_TIMEOUT_PERIODS;
+}
+
+unsigned long PwmSync::untilNextPeriod(unsigned long now) const {
+    unsigned long elapsed = (now - lastEdge) % period;
+    return period - elapsed;
+}
+
+long PwmSync::phaseError(unsigned long now, unsigned long lead) const {
+    long error = (long)untilNextPeriod(now) - (long)lead;
+
+    // Il fronte più vicino: scarto entro mezzo periodo
+    if (error > (long)period / 2) {
+        error -= period;
+    }
+    else if (error < -(long)period / 2) {
+        error += period;
+    }
+    return error;
+}
+
+unsigned long PwmSync::getEdges() const {
+    return edges;
+}
+
+unsigned long PwmSync::getPeriod() const {
+    return period;
+}
@@ -1,5 +1,7 @@
 #include "include/ServoBase.h"
 
+bool ServoMotor::motionLog = true;
+
 // ============================================================================
 // COSTRUTTORE
 // ============================================================================
@@ -13,6 +15,7 @@ ServoMotor::ServoMotor(
     int safeMin,
     int safeMax
 ) {
+    this->board = 0;
     this->channel = channel;
     this->minPulse = minPulse;
     this->maxPulse = maxPulse;
@@ -25,9 +28,31 @@ ServoMotor::ServoMotor(
     
     // Inizializza al centro del range sicuro
     this->currentAngle = (safeMinAngle + safeMaxAngle) / 2;
+    this->position = currentAngle;
     this->trim = 0;
     this->safetyEnabled = true;
     this->moving = false;
+    this->profilePhase = 0.0f;
+    this->feedRate = 1.0f;
+    this->accelLimit = planner.getMaxAccel();
+    this->accelScale = 1.0f;
+    this->startHold = false;
+    this->syncHold = false;
+    this->loadClass = LOAD_LIGHT;
+    this->jogging = false;
+    this->jogPosition = currentAngle;
+    this->jogVelocity = 0.0f;
+    this->jogTarget = 0.0f;
+    this->jogKeepalive = 0;
+    this->jogMin = safeMinAngle;
+    this->jogMax = safeMaxAngle;
+    this->planner.reset(currentAngle);
+    this->moveTick = 0;
+    this->moveTicks = 0;
+    this->segmentCount = 0;
+    this->saturationCount = 0;
+    this->lastPulse = 0;  // Sconosciuto: la prima scrittura avviene sempre
+    this->calibration.setLinear(minAngle, maxAngle, minPulse, maxPulse);
     
     Serial.printf(
         "ServoMotor Ch%d | Range: %d°-%d° | Safe: %d°-%d° | PWM: %d-%d\n",
@@ -39,113 +64,260 @@ ServoMotor::ServoMotor(
 // MOVIMENTO IMMEDIATO
 // ============================================================================
 
-void ServoMotor::moveServo(Adafruit_PWMServoDriver& pwm, float angle) {
+void ServoMotor::moveServo(ServoOutput& pwm, float angle) {
     // Applica limiti di sicurezza
-    angle = applySafetyLimits(angle);
+    angle = limitCommand(angle);
     
     // Converti a PWM
     uint16_t pulse = angleToPulse(angle);
     
     // Invia al servo
-    pwm.setPWM(channel, 0, pulse);
+    emitPulse(pwm, pulse);
     
     // Aggiorna stato
-    currentAngle = (int)angle;
+    setPosition(angle);
     moving = false;
+    jogging = false;
+    planner.reset(position);
 }
 
-void ServoMotor::moveRelative(Adafruit_PWMServoDriver& pwm, int delta) {
+void ServoMotor::moveRelative(ServoOutput& pwm, int delta) {
     float newAngle = currentAngle + delta;
     moveServo(pwm, newAngle);
 }
 
+void ServoMotor::writePulse(ServoOutput& pwm, uint16_t pulse) {
+    pulse = clampPulse(pulse);
+    emitPulse(pwm, pulse);
+    setPosition(calibration.pulseToAngle(pulse - trim));
+}
+
 // ============================================================================
 // MOVIMENTO SMOOTH NON-BLOCCANTE
 // ============================================================================
 
-void ServoMotor::startSmoothMove(
-    Adafruit_PWMServoDriver& pwm, 
-    float targetAngle, 
-    uint16_t duration, 
-    uint16_t steps  // Ignorato
-) {
-    targetAngle = applySafetyLimits(targetAngle);
+bool ServoMotor::queueMove(float targetAngle, float maxVelocity, uint16_t minDuration) {
+    targetAngle = limitCommand(targetAngle);
     
-    // Se già in movimento, completa quello attuale
-    if (moving) {
-        currentAngle = (int)moveTargetAngle;
+    if (!canTakeWaypoint()) {
+        return false;
     }
     
-    // Inizializza nuovo movimento
-    moving = true;
-    moveStartAngle = currentAngle;
-    moveTargetAngle = targetAngle;
-    moveStartTime = millis();
-    moveDuration = duration;
+    // Durata minima → velocità di crociera equivalente
+    float velocity = (maxVelocity > 0.0f) ? maxVelocity : planner.getMaxVelocity();
+    if (minDuration > 0) {
+        float distance = targetAngle - planner.getEndPosition();
+        float v = planner.velocityForDuration(distance, minDuration / 1000.0f);
+        if (v < velocity) {
+            velocity = v;
+        }
+    }
+    velocity *= feedRate;
     
-    Serial.printf(
-        "Ch%d: %.0f° → %.0f° in %dms\n",
-        channel, moveStartAngle, moveTargetAngle, duration
-    );
+    resumeActive();
+    planner.push(targetAngle, velocity);
+    
+    if (motionLog) {
+        Serial.printf(
+            "Ch%d: → %.0f° (coda %d)\n",
+            channel, targetAngle, planner.getCount()
+        );
+    }
+    return true;
+}
+
+bool ServoMotor::queueSyncMove(float targetAngle, const SyncProfile& sync) {
+    targetAngle = limitCommand(targetAngle);
+    
+    if (!canTakeWaypoint()) {
+        return false;
+    }
+    
+    resumeActive();
+    planner.pushSync(targetAngle, sync);
+    
+    if (motionLog) {
+        Serial.printf(
+            "Ch%d: → %.0f° (waypoint %u, coda %d)\n",
+            channel, targetAngle, sync.group, planner.getCount()
+        );
+    }
+    return true;
+}
+
+bool ServoMotor::dropLastMove() {
+    return planner.dropLast();
 }
 
-bool ServoMotor::updateSmoothMove(Adafruit_PWMServoDriver& pwm) {
+bool ServoMotor::startSmoothMove(
+    ServoOutput& pwm, 
+    float targetAngle, 
+    uint16_t duration, 
+    uint16_t steps  // Ignorato
+) {
+    return queueMove(targetAngle, 0.0f, duration);
+}
+
+bool ServoMotor::updateSmoothMove(ServoOutput& pwm) {
+    if (jogging) {
+        return updateJog(pwm);
+    }
+    
     if (!moving) {
-        return true;  // Nessun movimento attivo
+        if (startHold || syncHold || !planner.next(profile)) {
+            return true;  // Nessun movimento attivo
+        }
+        beginSegment(0.0f);
     }
     
-    unsigned long elapsed = millis() - moveStartTime;
+    moveTick++;
     
-    // Movimento completato
-    if (elapsed >= moveDuration) {
-        // Posizione finale esatta
-        uint16_t pulse = angleToPulse(moveTargetAngle);
-        pwm.setPWM(channel, 0, pulse);
+    // Segmento completato
+    if (moveTick >= moveTicks) {
+        // Raccordo: il tick cade già dentro il segmento successivo,
+        // si emette il suo campione al tempo residuo. Un waypoint di
+        // più giunti che parte da fermo invece aspetta il tick dopo,
+        // quando tutti i suoi giunti partono insieme
+        float carry = moveTicks * MOTION_PERIOD_S + profilePhase - profile.duration;
+        MotionSegment following;
+        bool waits = planner.peek(following) && following.group != 0 && following.entryVelocity == 0.0f;
+        if (!waits && planner.next(profile)) {
+            beginSegment(carry);
+            emitSample(pwm, 0);
+            return false;
+        }
         
-        currentAngle = (int)moveTargetAngle;
+        // Posizione finale esatta
+        emitSample(pwm, moveTicks);
         moving = false;
-        
-        Serial.printf("Ch%d: Raggiunto %.0f°\n", channel, moveTargetAngle);
+        if (motionLog) {
+            Serial.printf("Ch%d: Raggiunto %d°\n", channel, currentAngle);
+        }
         return true;
     }
     
-    // Calcola posizione corrente (interpolazione lineare)
-    float progress = (float)elapsed / moveDuration;  // 0.0 → 1.0
-    float angleDiff = moveTargetAngle - moveStartAngle;
-    float currentPos = moveStartAngle + (angleDiff * progress);
+    emitSample(pwm, moveTick);
+    return false;  // Movimento in corso
+}
+
+void ServoMotor::stopMove(StopMode mode) {
+    if (!isMoving()) {
+        return;
+    }
     
-    // Aggiorna servo
-    uint16_t pulse = angleToPulse(currentPos);
-    pwm.setPWM(channel, 0, pulse);
+    // Rampa solo se il giunto ha velocità da smaltire
+    if (mode == STOP_RAMP && currentVelocity() != 0.0f) {
+        beginRamp();
+        jogTarget = 0.0f;
+        Serial.printf("Ch%d: Arresto in rampa da %.0f°/s\n", channel, jogVelocity);
+        return;
+    }
     
-    return false;  // Movimento in corso
+    // position è già l'angolo dell'ultimo pulse scritto
+    moving = false;
+    jogging = false;
+    planner.reset(position);
+    Serial.printf("Ch%d: Movimento interrotto a %.1f°\n", channel, position);
 }
 
-void ServoMotor::stopMove() {
-    if (moving) {
-        moving = false;
-        Serial.printf("Ch%d: Movimento interrotto\n", channel);
+// ============================================================================
+// JOG A VELOCITÀ COSTANTE
+// ============================================================================
+
+void ServoMotor::jog(float velocity) {
+    float limit = planner.getMaxVelocity() * feedRate;
+    velocity *= feedRate;
+    jogTarget = constrain(velocity, -limit, limit);
+    jogKeepalive = millis();
+    
+    if (jogging) {
+        return;
     }
+    
+    // Parte dallo stato attuale, anche a movimento in corso
+    beginRamp();
+    
+    Serial.printf("Ch%d: Jog %.0f°/s\n", channel, jogTarget);
+}
+
+void ServoMotor::jogStop() {
+    if (jogging) {
+        jogTarget = 0.0f;
+    }
+}
+
+void ServoMotor::setJogWindow(float minAngle, float maxAngle) {
+    jogMin = (minAngle > safeMinAngle) ? minAngle : safeMinAngle;
+    jogMax = (maxAngle < safeMaxAngle) ? maxAngle : safeMaxAngle;
+}
+
+/**
+ * Un tick di jog: rampa di velocità, frenata prima dei limiti, emissione
+ * @return true quando il jog si è fermato
+ */
+bool ServoMotor::updateJog(ServoOutput& pwm) {
+    float accel = planner.getMaxAccel();
+    float dv = accel * MOTION_PERIOD_S;
+    
+    // Keepalive scaduto: come un rilascio
+    if (millis() - jogKeepalive > JOG_KEEPALIVE_MS) {
+        jogTarget = 0.0f;
+    }
+    
+    // Frena in tempo per fermarsi sul limite del jog
+    // (da fermo resta fermo finché la partenza non è ammessa)
+    float target = (startHold && jogVelocity == 0.0f) ? 0.0f : jogTarget;
+    float brake = jogVelocity * jogVelocity / (2.0f * accel);
+    if (jogVelocity > 0.0f && jogMax - jogPosition <= brake) {
+        target = 0.0f;
+    }
+    if (jogVelocity < 0.0f && jogPosition - jogMin <= brake) {
+        target = 0.0f;
+    }
+    
+    // Rampa verso la velocità richiesta
+    if (jogVelocity < target) {
+        jogVelocity = (jogVelocity + dv < target) ? jogVelocity + dv : target;
+    }
+    else if (jogVelocity > target) {
+        jogVelocity = (jogVelocity - dv > target) ? jogVelocity - dv : target;
+    }
+    
+    jogPosition = applySafetyLimits(jogPosition + jogVelocity * MOTION_PERIOD_S);
+    jogPosition = constrain(jogPosition, jogMin, jogMax);
+    emitPulse(pwm, angleToPulse(jogPosition));
+    setPosition(jogPosition);
+    
+    if (jogVelocity == 0.0f && jogTarget == 0.0f) {
+        jogging = false;
+        jogMin = safeMinAngle;
+        jogMax = safeMaxAngle;
+        planner.reset(jogPosition);
+        Serial.printf("Ch%d: Jog fermo a %d°\n", channel, currentAngle);
+        return true;
+    }
+    
+    return false;
 }
 
 // ============================================================================
 // POSIZIONI PREDEFINITE
 // ============================================================================
 
-void ServoMotor::moveToMin(Adafruit_PWMServoDriver& pwm) {
+void ServoMotor::moveToMin(ServoOutput& pwm) {
     moveServo(pwm, safeMinAngle);
 }
 
-void ServoMotor::moveToMax(Adafruit_PWMServoDriver& pwm) {
+void ServoMotor::moveToMax(ServoOutput& pwm) {
     moveServo(pwm, safeMaxAngle);
 }
 
-void ServoMotor::moveToCenter(Adafruit_PWMServoDriver& pwm) {
+void ServoMotor::moveToCenter(ServoOutput& pwm) {
     int center = (safeMinAngle + safeMaxAngle) / 2;
     moveServo(pwm, center);
 }
 
-void ServoMotor::moveToSafePosition(Adafruit_PWMServoDriver& pwm, int angle) {
+void ServoMotor::moveToSafePosition(ServoOutput& pwm, int angle) {
     moveServo(pwm, angle);
 }
 
@@ -157,12 +329,115 @@ int ServoMotor::getCurrentAngle() const {
     return currentAngle;
 }
 
+float ServoMotor::getPosition() const {
+    return position;
+}
+
 int ServoMotor::getChannel() const {
     return channel;
 }
 
+void ServoMotor::setBoard(int board) {
+    this->board = board;
+}
+
+int ServoMotor::getBoard() const {
+    return board;
+}
+
 bool ServoMotor::isMoving() const {
-    return moving;
+    return moving || jogging || !planner.isEmpty();
+}
+
+float ServoMotor::getTargetAngle() const {
+    return isMoving() ? planner.getEndPosition() : position;
+}
+
+bool ServoMotor::canQueueMove() const {
+    return !planner.isFull();
+}
+
+float ServoMotor::getMoveDistance(float targetAngle) const {
+    return applySafetyLimits(targetAngle) - planner.getEndPosition();
+}
+
+bool ServoMotor::getLastSegment(MotionSegment& segment) const {
+    return !jogging && planner.getTail(segment, moving);
+}
+
+bool ServoMotor::getNextSegment(MotionSegment& segment) const {
+    return !jogging && planner.peek(segment);
+}
+
+bool ServoMotor::hasWaypoint(uint16_t group) const {
+    return !jogging && planner.contains(group);
+}
+
+int ServoMotor::getQueuedMoves() const {
+    return planner.getCount();
+}
+
+unsigned long ServoMotor::getMinMoveTime(float targetAngle, float maxVelocity) const {
+    float distance = applySafetyLimits(targetAngle) - getTargetAngle();
+    float velocity = (maxVelocity > 0.0f) ? maxVelocity : planner.getMaxVelocity();
+    velocity *= feedRate;
+    return (unsigned long)(planner.restToRestTime(distance, velocity) * 1000.0f + 0.5f);
+}
+
+float ServoMotor::getRestToRestTime(float fromAngle, float toAngle) const {
+    float distance = applySafetyLimits(toAngle) - applySafetyLimits(fromAngle);
+    return planner.restToRestTime(distance, planner.getMaxVelocity() * feedRate);
+}
+
+float ServoMotor::getMaxVelocity() const {
+    return planner.getMaxVelocity();
+}
+
+float ServoMotor::getMaxAccel() const {
+    return planner.getMaxAccel();
+}
+
+bool ServoMotor::isJogging() const {
+    return jogging;
+}
+
+float ServoMotor::getFeedRate() const {
+    return feedRate;
+}
+
+bool ServoMotor::isStarting() const {
+    if (jogging) {
+        return jogVelocity == 0.0f && jogTarget != 0.0f;
+    }
+    return !moving && !planner.isEmpty();
+}
+
+int ServoMotor::getLoadClass() const {
+    return loadClass;
+}
+
+int ServoMotor::getMaxRefresh() const {
+    return SERVO_NOMINAL_FREQUENCY;
+}
+
+unsigned long ServoMotor::getSegmentCount() const {
+    return segmentCount;
+}
+
+uint16_t ServoMotor::getSegmentTicks() const {
+    return moving ? moveTicks : 0;
+}
+
+unsigned long ServoMotor::getSaturationCount() const {
+    return saturationCount;
+}
+
+float ServoMotor::getAccelLimit() const {
+    return accelLimit;
+}
+
+float ServoMotor::getAccelScale() const {
+    return accelScale;
 }
 
 bool ServoMotor::isAngleSafe(int angle) const {
@@ -170,6 +445,26 @@ bool ServoMotor::isAngleSafe(int angle) const {
     return (angle >= safeMinAngle) && (angle <= safeMaxAngle);
 }
 
+int ServoMotor::getSafeMinAngle() const {
+    return safeMinAngle;
+}
+
+int ServoMotor::getSafeMaxAngle() const {
+    return safeMaxAngle;
+}
+
+uint16_t ServoMotor::getMinPulse() const {
+    return minPulse;
+}
+
+uint16_t ServoMotor::getMaxPulse() const {
+    return maxPulse;
+}
+
+const ServoCalibration& ServoMotor::getCalibration() const {
+    return calibration;
+}
+
 String ServoMotor::getDebugInfo() const {
     String info = "\n╔════════════════════════════════════╗\n";
     info += "║  SERVO DEBUG Ch" + String(channel) + "                  ║\n";
@@ -177,10 +472,13 @@ String ServoMotor::getDebugInfo() const {
     info += "Current:  " + String(currentAngle) + "°\n";
     info += "Range:    " + String(minAngle) + "° - " + String(maxAngle) + "°\n";
     info += "Safety:   " + String(safeMinAngle) + "° - " + String(safeMaxAngle) + "°\n";
-    info += "Moving:   " + String(moving ? "YES" : "NO") + "\n";
+    info += "Moving:   " + String(isMoving() ? "YES" : "NO") + "\n";
+    if (isMoving()) {
+        info += "Target:   " + String((int)getTargetAngle()) + "°\n";
+        info += "Queue:    " + String(planner.getCount()) + "\n";
+    }
     if (moving) {
-        info += "Target:   " + String((int)moveTargetAngle) + "°\n";
-        info += "Progress: " + String((int)((millis() - moveStartTime) * 100.0 / moveDuration)) + "%\n";
+        info += "Progress: " + String((int)(moveTick * 100L / moveTicks)) + "%\n";
     }
     return info;
 }
@@ -217,33 +515,80 @@ void ServoMotor::setTrim(int trimValue) {
     Serial.printf("Ch%d: Trim = %d\n", channel, trim);
 }
 
+void ServoMotor::setMotionLimits(float maxVelocity, float maxAccel) {
+    accelLimit = maxAccel;
+    planner.setLimits(maxVelocity, accelLimit, accelScale);
+    Serial.printf("Ch%d: Limiti %.0f°/s, %.0f°/s²\n", channel, maxVelocity, maxAccel);
+}
+
+void ServoMotor::setFeedRate(float rate) {
+    feedRate = constrain(rate, 0.05f, 1.0f);
+}
+
+void ServoMotor::setMotionLog(bool enabled) {
+    motionLog = enabled;
+}
+
+void ServoMotor::setStartHold(bool hold) {
+    startHold = hold;
+}
+
+void ServoMotor::setSyncHold(bool hold) {
+    syncHold = hold;
+}
+
+bool ServoMotor::isSyncHeld() const {
+    return syncHold;
+}
+
+void ServoMotor::setAccelScale(float scale) {
+    scale = constrain(scale, 0.05f, 1.0f);
+    if (scale != accelScale) {
+        accelScale = scale;
+        planner.setLimits(planner.getMaxVelocity(), accelLimit, accelScale);
+    }
+}
+
+bool ServoMotor::setCalibration(const ServoCalibration& cal) {
+    if (cal.getMinAngle() != minAngle || cal.getMaxAngle() != maxAngle) {
+        Serial.printf("Ch%d: Calibration range mismatch!\n", channel);
+        return false;
+    }
+
+    if (!cal.isMonotonic()) {
+        Serial.printf("Ch%d: Calibration not monotonic!\n", channel);
+        return false;
+    }
+
+    calibration = cal;
+    Serial.printf("Ch%d: Calibration loaded\n", channel);
+    return true;
+}
+
+void ServoMotor::resetCalibration() {
+    calibration.setLinear(minAngle, maxAngle, minPulse, maxPulse);
+}
+
 // ============================================================================
 // UTILITY PROTETTE
 // ============================================================================
 
-uint16_t ServoMotor::angleToPulse(float angle) {
+uint16_t ServoMotor::angleToPulse(float angle) const {
     // Limita al range fisico
     angle = constrain(angle, minAngle, maxAngle);
     
-    // Mappa angolo → PWM
-    uint16_t pulse = map(
-        angle * 10,
-        minAngle * 10,
-        maxAngle * 10,
-        minPulse,
-        maxPulse
-    );
-    
-    // Applica trim
-    pulse += trim;
-    
-    // Sicurezza finale
-    pulse = constrain(pulse, minPulse, maxPulse);
+    // Mappa angolo → PWM tramite curva di calibrazione
+    int pulse = calibration.angleToPulse(angle);
     
-    return pulse;
+    // Applica trim e sicurezza finale
+    return clampPulse(pulse + trim);
+}
+
+uint16_t ServoMotor::clampPulse(int pulse) const {
+    return constrain(pulse, (int)minPulse, (int)maxPulse);
 }
 
-float ServoMotor::applySafetyLimits(float angle) {
+float ServoMotor::applySafetyLimits(float angle) const {
     if (!safetyEnabled) {
         return angle;
     }
@@ -257,4 +602,125 @@ float ServoMotor::applySafetyLimits(float angle) {
     }
     
     return angle;
-}
\ No newline at end of file
+}
+
+/**
+ * Limiti di sicurezza su un angolo comandato, contando le saturazioni
+ * (monitorate da ServoHealth)
+ */
+float ServoMotor::limitCommand(float angle) {
+    float limited = applySafetyLimits(angle);
+    if (limited != angle) {
+        saturationCount++;
+    }
+    return limited;
+}
+
+/**
+ * Controlli comuni prima di accodare un waypoint
+ */
+bool ServoMotor::canTakeWaypoint() const {
+    if (jogging) {
+        Serial.printf("Ch%d: Jog attivo, waypoint scartato\n", channel);
+        return false;
+    }
+    
+    if (planner.isFull()) {
+        Serial.printf("Ch%d: Coda movimenti piena\n", channel);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Segmento attivo senza successori: ripianifica il resto per
+ * raccordarlo con il waypoint che sta per essere accodato
+ */
+void ServoMotor::resumeActive() {
+    if (moving && planner.isEmpty()) {
+        float t = moveTick * MOTION_PERIOD_S + profilePhase;
+        planner.resume(profile.travel(t), profile.speed(t));
+        if (!planner.isEmpty()) {
+            moving = false;  // Il prossimo tick parte dal resto ripianificato
+        }
+    }
+}
+
+/**
+ * Posizione del profilo al tick indicato del segmento attivo
+ * Unico punto da cambiare per profili di velocità diversi
+ */
+float ServoMotor::samplePosition(uint16_t tick) const {
+    return profile.position(tick * MOTION_PERIOD_S + profilePhase);
+}
+
+/**
+ * Attiva il profilo appena estratto dal planner
+ * (campioni 0..moveTicks, il campione 0 serve solo ai raccordi)
+ * @param phase Tempo del profilo già trascorso al tick 0 (s)
+ */
+void ServoMotor::beginSegment(float phase) {
+    moving = true;
+    segmentCount++;
+    moveTick = 0;
+    profilePhase = phase;
+    
+    float remaining = profile.duration - phase;
+    moveTicks = (remaining > 0.0f) ? (uint16_t)ceilf(remaining / MOTION_PERIOD_S) : 1;
+    if (moveTicks == 0) {
+        moveTicks = 1;
+    }
+}
+
+/**
+ * Emette il campione tick del segmento attivo e ne registra l'angolo
+ * Un buffer riempito all'attivazione non reggerebbe i raccordi: il
+ * lookahead ripianifica il segmento attivo quando arriva un waypoint
+ */
+void ServoMotor::emitSample(ServoOutput& pwm, uint16_t tick) {
+    float angle = samplePosition(tick);
+    emitPulse(pwm, angleToPulse(angle));
+    setPosition(angle);
+}
+
+void ServoMotor::setPosition(float angle) {
+    position = angle;
+    currentAngle = (int)(angle + 0.5f);
+}
+
+/**
+ * Velocità attuale con segno (gradi/s), coerente con l'ultimo campione
+ */
+float ServoMotor::currentVelocity() const {
+    if (jogging) {
+        return jogVelocity;
+    }
+    if (moving) {
+        return profile.velocity(moveTick * MOTION_PERIOD_S + profilePhase);
+    }
+    return 0.0f;
+}
+
+/**
+ * Passa al controllo in velocità (jog o arresto in rampa) partendo
+ * dalla posizione e velocità attuali; la coda viene svuotata
+ */
+void ServoMotor::beginRamp() {
+    jogVelocity = currentVelocity();
+    jogPosition = position;
+    jogKeepalive = millis();
+    moving = false;
+    jogging = true;
+    planner.reset(position);
+}
+
+/**
+ * Scrive sul PCA9685 solo se il pulse è cambiato (risparmia traffico I2C)
+ */
+void ServoMotor::emitPulse(ServoOutput& pwm, uint16_t pulse) {
+    if (pulse == lastPulse) {
+        return;
+    }
+    pwm.write(board, channel, pulse);
+    lastPulse = pulse;
+}
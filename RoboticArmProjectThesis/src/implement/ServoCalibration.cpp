@@ -0,0 +1,131 @@
+#include "include/ServoCalibration.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+ServoCalibration::ServoCalibration() {
+    setLinear(0, 180, 102, 512);
+}
+
+void ServoCalibration::setLinear(
+    int minAngle,
+    int maxAngle,
+    uint16_t minPulse,
+    uint16_t maxPulse
+) {
+    this->minAngle = minAngle;
+    this->maxAngle = (maxAngle > minAngle) ? maxAngle : minAngle + 1;
+    this->pointsPerDegree = (float)(CAL_POINTS - 1) / (this->maxAngle - this->minAngle);
+
+    for (int i = 0; i < CAL_POINTS; i++) {
+        long span = (long)maxPulse - minPulse;
+        pulse[i] = (uint16_t)(minPulse + (span * i) / (CAL_POINTS - 1));
+    }
+}
+
+// ============================================================================
+// CONVERSIONI
+// ============================================================================
+
+uint16_t ServoCalibration::angleToPulse(float angle) const {
+    float pos = (angle - minAngle) * pointsPerDegree;
+
+    if (pos <= 0.0f) {
+        return pulse[0];
+    }
+    if (pos >= CAL_POINTS - 1) {
+        return pulse[CAL_POINTS - 1];
+    }
+
+    int i = (int)pos;
+    float frac = pos - i;
+    float value = pulse[i] + ((int)pulse[i + 1] - (int)pulse[i]) * frac;
+
+    return (uint16_t)(value + 0.5f);
+}
+
+float ServoCalibration::pulseToAngle(uint16_t value) const {
+    bool increasing = pulse[CAL_POINTS - 1] >= pulse[0];
+
+    for (int i = 0; i < CAL_POINTS - 1; i++) {
+        int p0 = pulse[i];
+        int p1 = pulse[i + 1];
+        bool inside = increasing ? (value <= p1) : (value >= p1);
+
+        if (inside || i == CAL_POINTS - 2) {
+            float frac = (p1 != p0) ? (float)((int)value - p0) / (p1 - p0) : 0.0f;
+            if (frac < 0.0f) frac = 0.0f;
+            if (frac > 1.0f) frac = 1.0f;
+            return getPointAngle(i) + frac / pointsPerDegree;
+        }
+    }
+
+    return maxAngle;
+}
+
+// ============================================================================
+// PUNTI
+// ============================================================================
+
+float ServoCalibration::getPointAngle(int index) const {
+    return minAngle + index / pointsPerDegree;
+}
+
+uint16_t ServoCalibration::getPointPulse(int index) const {
+    if (index < 0 || index >= CAL_POINTS) {
+        return 0;
+    }
+    return pulse[index];
+}
+
+void ServoCalibration::setPointPulse(int index, uint16_t value) {
+    if (index < 0 || index >= CAL_POINTS) {
+        return;
+    }
+    pulse[index] = value;
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+int ServoCalibration::getMinAngle() const {
+    return minAngle;
+}
+
+int ServoCalibration::getMaxAngle() const {
+    return maxAngle;
+}
+
+bool ServoCalibration::isMonotonic() const {
+    bool increasing = pulse[CAL_POINTS - 1] > pulse[0];
+
+    for (int i = 0; i < CAL_POINTS - 1; i++) {
+        if (increasing && pulse[i + 1] <= pulse[i]) return false;
+        if (!increasing && pulse[i + 1] >= pulse[i]) return false;
+    }
+    return true;
+}
+
+uint16_t ServoCalibration::checksum() const {
+    // Fletcher-16 su range e punti
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    uint16_t words[CAL_POINTS + 2];
+
+    words[0] = (uint16_t)minAngle;
+    words[1] = (uint16_t)maxAngle;
+    for (int i = 0; i < CAL_POINTS; i++) {
+        words[i + 2] = pulse[i];
+    }
+
+    for (int i = 0; i < CAL_POINTS + 2; i++) {
+        sum1 = (sum1 + (words[i] & 0xFF)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+        sum1 = (sum1 + (words[i] >> 8)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return (sum2 << 8) | sum1;
+}
@@ -0,0 +1,246 @@
+#include "include/ServoHealth.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+ServoHealth::ServoHealth() {
+    this->fault.type = FAULT_NONE;
+    this->fault.joint = -1;
+    this->fault.value = 0.0f;
+    this->fault.time = 0;
+    this->faultCount = 0;
+    this->ticks = 0;
+
+    this->lastPipelineErrors = 0;
+    this->i2cErrors = 0;
+    this->i2cFailedTicks = 0;
+    this->windowTick = 0;
+    this->feedbackJoint = 0;
+
+    for (int joint = 0; joint < MAX_JOINTS; joint++) {
+        this->lastSegment[joint] = 0;
+        this->segmentStart[joint] = 0;
+        this->segmentTicks[joint] = 0;
+        this->lateSegments[joint] = 0;
+        this->overruns[joint] = 0;
+        this->windowSaturations[joint] = 0;
+        this->saturations[joint] = 0;
+        this->feedbackPin[joint] = -1;
+        this->feedbackScale[joint] = 0.0f;
+        this->feedbackOffset[joint] = 0.0f;
+        this->feedbackMisses[joint] = 0;
+        this->feedbackErrors[joint] = 0;
+    }
+}
+
+void ServoHealth::setFeedback(int joint, int pin, float scale, float offset) {
+    if (joint < 0 || joint >= MAX_JOINTS) {
+        return;
+    }
+    feedbackPin[joint] = pin;
+    feedbackScale[joint] = scale;
+    feedbackOffset[joint] = offset;
+    feedbackMisses[joint] = 0;
+}
+
+// ============================================================================
+// MONITORAGGIO
+// ============================================================================
+
+void ServoHealth::update(const JointTable& joints, const PwmPipeline& pipeline, unsigned long now) {
+    ticks++;
+
+    checkI2c(pipeline, now);
+
+    for (int joint = 0; joint < joints.getCount(); joint++) {
+        checkSegment(joint, joints.get(joint), now);
+    }
+
+    if (++windowTick >= HEALTH_WINDOW_TICKS) {
+        windowTick = 0;
+        checkSaturations(joints, now);
+    }
+
+    checkFeedback(joints, now);
+}
+
+void ServoHealth::checkI2c(const PwmPipeline& pipeline, unsigned long now) {
+    unsigned long errors = pipeline.getErrors();
+
+    // Bus in recupero: nessuna trasmissione, ma il tick conta come fallito
+    if (errors == lastPipelineErrors && pipeline.getLink().isReady()) {
+        i2cFailedTicks = 0;
+        return;
+    }
+
+    i2cErrors += errors - lastPipelineErrors;
+    lastPipelineErrors = errors;
+
+    if (++i2cFailedTicks >= HEALTH_I2C_FAULT_TICKS) {
+        raise(FAULT_I2C, -1, pipeline.getLastError(), now);
+    }
+}
+
+/**
+ * Segue il segmento attivo: alla fine confronta la durata reale con
+ * quella pianificata
+ */
+void ServoHealth::checkSegment(int joint, const ServoMotor* servo, unsigned long now) {
+    unsigned long segment = servo->getSegmentCount();
+    uint16_t planned = servo->getSegmentTicks();
+
+    if (segment != lastSegment[joint]) {
+        // Segmento precedente concluso (o sostituito dal nuovo)
+        closeSegment(joint, now);
+        lastSegment[joint] = segment;
+        segmentStart[joint] = now;
+        segmentTicks[joint] = planned;
+    }
+    else if (planned == 0 && segmentTicks[joint] != 0) {
+        closeSegment(joint, now);
+    }
+}
+
+void ServoHealth::closeSegment(int joint, unsigned long now) {
+    if (segmentTicks[joint] == 0) {
+        return;
+    }
+
+    unsigned long planned = (unsigned long)segmentTicks[joint] * MOTION_PERIOD_MS;
+    unsigned long elapsed = now - segmentStart[joint];
+    segmentTicks[joint] = 0;
+
+    if (elapsed <= planned * HEALTH_OVERRUN_RATIO + HEALTH_OVERRUN_SLACK_MS) {
+        lateSegments[joint] = 0;
+        return;
+    }
+
+    overruns[joint]++;
+    if (++lateSegments[joint] >= HEALTH_OVERRUN_FAULTS) {
+        raise(FAULT_MOVE_OVERRUN, joint, elapsed - planned, now);
+    }
+}
+
+void ServoHealth::checkSaturations(const JointTable& joints, unsigned long now) {
+    for (int joint = 0; joint < joints.getCount(); joint++) {
+        unsigned long count = joints.get(joint)->getSaturationCount();
+        unsigned long window = count - windowSaturations[joint];
+        windowSaturations[joint] = count;
+        saturations[joint] += window;
+
+        if (window >= HEALTH_SATURATION_LIMIT) {
+            raise(FAULT_SATURATION, joint, window, now);
+        }
+    }
+}
+
+/**
+ * Una lettura analogica per tick, a rotazione sui giunti con feedback
+ */
+void ServoHealth::checkFeedback(const JointTable& joints, unsigned long now) {
+    int count = joints.getCount();
+    if (count == 0) {
+        return;
+    }
+
+    int joint = feedbackJoint;
+    feedbackJoint = (feedbackJoint + 1) % count;
+
+    // Solo a giunto fermo: in movimento il servo insegue il comando
+    if (feedbackPin[joint] < 0 || (joints.getMovingMask() & (1 << joint))) {
+        return;
+    }
+
+    float measured = feedbackOffset[joint] + analogRead(feedbackPin[joint]) * feedbackScale[joint];
+    float error = fabsf(measured - joints.getPosition(joint));
+
+    if (error <= HEALTH_FEEDBACK_TOLERANCE) {
+        feedbackMisses[joint] = 0;
+        return;
+    }
+
+    feedbackErrors[joint]++;
+    if (++feedbackMisses[joint] >= HEALTH_FEEDBACK_FAULTS) {
+        raise(FAULT_FEEDBACK, joint, error, now);
+    }
+}
+
+void ServoHealth::raise(int type, int joint, float value, unsigned long now) {
+    if (fault.type != FAULT_NONE) {
+        return;  // Resta il primo guasto finché non viene gestito
+    }
+
+    fault.type = type;
+    fault.joint = joint;
+    fault.value = value;
+    fault.time = now;
+    faultCount++;
+}
+
+// ============================================================================
+// GUASTI
+// ============================================================================
+
+bool ServoHealth::hasFault() const {
+    return fault.type != FAULT_NONE;
+}
+
+const ServoFault& ServoHealth::getFault() const {
+    return fault;
+}
+
+void ServoHealth::clearFault() {
+    fault.type = FAULT_NONE;
+    fault.joint = -1;
+    fault.value = 0.0f;
+
+    i2cFailedTicks = 0;
+    for (int joint = 0; joint < MAX_JOINTS; joint++) {
+        lateSegments[joint] = 0;
+        feedbackMisses[joint] = 0;
+    }
+}
+
+const char* ServoHealth::faultName(int type) {
+    switch (type) {
+    case FAULT_I2C:
+        return "I2C";
+    case FAULT_MOVE_OVERRUN:
+        return "MOVE_OVERRUN";
+    case FAULT_SATURATION:
+        return "SATURATION";
+    case FAULT_FEEDBACK:
+        return "FEEDBACK";
+    default:
+        return "NONE";
+    }
+}
+
+// ============================================================================
+// CONTATORI
+// ============================================================================
+
+unsigned long ServoHealth::getI2cErrors() const {
+    return i2cErrors;
+}
+
+unsigned long ServoHealth::getOverruns(int joint) const {
+    return overruns[joint];
+}
+
+unsigned long ServoHealth::getSaturations(int joint) const {
+    return saturations[joint];
+}
+
+unsigned long ServoHealth::getFeedbackErrors(int joint) const {
+    return feedbackErrors[joint];
+}
+
+unsigned long ServoHealth::getFaultCount() const {
+    return faultCount;
+}
+
+unsigned long ServoHealth::getTicks() const {
+    return ticks;
+}
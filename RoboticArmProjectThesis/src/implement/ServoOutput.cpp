@@ -0,0 +1,231 @@
+#include "include/ServoOutput.h"
+
+// ============================================================================
+// COSTRUTTORE
+// ============================================================================
+
+ServoOutput::ServoOutput() {
+    for (int board = 0; board < MAX_BOARDS; board++) {
+        this->boards[board].address = 0;
+        this->boards[board].online = false;
+        this->boards[board].frequency = SERVO_NOMINAL_FREQUENCY;
+        this->boards[board].scale = 1UL << 16;
+        for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+            this->boards[board].pulses[channel] = 0;
+        }
+    }
+    this->boardCount = 0;
+    this->lastFlushBytes = 0;
+    this->reportedErrors = 0;
+}
+
+int ServoOutput::addBoard(uint8_t address, float frequency) {
+    if (boardCount >= MAX_BOARDS) {
+        Serial.printf("PCA9685 0x%02X: registro schede pieno\n", address);
+        return -1;
+    }
+
+    Board& b = boards[boardCount];
+    b.address = address;
+
+    // Scheda assente: resta registrata, gli errori di trasmissione
+    // arrivano a ServoHealth invece di fermare l'avvio
+    uint8_t error = pipeline.probe(address);
+    b.online = (error == I2C_OK);
+    if (!b.online) {
+        Serial.printf("PCA9685 0x%02X: non risponde (errore %d)\n", address, error);
+    }
+
+    b.driver = Adafruit_PWMServoDriver(address);
+    b.driver.begin();
+
+    int board = boardCount++;
+    setFrequency(board, frequency);
+
+    Serial.printf("PCA9685 0x%02X: scheda %d, %.1fHz\n", address, board, b.frequency);
+    return board;
+}
+
+bool ServoOutput::setFrequency(int board, float frequency) {
+    if (board < 0 || board >= boardCount) {
+        return false;
+    }
+    if (pipeline.isRunning()) {
+        Serial.printf("PWM %d: frequenza modificabile solo all'avvio\n", board);
+        return false;
+    }
+
+    Board& b = boards[board];
+    b.driver.setPWMFreq(frequency);  // Lascia attivo l'auto-increment (MODE1_AI)
+    b.frequency = actualFrequency(frequency);
+    b.scale = (uint32_t)(b.frequency / actualFrequency(SERVO_NOMINAL_FREQUENCY) * 65536.0f + 0.5f);
+
+    // Impulsi attivi con la nuova scala
+    for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+        if (b.pulses[ch] != 0) {
+            write(board, ch, b.pulses[ch]);
+        }
+    }
+    return true;
+}
+
+float ServoOutput::getFrequency(int board) const {
+    return boards[board].frequency;
+}
+
+unsigned long ServoOutput::getPeriodMicros(int board) const {
+    return (unsigned long)(1000000.0f / boards[board].frequency + 0.5f);
+}
+
+/**
+ * Stesso arrotondamento del prescaler di setPWMFreq()
+ */
+float ServoOutput::actualFrequency(float frequency) {
+    float prescale = PCA9685_OSCILLATOR_HZ / (frequency * PWM_PERIOD_COUNTS) + 0.5f - 1.0f;
+    int value = constrain((int)prescale, 3, 255);
+    return PCA9685_OSCILLATOR_HZ / (PWM_PERIOD_COUNTS * (value + 1));
+}
+
+bool ServoOutput::startPipeline() {
+    return pipeline.begin();
+}
+
+// ============================================================================
+// CANALI
+// ============================================================================
+
+void ServoOutput::addChannel(int board, int channel) {
+    if (!isValid(board, channel) || !boards[board].phases.add(channel)) {
+        return;
+    }
+
+    // Offset ridistribuiti: le uscite attive seguono subito il nuovo slot
+    Board& b = boards[board];
+    for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+        if (b.pulses[ch] != 0) {
+            write(board, ch, b.pulses[ch]);
+        }
+    }
+
+    Serial.printf("PWM %d/Ch%d: ON=%d (%d canali sfasati)\n",
+                  board, channel, b.phases.getOffset(channel), b.phases.getCount());
+}
+
+void ServoOutput::write(int board, int channel, uint16_t pulse) {
+    if (!isValid(board, channel)) {
+        return;
+    }
+
+    Board& b = boards[board];
+
+    // Conteggi nominali → conteggi alla frequenza della scheda
+    uint32_t counts = ((uint32_t)pulse * b.scale + 0x8000) >> 16;
+    if (counts >= PWM_PERIOD_COUNTS) {
+        counts = PWM_PERIOD_COUNTS - 1;
+    }
+
+    uint16_t on, off;
+    b.phases.window(channel, counts, on, off);
+    b.frame.set(channel, on, off);
+    b.pulses[channel] = pulse;
+}
+
+// ============================================================================
+// INVIO
+// ============================================================================
+
+int ServoOutput::flush() {
+    reportErrors();
+
+    PwmBatch* batch = pipeline.acquire();
+    if (batch == nullptr) {
+        // Entrambi i buffer sul bus o in coda: i frame restano dirty
+        return 0;
+    }
+
+    // Batch ripreso prima dell'invio e transazioni fallite: i loro
+    // canali tornano da inviare
+    for (int board = 0; board < boardCount; board++) {
+        boards[board].frame.markDirty(batch->dirty[board] | pipeline.takeFailed(board));
+        batch->dirty[board] = 0;
+    }
+    batch->clear();
+
+    PwmRun runs[PWM_FRAME_MAX_RUNS];
+    uint8_t buffer[PWM_FRAME_MAX_BYTES];
+    int bytes = 0;
+
+    for (int board = 0; board < boardCount; board++) {
+        Board& b = boards[board];
+        if (!b.frame.isDirty()) {
+            continue;
+        }
+
+        int count = b.frame.plan(runs);
+        for (int i = 0; i < count; i++) {
+            int length = b.frame.encode(runs[i], buffer);
+            uint16_t mask = (uint16_t)(((1UL << (runs[i].last + 1)) - 1) & ~((1UL << runs[i].first) - 1));
+            batch->add(board, b.address, mask, buffer, length);
+        }
+
+        bytes += PwmFrame::busBytes(runs, count);
+        batch->dirty[board] = b.frame.getDirtyMask();
+        b.frame.clearDirty();
+    }
+
+    pipeline.submit(batch);
+
+    lastFlushBytes = bytes;
+    return bytes;
+}
+
+/**
+ * Segnala gli errori di trasmissione comparsi dall'ultimo flush
+ */
+void ServoOutput::reportErrors() {
+    unsigned long errors = pipeline.getErrors();
+    if (errors == reportedErrors) {
+        return;
+    }
+
+    Serial.printf("I2C: %lu transazioni fallite (ultimo errore %d su 0x%02X)\n",
+                  errors - reportedErrors, pipeline.getLastError(),
+                  pipeline.getLastErrorAddress());
+    reportedErrors = errors;
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+int ServoOutput::getBoardCount() const {
+    return boardCount;
+}
+
+bool ServoOutput::isOnline(int board) const {
+    return board >= 0 && board < boardCount && boards[board].online;
+}
+
+uint8_t ServoOutput::getAddress(int board) const {
+    return boards[board].address;
+}
+
+uint16_t ServoOutput::getOnTime(int board, int channel) const {
+    return isValid(board, channel) ? boards[board].phases.getOffset(channel) : 0;
+}
+
+const PwmPhaseTable& ServoOutput::getPhases(int board) const {
+    return boards[board].phases;
+}
+
+int ServoOutput::getLastFlushBytes() const {
+    return lastFlushBytes;
+}
+
+const PwmPipeline& ServoOutput::getPipeline() const {
+    return pipeline;
+}
+
+bool ServoOutput::isValid(int board, int channel) const {
+    return board >= 0 && board < boardCount && channel >= 0 && channel < PWM_CHANNELS;
+}
@@ -0,0 +1,200 @@
+#include "include/TeachStore.h"
+
+// ============================================================================
+// COSTRUTTORE E AVVIO
+// ============================================================================
+
+TeachStore::TeachStore() : ring(storage, TEACH_RING_BYTES) {
+    this->path[0] = '\0';
+    this->fileOpen = false;
+    this->ready = false;
+    this->task = nullptr;
+    this->mode = STORE_IDLE;
+    this->cancelled = false;
+    this->saved = 0;
+    this->fileBytes = 0;
+    this->lastError = nullptr;
+}
+
+bool TeachStore::begin() {
+    if (ready) {
+        return true;
+    }
+
+    if (!LittleFS.begin(true)) {
+        Serial.println("Teach: LittleFS non disponibile");
+        return false;
+    }
+    if (!LittleFS.exists(TEACH_DIRECTORY)) {
+        LittleFS.mkdir(TEACH_DIRECTORY);
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "teach_fs", TEACH_STORE_STACK,
+                                                this, TEACH_STORE_PRIORITY, &task,
+                                                TEACH_STORE_CORE);
+    ready = (result == pdPASS);
+
+    if (!ready) {
+        Serial.println("Teach: task non avviato");
+    }
+    return ready;
+}
+
+bool TeachStore::isReady() const {
+    return ready;
+}
+
+// ============================================================================
+// LATO MOTION TASK
+// ============================================================================
+
+bool TeachStore::record(const char* name) {
+    return start(name, STORE_RECORDING);
+}
+
+bool TeachStore::play(const char* name) {
+    return start(name, STORE_PLAYING);
+}
+
+bool TeachStore::start(const char* name, uint8_t newMode) {
+    if (!ready || mode != STORE_IDLE) {
+        return false;
+    }
+
+    size_t length = strlen(name);
+    if (length == 0 || length > TEACH_NAME_LENGTH || strchr(name, '/') != nullptr) {
+        return false;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.tch", TEACH_DIRECTORY, name);
+    ring.reset();
+    cancelled = false;
+    lastError = nullptr;
+    fileBytes = 0;
+
+    // Pubblicato per ultimo: da qui file e ring sono del task
+    mode = newMode;
+    return true;
+}
+
+void TeachStore::cancel() {
+    if (mode != STORE_IDLE) {
+        cancelled = true;
+    }
+}
+
+int TeachStore::getMode() const {
+    return mode;
+}
+
+TrajectoryRing& TeachStore::getRing() {
+    return ring;
+}
+
+unsigned long TeachStore::getSaved() const {
+    return saved;
+}
+
+unsigned long TeachStore::getFileBytes() const {
+    return fileBytes;
+}
+
+const char* TeachStore::getLastError() const {
+    return lastError;
+}
+
+// ============================================================================
+// TASK DELLA FLASH
+// ============================================================================
+
+void TeachStore::taskEntry(void* param) {
+    static_cast<TeachStore*>(param)->run();
+}
+
+void TeachStore::run() {
+    for (;;) {
+        if (mode == STORE_RECORDING) {
+            drainToFile();
+        }
+        else if (mode == STORE_PLAYING) {
+            fillFromFile();
+        }
+        vTaskDelay(pdMS_TO_TICKS(TEACH_STORE_PERIOD_MS));
+    }
+}
+
+/**
+ * Registrazione: scarica il ring; a ring chiuso e vuoto chiude il file
+ */
+void TeachStore::drainToFile() {
+    if (!fileOpen) {
+        file = LittleFS.open(path, FILE_WRITE);
+        if (!file) {
+            finish("file non creato");
+            return;
+        }
+        fileOpen = true;
+    }
+
+    // isClosed() prima della lettura: chiuso dopo gli ultimi byte
+    bool closed = ring.isClosed() || cancelled;
+    uint8_t chunk[TEACH_CHUNK_BYTES];
+    int count;
+    while ((count = ring.read(chunk, sizeof(chunk))) > 0) {
+        if (file.write(chunk, count) != (size_t)count) {
+            finish("flash piena");
+            return;
+        }
+        fileBytes += count;
+    }
+
+    if (closed) {
+        saved++;
+        finish(nullptr);
+    }
+}
+
+/**
+ * Riproduzione: riempie il ring a blocchi; a fine file lo chiude
+ */
+void TeachStore::fillFromFile() {
+    if (cancelled) {
+        finish(nullptr);
+        return;
+    }
+
+    if (!fileOpen) {
+        file = LittleFS.open(path, FILE_READ);
+        if (!file) {
+            finish("registrazione non trovata");
+            return;
+        }
+        fileOpen = true;
+    }
+
+    uint8_t chunk[TEACH_CHUNK_BYTES];
+    while (ring.space() >= TEACH_CHUNK_BYTES) {
+        int count = file.read(chunk, sizeof(chunk));
+        if (count <= 0) {
+            finish(nullptr);
+            return;
+        }
+        ring.write(chunk, count);
+        fileBytes += count;
+    }
+}
+
+void TeachStore::finish(const char* error) {
+    if (fileOpen) {
+        file.close();
+        fileOpen = false;
+    }
+
+    // In riproduzione il task è il produttore: niente altri byte
+    if (mode == STORE_PLAYING) {
+        ring.close();
+    }
+
+    lastError = error;
+    mode = STORE_IDLE;
+}
@@ -0,0 +1,425 @@
+#include "include/TrajectoryCodec.h"
+#include <string.h>
+
+static const uint8_t TRAJ_MAGIC[3] = {'T', 'C', 'H'};
+
+static int writeVarint(uint8_t* data, uint32_t value) {
+    int length = 0;
+    while (value >= 0x80) {
+        data[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[length++] = (uint8_t)value;
+    return length;
+}
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// ============================================================================
+// BUFFER CIRCOLARE
+// ============================================================================
+
+TrajectoryRing::TrajectoryRing(uint8_t* buffer, int capacity) {
+    this->buffer = buffer;
+    this->capacity = capacity;
+    reset();
+}
+
+void TrajectoryRing::reset() {
+    head = 0;
+    tail = 0;
+    closed = false;
+}
+
+int TrajectoryRing::available() const {
+    int count = head - tail;
+    return count < 0 ? count + capacity : count;
+}
+
+int TrajectoryRing::space() const {
+    // Un byte resta libero per distinguere pieno da vuoto
+    return capacity - 1 - available();
+}
+
+bool TrajectoryRing::write(const uint8_t* data, int length) {
+    if (closed || length > space()) {
+        return false;
+    }
+
+    int position = head;
+    for (int i = 0; i < length; i++) {
+        buffer[position] = data[i];
+        position = (position + 1 == capacity) ? 0 : position + 1;
+    }
+    head = position;   // Pubblicato dopo i dati
+    return true;
+}
+
+int TrajectoryRing::read(uint8_t* data, int length) {
+    int count = available();
+    if (count > length) {
+        count = length;
+    }
+
+    int position = tail;
+    for (int i = 0; i < count; i++) {
+        data[i] = buffer[position];
+        position = (position + 1 == capacity) ? 0 : position + 1;
+    }
+    tail = position;
+    return count;
+}
+
+void TrajectoryRing::close() {
+    closed = true;
+}
+
+bool TrajectoryRing::isClosed() const {
+    return closed;
+}
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+
+TrajectoryEncoder::TrajectoryEncoder() {
+    this->sink = nullptr;
+    this->jointCount = 0;
+    this->hasDelta = false;
+    this->repeats = 0;
+    this->samples = 0;
+    this->bytes = 0;
+}
+
+bool TrajectoryEncoder::begin(TrajectorySink* sink, const TrajectoryHeader& header) {
+    if (sink == nullptr || header.jointCount == 0 || header.jointCount > TRAJ_MAX_JOINTS) {
+        return false;
+    }
+
+    this->sink = sink;
+    jointCount = header.jointCount;
+    hasDelta = false;
+    repeats = 0;
+    samples = 0;
+    bytes = 0;
+
+    uint8_t data[TRAJ_HEADER_BYTES] = {
+        TRAJ_MAGIC[0], TRAJ_MAGIC[1], TRAJ_MAGIC[2], TRAJ_VERSION,
+        header.jointCount, header.periodMs, header.unitsPerDeg, 0
+    };
+    return emit(data, TRAJ_HEADER_BYTES);
+}
+
+bool TrajectoryEncoder::add(const int16_t sample[]) {
+    uint8_t record[TRAJ_MAX_RECORD_BYTES];
+    int length = 0;
+
+    if (samples == 0) {
+        // Primo campione assoluto
+        record[length++] = TRAJ_TAG_KEY;
+        for (int joint = 0; joint < jointCount; joint++) {
+            record[length++] = (uint8_t)(sample[joint] & 0xFF);
+            record[length++] = (uint8_t)((uint16_t)sample[joint] >> 8);
+        }
+    }
+    else {
+        int32_t next[TRAJ_MAX_JOINTS];
+        uint32_t mask = 0;
+        bool same = hasDelta;
+        for (int joint = 0; joint < jointCount; joint++) {
+            next[joint] = (int32_t)sample[joint] - previous[joint];
+            if (next[joint] != 0) {
+                mask |= 1u << joint;
+            }
+            if (next[joint] != delta[joint]) {
+                same = false;
+            }
+        }
+
+        // Stessa variazione del campione precedente: solo un contatore
+        if (same) {
+            repeats++;
+            if (repeats == TRAJ_MAX_REPEAT && !flushRepeats()) {
+                return false;
+            }
+            memcpy(previous, sample, jointCount * sizeof(int16_t));
+            samples++;
+            return true;
+        }
+
+        if (!flushRepeats()) {
+            return false;
+        }
+
+        record[length++] = TRAJ_TAG_DELTA;
+        length += writeVarint(record + length, mask);
+        for (int joint = 0; joint < jointCount; joint++) {
+            if (mask & (1u << joint)) {
+                length += writeVarint(record + length, zigzag(next[joint]));
+            }
+            delta[joint] = next[joint];
+        }
+        hasDelta = true;
+    }
+
+    if (!emit(record, length)) {
+        return false;
+    }
+    memcpy(previous, sample, jointCount * sizeof(int16_t));
+    samples++;
+    return true;
+}
+
+bool TrajectoryEncoder::finish() {
+    if (sink == nullptr || !flushRepeats()) {
+        return false;
+    }
+    uint8_t end = TRAJ_TAG_END;
+    return emit(&end, 1);
+}
+
+bool TrajectoryEncoder::flushRepeats() {
+    if (repeats == 0) {
+        return true;
+    }
+    uint8_t tag = (uint8_t)(repeats - 1);
+    if (!emit(&tag, 1)) {
+        return false;
+    }
+    repeats = 0;
+    return true;
+}
+
+bool TrajectoryEncoder::emit(const uint8_t* data, int length) {
+    if (!sink->write(data, length)) {
+        return false;
+    }
+    bytes += length;
+    return true;
+}
+
+unsigned long TrajectoryEncoder::getSamples() const {
+    return samples;
+}
+
+unsigned long TrajectoryEncoder::getBytes() const {
+    return bytes;
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+TrajectoryDecoder::TrajectoryDecoder() {
+    reset(nullptr);
+}
+
+void TrajectoryDecoder::reset(TrajectorySource* source) {
+    this->source = source;
+    header.jointCount = 0;
+    header.periodMs = 0;
+    header.unitsPerDeg = 0;
+    headerRead = false;
+    status = (source != nullptr) ? TRAJ_SAMPLE : TRAJ_ERROR;
+    truncated = false;
+    started = false;
+    repeats = 0;
+    samples = 0;
+    length = 0;
+}
+
+int TrajectoryDecoder::next(int16_t sample[]) {
+    while (status == TRAJ_SAMPLE) {
+        if (repeats > 0) {
+            for (int joint = 0; joint < header.jointCount; joint++) {
+                current[joint] = (int16_t)(current[joint] + delta[joint]);
+                sample[joint] = current[joint];
+            }
+            repeats--;
+            samples++;
+            return TRAJ_SAMPLE;
+        }
+
+        // isClosed() prima della lettura: chiuso dopo gli ultimi byte
+        bool closed = source->isClosed();
+        fill();
+
+        int result = headerRead ? parseRecord() : parseHeader();
+        if (result == TRAJ_WAIT) {
+            if (!closed) {
+                return TRAJ_WAIT;
+            }
+            // Nessun END: registrazione interrotta, valida fin qui
+            truncated = true;
+            status = headerRead ? TRAJ_END : TRAJ_ERROR;
+        }
+        else if (result != TRAJ_SAMPLE) {
+            status = result;
+        }
+    }
+    return status;
+}
+
+void TrajectoryDecoder::fill() {
+    if (length < TRAJ_DECODE_BUFFER) {
+        length += source->read(buffer + length, TRAJ_DECODE_BUFFER - length);
+    }
+}
+
+void TrajectoryDecoder::consume(int count) {
+    length -= count;
+    memmove(buffer, buffer + count, length);
+}
+
+int TrajectoryDecoder::parseHeader() {
+    if (length < TRAJ_HEADER_BYTES) {
+        return TRAJ_WAIT;
+    }
+    if (memcmp(buffer, TRAJ_MAGIC, sizeof(TRAJ_MAGIC)) != 0 || buffer[3] != TRAJ_VERSION ||
+        buffer[4] == 0 || buffer[4] > TRAJ_MAX_JOINTS || buffer[5] == 0 ||
+        buffer[6] != TRAJ_UNITS_PER_DEG) {
+        return TRAJ_ERROR;
+    }
+
+    header.jointCount = buffer[4];
+    header.periodMs = buffer[5];
+    header.unitsPerDeg = buffer[6];
+    headerRead = true;
+    consume(TRAJ_HEADER_BYTES);
+    return TRAJ_SAMPLE;
+}
+
+/**
+ * Un record: prepara i campioni da generare (repeats)
+ * @return TRAJ_SAMPLE se consumato, TRAJ_WAIT se incompleto
+ */
+int TrajectoryDecoder::parseRecord() {
+    if (length == 0) {
+        return TRAJ_WAIT;
+    }
+
+    uint8_t tag = buffer[0];
+    int joints = header.jointCount;
+
+    if (tag <= TRAJ_TAG_REPEAT_MAX) {
+        if (!started) {
+            return TRAJ_ERROR;
+        }
+        repeats = tag + 1;
+        consume(1);
+        return TRAJ_SAMPLE;
+    }
+
+    if (tag == TRAJ_TAG_END) {
+        consume(1);
+        return TRAJ_END;
+    }
+
+    if (tag == TRAJ_TAG_KEY) {
+        int size = 1 + 2 * joints;
+        if (length < size) {
+            return TRAJ_WAIT;
+        }
+        for (int joint = 0; joint < joints; joint++) {
+            current[joint] = (int16_t)(buffer[1 + 2 * joint] | (buffer[2 + 2 * joint] << 8));
+            delta[joint] = 0;
+        }
+        started = true;
+        repeats = 1;
+        consume(size);
+        return TRAJ_SAMPLE;
+    }
+
+    if (tag != TRAJ_TAG_DELTA || !started) {
+        return TRAJ_ERROR;
+    }
+
+    // Record completo prima di toccare lo stato
+    int32_t next[TRAJ_MAX_JOINTS];
+    uint32_t mask;
+    int position = 1;
+    int used = readVarint(buffer + position, length - position, mask);
+    if (used <= 0) {
+        return used == 0 ? TRAJ_WAIT : TRAJ_ERROR;
+    }
+    if (mask >> joints) {
+        return TRAJ_ERROR;
+    }
+    position += used;
+
+    for (int joint = 0; joint < joints; joint++) {
+        next[joint] = 0;
+        if (mask & (1u << joint)) {
+            uint32_t value;
+            used = readVarint(buffer + position, length - position, value);
+            if (used <= 0) {
+                return used == 0 ? TRAJ_WAIT : TRAJ_ERROR;
+            }
+            next[joint] = unzigzag(value);
+            position += used;
+        }
+    }
+
+    memcpy(delta, next, joints * sizeof(int32_t));
+    repeats = 1;
+    consume(position);
+    return TRAJ_SAMPLE;
+}
+
+/**
+ * @return Byte usati, 0 se incompleto, -1 se troppo lungo
+ */
+int TrajectoryDecoder::readVarint(const uint8_t* data, int length, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 5; i++) {
+        if (i >= length) {
+            return 0;
+        }
+        value |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+bool TrajectoryDecoder::hasHeader() const {
+    return headerRead;
+}
+
+const TrajectoryHeader& TrajectoryDecoder::getHeader() const {
+    return header;
+}
+
+bool TrajectoryDecoder::isTruncated() const {
+    return truncated;
+}
+
+unsigned long TrajectoryDecoder::getSamples() const {
+    return samples;
+}
+
+// ============================================================================
+// CONVERSIONI
+// ============================================================================
+
+int16_t TrajectoryDecoder::quantize(float degrees) {
+    float units = degrees * TRAJ_UNITS_PER_DEG;
+    if (units > 32767.0f) {
+        return 32767;
+    }
+    if (units < -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)(units + (units >= 0.0f ? 0.5f : -0.5f));
+}
+
+float TrajectoryDecoder::toDegrees(int16_t units) {
+    return (float)units / TRAJ_UNITS_PER_DEG;
+}
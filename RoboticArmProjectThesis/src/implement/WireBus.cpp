@@ -0,0 +1,47 @@
+#include "include/WireBus.h"
+
+WireBus::WireBus(int sdaPin, int sclPin, uint32_t clock) {
+    this->sdaPin = sdaPin;
+    this->sclPin = sclPin;
+    this->clock = clock;
+}
+
+uint8_t WireBus::transmit(uint8_t address, const uint8_t* data, int length) {
+    Wire.beginTransmission(address);
+    if (length > 0) {
+        Wire.write(data, length);
+    }
+    return Wire.endTransmission();
+}
+
+bool WireBus::isSdaLow() {
+    return digitalRead(sdaPin) == LOW;
+}
+
+void WireBus::releasePins() {
+    Wire.end();
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sclPin, HIGH);
+}
+
+void WireBus::clockPulse() {
+    digitalWrite(sclPin, LOW);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+}
+
+void WireBus::reattach() {
+    // STOP: SDA sale mentre SCL è alta
+    pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sdaPin, LOW);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    digitalWrite(sdaPin, HIGH);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+
+    Wire.begin(sdaPin, sclPin);
+    Wire.setClock(clock);
+}
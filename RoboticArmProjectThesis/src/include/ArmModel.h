@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * ARM MODEL - GEOMETRIA E INGOMBRI DEL BRACCIO
+ *
+ * Unica fonte delle misure del prototipo: la usano la cinematica del
+ * firmware e il generatore della griglia di collisione
+ * (tools/genCollisionGrid.cpp). Dopo una modifica va rigenerata
+ * src/implement/CollisionGrid.cpp, altrimenti all'avvio la griglia
+ * viene segnalata come non aggiornata.
+ * Non dipende da Arduino.
+ ******************************************************************************/
+
+#ifndef __ARM_MODEL__
+#define __ARM_MODEL__
+
+#include "Kinematics.h"
+
+// Geometria per la cinematica (mm, angoli servo con il braccio lungo
+// +X, primo link orizzontale, secondo link allineato al primo).
+// Valori misurati sul prototipo: ricontrollare dopo modifiche meccaniche
+static const ArmGeometry ARM_GEOMETRY = {
+    // altezza  braccio  avambraccio  base   gomito  polso  versi
+    95.0f,      105.0f,  150.0f,      135.0f, 45.0f, 90.0f, 1, 1, -1
+};
+
+// Ingombri per il controllo di collisione (mm, gradi)
+#define ARM_TABLE_CLEARANCE_MM 10.0f   // Quota minima di polso e pinza sul piano
+#define ARM_BASE_RADIUS_MM 45.0f       // Corpo della base (cilindro attorno all'asse)
+#define ARM_BASE_TOP_MM 75.0f          // Altezza del corpo della base
+#define ARM_LINK_RADIUS_MM 15.0f       // Mezzo spessore di link e pinza
+#define ARM_MIN_FOLD_DEG 30.0f         // Angolo minimo tra i due link
+
+// Campo dei servo coperto dalla griglia (gradi servo)
+#define ARM_ELBOW_RANGE 270
+#define ARM_WRIST_RANGE 180
+
+#endif
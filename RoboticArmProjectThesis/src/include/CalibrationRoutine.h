@@ -0,0 +1,115 @@
+/*******************************************************************************
+ * CALIBRATION ROUTINE - PROCEDURA GUIDATA NON-BLOCCANTE
+ *
+ * Visita uno alla volta i punti della curva che cadono nel range sicuro.
+ * Per ogni punto porta il servo al pulse nominale, attende l'assestamento e:
+ *  - modalità guidata: l'operatore corregge con nudge() e conferma
+ *  - modalità automatica: un probe misura l'angolo reale e la routine
+ *    corregge il pulse finché l'errore rientra nella tolleranza
+ * Non scrive sul PCA9685: il chiamante emette getPulse() quando update()
+ * ritorna true. Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __CALIBRATION_ROUTINE__
+#define __CALIBRATION_ROUTINE__
+
+#include "ServoCalibration.h"
+
+#define CAL_SETTLE_MS 400       // Attesa assestamento dopo ogni cambio pulse
+#define CAL_TOLERANCE_DEG 0.3f  // Errore ammesso in modalità automatica
+#define CAL_MAX_ITERATIONS 8    // Correzioni massime per punto
+
+/**
+ * Misura l'angolo reale del servo (feedback analogico o servo simulato)
+ * @param context Puntatore utente passato a setProbe()
+ * @param pulse   Pulse attualmente applicato
+ * @return Angolo misurato in gradi
+ */
+typedef float (*CalibrationProbe)(void* context, uint16_t pulse);
+
+enum CalibrationState
+{
+    CAL_IDLE = 0,
+    CAL_SETTLING = 1,
+    CAL_WAIT_OPERATOR = 2,
+    CAL_DONE = 3,
+    CAL_FAILED = 4
+};
+
+class CalibrationRoutine {
+
+public:
+    CalibrationRoutine();
+
+    /**
+     * Avvia la calibrazione
+     * @param nominal  Curva di partenza (tipicamente lineare)
+     * @param safeMin  Limite minimo di sicurezza: i punti fuori non vengono visitati
+     * @param safeMax  Limite massimo di sicurezza
+     * @param minPulse Pulse minimo ammesso
+     * @param maxPulse Pulse massimo ammesso
+     * @param now      Tempo attuale (ms)
+     */
+    void begin(
+        const ServoCalibration& nominal,
+        int safeMin,
+        int safeMax,
+        uint16_t minPulse,
+        uint16_t maxPulse,
+        unsigned long now
+    );
+
+    /**
+     * Imposta il probe per la modalità automatica (nullptr = guidata)
+     */
+    void setProbe(CalibrationProbe probe, void* context);
+
+    /**
+     * Avanza la procedura, da chiamare ad ogni tick
+     * @return true se il pulse da emettere è cambiato
+     */
+    bool update(unsigned long now);
+
+// COMANDI OPERATORE
+
+    void nudge(int steps);
+    void confirm();
+    void abort();
+
+// GETTERS
+
+    bool isActive() const;
+    int getState() const;
+    uint16_t getPulse() const;
+    int getCurrentPoint() const;
+    float getCurrentAngle() const;
+    const ServoCalibration& getResult() const;
+
+private:
+    ServoCalibration result;
+    ServoCalibration nominal;
+
+    CalibrationProbe probe;
+    void* probeContext;
+
+    int state;
+    int firstPoint;
+    int lastPoint;
+    int currentPoint;
+    int iterations;
+
+    uint16_t minPulse;
+    uint16_t maxPulse;
+    uint16_t pulse;
+    float pulsePerDegree;
+    bool outputDirty;
+    unsigned long settleStart;
+    unsigned long lastUpdate;
+
+    void enterPoint(int index, unsigned long now);
+    void setPulse(long value, unsigned long now);
+    void recordPoint(unsigned long now);
+    void finish();
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * CALIBRATION STORE - PERSISTENZA CURVE IN NVS
+ *
+ * Una chiave per canale nel namespace "servocal": "ch0".."ch15" per la
+ * scheda 0 (chiavi esistenti invariate), "b1ch0".. per le altre schede.
+ * I record sono validati con versione, range e checksum prima dell'uso.
+ ******************************************************************************/
+
+#ifndef __CALIBRATION_STORE__
+#define __CALIBRATION_STORE__
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "ServoCalibration.h"
+
+#define CAL_STORE_NAMESPACE "servocal"
+#define CAL_STORE_VERSION 1
+
+class CalibrationStore {
+
+public:
+    /**
+     * Carica la curva salvata per un canale
+     * @param board   Scheda PCA9685
+     * @param channel Canale PCA9685
+     * @param cal     In ingresso la curva nominale (range atteso),
+     *                in uscita la curva salvata se valida
+     * @return true se è stata trovata una curva valida
+     */
+    bool load(int board, int channel, ServoCalibration& cal);
+
+    /**
+     * Salva la curva di un canale
+     */
+    bool save(int board, int channel, const ServoCalibration& cal);
+
+    /**
+     * Cancella la curva di un canale (torna alla nominale al prossimo boot)
+     */
+    bool erase(int board, int channel);
+
+private:
+    struct Record {
+        uint8_t version;
+        uint8_t points;
+        int16_t minAngle;
+        int16_t maxAngle;
+        uint16_t pulse[CAL_POINTS];
+        uint16_t checksum;
+    } __attribute__((packed));
+
+    Preferences prefs;
+
+    void makeKey(int board, int channel, char* key, size_t size) const;
+};
+
+#endif
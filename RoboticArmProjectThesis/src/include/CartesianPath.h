@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * CARTESIAN PATH - MOVIMENTO IN LINEA RETTA E JOG CARTESIANO DELLA PINZA
+ *
+ * Campiona il segmento tra la posa attuale e il punto finale una volta
+ * per tick e risolve la cinematica inversa su ogni campione: la punta
+ * della pinza percorre una retta, a differenza dell'interpolazione in
+ * spazio giunti. Lungo la retta la velocità segue un profilo
+ * trapezoidale (mm/s, mm/s²).
+ * Se in un tick un giunto supererebbe la sua velocità massima (vicino
+ * alle singolarità: braccio teso, punta sull'asse della base) il passo
+ * viene accorciato in proporzione, poi la velocità riaccelera. Se
+ * nemmeno un passo minimo rispetta i limiti il movimento si ferma.
+ * Prima di partire la retta viene percorsa a passi di CART_CHECK_STEP_MM:
+ * se esce dallo spazio raggiungibile il movimento non parte.
+ * La retta mantiene la configurazione di partenza (ramo del gomito e
+ * verso della base): ogni campione sceglie la soluzione più vicina al
+ * precedente.
+ * Jog: in alternativa alla retta, ogni asse X/Y/Z riceve una velocità
+ * con segno (pulsante tenuto sul controller), raggiunta e annullata con
+ * rampa; la posizione avanza di un campione per tick con la stessa
+ * riduzione del passo. Al bordo dello spazio raggiungibile il jog si
+ * ferma sul campione precedente. Senza rinnovo entro
+ * CART_JOG_KEEPALIVE_S l'asse decelera fino a fermarsi.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __CARTESIAN_PATH__
+#define __CARTESIAN_PATH__
+
+#include "Kinematics.h"
+
+#define CART_SCALE_ITERATIONS 3      // Tentativi di riduzione del passo per tick
+#define CART_MIN_STEP_MM 0.05f       // Sotto questo passo la retta non è eseguibile
+#define CART_SCALE_MARGIN 0.95f      // Margine sulla velocità dei giunti dopo la riduzione
+#define CART_CHECK_STEP_MM 5.0f      // Passo della verifica della retta in begin()
+#define CART_JOG_KEEPALIVE_S 0.3f    // Come JOG_KEEPALIVE_MS dei giunti
+
+enum CartesianAxis
+{
+    CART_X = 0,
+    CART_Y = 1,
+    CART_Z = 2
+};
+
+enum CartesianState
+{
+    CART_IDLE = 0,
+    CART_RUNNING = 1,
+    CART_STOPPING = 2,   // Decelera lungo la retta e si ferma
+    CART_DONE = 3,
+    CART_FAILED = 4,
+    CART_JOGGING = 5     // Velocità per asse (jog)
+};
+
+enum CartesianError
+{
+    CART_OK = 0,
+    CART_IK_FAILED = 1,      // Punto fuori portata o fuori dai limiti (vedi getIkResult)
+    CART_SINGULAR = 2,       // Passo minimo oltre la velocità dei giunti
+    CART_BAD_REQUEST = 3     // Velocità o accelerazione non valide
+};
+
+class CartesianPath {
+
+public:
+    CartesianPath();
+
+    /**
+     * Cinematica, limiti dei servo e velocità massime dei giunti (gradi/s)
+     */
+    void configure(const Kinematics* kinematics, const IkLimits& limits,
+                   const float maxJointVelocity[KIN_AXES]);
+
+    /**
+     * Verifica e prepara la retta dagli angoli attuali al punto finale
+     * Il punto finale è risolto nella configurazione di partenza (il
+     * pitch, se richiesto, vale solo per il punto finale)
+     * @param speed Velocità lungo la retta (mm/s)
+     * @param accel Accelerazione lungo la retta (mm/s²)
+     * @return CartesianError
+     */
+    int begin(const float servoAngles[KIN_AXES], const IkTarget& target, float speed, float accel);
+
+    /**
+     * Avanza di un tick
+     * @param dt          Periodo del tick (s)
+     * @param servoAngles Angoli servo del campione
+     * @return true se c'è un nuovo campione da scrivere
+     */
+    bool step(float dt, float servoAngles[KIN_AXES]);
+
+    /**
+     * Avvia o rinnova il jog di un asse (NON-BLOCCANTE)
+     * Se il jog non è attivo parte dagli angoli attuali
+     * @param axis     CartesianAxis
+     * @param velocity Velocità con segno (mm/s, 0 = rilascio)
+     * @param accel    Accelerazione delle rampe (mm/s²)
+     * @return false se c'è una retta in corso
+     */
+    bool jog(const float servoAngles[KIN_AXES], int axis, float velocity, float accel);
+
+    /**
+     * Decelera lungo la retta (o tutti gli assi del jog) fino a fermarsi
+     */
+    void stop();
+
+    /**
+     * Si ferma subito sull'ultimo campione
+     */
+    void abort();
+
+    bool isActive() const;
+    bool isJogging() const;
+    int getState() const;
+    int getError() const;
+
+    /**
+     * IkResult dell'ultima soluzione fallita
+     */
+    int getIkResult() const;
+
+    float getLength() const;        // mm
+    float getTravelled() const;     // mm
+    float getSpeed() const;         // Velocità dell'ultimo tick (mm/s)
+
+// STATISTICHE
+
+    unsigned long getScaledTicks() const;   // Tick con passo ridotto
+    float getMinScale() const;              // Riduzione più forte (1 = nessuna)
+    unsigned long getPaths() const;
+    unsigned long getJogLimits() const;     // Passi di jog fermati al bordo dello spazio
+
+private:
+    const Kinematics* kinematics;
+    IkLimits limits;
+    float maxJointVelocity[KIN_AXES];
+
+    float start[3];         // mm
+    float direction[3];     // Versore
+    float length;
+    float travelled;
+    float velocity;
+    float speed;
+    float accel;
+    float angles[KIN_AXES]; // Ultimo campione
+    float endAngles[KIN_AXES];
+
+    // Jog
+    float position[3];      // mm
+    float jogVelocity[3];   // Attuale (mm/s)
+    float jogTarget[3];     // Richiesta (mm/s)
+    float jogAge[3];        // Tempo dall'ultimo rinnovo (s)
+
+    int state;
+    int error;
+    int ikResult;
+    unsigned long scaledTicks;
+    float minScale;
+    unsigned long paths;
+    unsigned long jogLimits;
+
+    bool solve(float distance, const float previous[KIN_AXES], float solution[KIN_AXES]);
+    bool stepJog(float dt, float servoAngles[KIN_AXES]);
+    float jointRatio(const float solution[KIN_AXES], float dt) const;
+    void finish(int newState, int newError);
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * COLLISION MAP - COMBINAZIONI DI GIUNTI SENZA COLLISIONI
+ *
+ * I limiti dei singoli servo non bastano: alcune combinazioni di gomito
+ * e polso portano la pinza contro la base o il piano, o ripiegano
+ * l'avambraccio sul braccio. La rotazione della base non cambia queste
+ * collisioni, quindi basta una griglia sul piano gomito/polso: un bit
+ * per cella di COLLISION_STEP_DEG gradi, 1 = cella sicura in ogni suo
+ * punto. La griglia è generata offline da tools/genCollisionGrid.cpp
+ * con la geometria di ArmModel.h (vedi CollisionGrid.cpp).
+ * Consultazione O(1); il controllo di un segmento campiona la griglia
+ * lungo il segmento (al più una cella per passo, costo limitato).
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __COLLISION_MAP__
+#define __COLLISION_MAP__
+
+#include <stdint.h>
+#include "ArmModel.h"
+
+#define COLLISION_STEP_DEG 2
+#define COLLISION_ELBOW_CELLS (ARM_ELBOW_RANGE / COLLISION_STEP_DEG + 1)
+#define COLLISION_WRIST_CELLS (ARM_WRIST_RANGE / COLLISION_STEP_DEG + 1)
+#define COLLISION_GRID_BYTES ((COLLISION_ELBOW_CELLS * COLLISION_WRIST_CELLS + 7) / 8)
+
+// Griglia generata (righe = celle del gomito) e geometria usata
+extern const uint8_t COLLISION_GRID[COLLISION_GRID_BYTES];
+extern const ArmGeometry COLLISION_GRID_GEOMETRY;
+
+class CollisionMap {
+
+public:
+    CollisionMap(const uint8_t* grid = COLLISION_GRID);
+
+    /**
+     * Consultazione O(1)
+     * @param elbow Angolo servo del gomito
+     * @param wrist Angolo servo del polso
+     * @return false anche fuori dal campo della griglia
+     */
+    bool isSafe(float elbow, float wrist) const;
+
+    /**
+     * Frazione sicura del segmento (in spazio giunti) da start a end
+     * @return 1 = tutto il segmento, 0 = nessun passo. Se start non è
+     *         sicuro (es. all'accensione) vale 1 solo se end è sicuro
+     */
+    float clip(float elbowStart, float wristStart, float elbowEnd, float wristEnd) const;
+
+    /**
+     * Intervallo sicuro di un giunto con l'altro fermo
+     * Da una posizione non sicura si apre solo verso la zona sicura
+     * più vicina
+     * @param axis KIN_ELBOW o KIN_WRIST
+     */
+    void window(int axis, float elbow, float wrist, float& minAngle, float& maxAngle) const;
+
+    /**
+     * true se la griglia è stata generata con questa geometria
+     */
+    static bool matches(const ArmGeometry& geometry);
+
+    /**
+     * Filtro per IkLimits (context = CollisionMap)
+     */
+    static bool filter(void* context, const float servoAngles[KIN_AXES]);
+
+private:
+    const uint8_t* grid;
+
+    bool isCellSafe(int elbowCell, int wristCell) const;
+    bool isSafeAlong(int axis, int cell, int elbowCell, int wristCell) const;
+    static int cellOf(float angle);
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * GCODE STREAM - MOVIMENTI IN STILE G-CODE DA UN HOST SULLA SERIALE
+ *
+ * Righe accettate:
+ *   G0 / G1 X Y Z [P]       pinza in mm (P = pitch in gradi), cinematica inversa
+ *   G0 / G1 A B C D         giunti in gradi servo (ordine JointIndex)
+ *   F<v>                    velocità di G1 (modale): mm/min per la pinza,
+ *                           gradi/min per i giunti; G0 va al limite dei giunti
+ *   G4 P<ms> | S<s>         pausa a braccio fermo
+ *   G90 / G91               coordinate assolute / relative
+ *   G21                     millimetri (G20 non supportato)
+ *   M114                    posizione attuale
+ *   M115                    capacità (righe del buffer)
+ *   M400                    attende la fine dei movimenti
+ *   M999                    riprende dopo un halt
+ * Commenti ";" e "(...)"; numero di riga N e checksum "*" ignorati.
+ * Senza G0/G1 le parole degli assi usano l'ultimo movimento (modale).
+ *
+ * Le righe restano in un buffer circolare finché il planner dei giunti
+ * ha spazio: la coda del planner resta piena e il lookahead raccorda i
+ * segmenti senza fermarsi tra una riga e l'altra.
+ * Controllo di flusso a crediti: l'host parte con getCapacity() crediti
+ * (M115), ogni riga inviata ne consuma uno e ogni risposta ("ok" o
+ * "error:...") lo restituisce quando la riga lascia il buffer. L'host
+ * non aspetta le risposte finché ha crediti e non riempie mai il buffer.
+ * Le righe vuote vengono scartate senza risposta (nessun credito).
+ * Dopo halt() (braccio fermato) ogni riga riceve un errore fino a M999:
+ * i crediti tornano all'host ma nessun movimento vecchio riparte.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __GCODE_STREAM__
+#define __GCODE_STREAM__
+
+#include <stdint.h>
+
+#define GCODE_BUFFER_LINES 16
+#define GCODE_LINE_LENGTH 96
+#define GCODE_MAX_JOINTS 4
+#define GCODE_JOINT_WORDS "ABCD"     // Una lettera per giunto, in ordine
+
+enum GcodeCommand
+{
+    GCODE_NONE = 0,       // Solo parole modali o commento
+    GCODE_MOVE = 1,       // G0 / G1
+    GCODE_DWELL = 2,      // G4
+    GCODE_SYNC = 3,       // M400
+    GCODE_REPORT = 4,     // M114
+    GCODE_INFO = 5,       // M115
+    GCODE_RESUME = 6,     // M999
+    GCODE_ERROR = 7       // Riga non valida (vedi error)
+};
+
+// Parole della pinza in GcodeBlock.toolMask
+enum GcodeToolWord
+{
+    GCODE_X = 0,
+    GCODE_Y = 1,
+    GCODE_Z = 2,
+    GCODE_PITCH = 3,
+    GCODE_TOOL_WORDS = 4
+};
+
+// Esito dell'esecuzione di una riga (lato braccio)
+enum GcodeResult
+{
+    GCODE_WAIT = 0,       // Non ancora eseguibile: riprovare al prossimo tick
+    GCODE_DONE = 1,       // Risposta "ok"
+    GCODE_REJECTED = 2    // Risposta "error:..."
+};
+
+struct GcodeBlock {
+    uint8_t command;
+    bool rapid;                       // G0
+    bool relative;                    // G91 attivo
+    uint8_t toolMask;                 // Bit GcodeToolWord presenti
+    uint8_t jointMask;                // Bit dei giunti presenti
+    float tool[GCODE_TOOL_WORDS];     // X Y Z pitch
+    float joints[GCODE_MAX_JOINTS];
+    float feed;                       // Unità/s (0 = non impostata)
+    unsigned long dwellMs;
+    const char* error;
+};
+
+class GcodeStream {
+
+public:
+    GcodeStream();
+
+    /**
+     * Numero di giunti comandabili con le lettere GCODE_JOINT_WORDS
+     */
+    void configure(int jointCount);
+
+    /**
+     * true se la riga va allo stream e non alla coda dei comandi:
+     * G/M/N o parola di un asse seguita da un numero, oppure commento
+     */
+    static bool isGcode(const char* line);
+
+    /**
+     * Accoda una riga ricevuta (troppo lunga: accodata come errore)
+     * @return false se il buffer è pieno (l'host ha superato i crediti)
+     */
+    bool push(const char* line);
+
+    /**
+     * Riga in testa già interpretata (una sola volta, nell'ordine di
+     * arrivo, così le parole modali valgono dalla riga successiva)
+     * @return nullptr se il buffer è vuoto
+     */
+    const GcodeBlock* peek();
+
+    /**
+     * Toglie la riga in testa (dopo la risposta all'host)
+     */
+    void pop();
+
+    /**
+     * Rifiuta le righe in buffer e le successive fino a M999
+     */
+    void halt();
+
+    bool isHalted() const;
+    bool isEmpty() const;
+    int getCount() const;
+    int getCapacity() const;
+    unsigned long getReceived() const;   // Righe accodate
+    unsigned long getOverflows() const;  // Righe oltre i crediti
+
+    /**
+     * Interpreta una riga con lo stato modale attuale, che viene
+     * aggiornato solo se la riga è valida
+     * @return false se non è valida (GCODE_ERROR, vedi block.error)
+     */
+    bool parse(const char* line, GcodeBlock& block);
+
+private:
+    char lines[GCODE_BUFFER_LINES][GCODE_LINE_LENGTH];
+    bool overlong[GCODE_BUFFER_LINES];
+    int head;
+    int count;
+    unsigned long received;
+    unsigned long overflows;
+
+    // Riga in testa interpretata
+    GcodeBlock current;
+    bool parsed;
+
+    // Stato modale
+    int jointCount;
+    bool relative;
+    bool rapid;
+    bool hasMotion;        // G0/G1 già visto
+    float feed;
+    bool halted;
+
+    bool fail(GcodeBlock& block, const char* error);
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * I2C LINK - TRASMISSIONE CON RETRY E RECUPERO DEL BUS
+ *
+ * Ogni transazione viene ritentata fino a I2C_MAX_RETRIES volte se il
+ * dispositivo non risponde (NACK) o il driver segnala un errore. Se SDA
+ * resta bassa (uno slave bloccato a metà byte tiene la linea) parte il
+ * bus-clear: fino a I2C_CLEAR_PULSES impulsi su SCL, poi una STOP e il
+ * riavvio del driver. Il recupero avanza di un impulso per step(), così
+ * chi lo chiama non resta bloccato; se SDA non si libera si riprova
+ * dopo I2C_RECOVERY_BACKOFF step.
+ * L'hardware è dietro I2cBus (Wire sull'ESP32, simulato nei test host).
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __I2C_LINK__
+#define __I2C_LINK__
+
+#include <stdint.h>
+
+#define I2C_MAX_RETRIES 2          // Tentativi oltre al primo
+#define I2C_CLEAR_PULSES 9         // Impulsi SCL per liberare un byte a metà
+#define I2C_RECOVERY_BACKOFF 100   // Step di attesa dopo un recupero fallito
+
+// Codici di Wire.endTransmission()
+enum I2cError
+{
+    I2C_OK = 0,
+    I2C_TOO_LONG = 1,       // Dati oltre il buffer di Wire
+    I2C_NACK_ADDRESS = 2,   // Nessuna risposta all'indirizzo
+    I2C_NACK_DATA = 3,      // NACK su un byte dati
+    I2C_OTHER = 4,          // Errore del driver / arbitraggio perso
+    I2C_TIMEOUT = 5,        // Bus occupato oltre il timeout
+    I2C_BUS_DOWN = 6,       // Non inviato: bus in recupero
+    I2C_ERROR_CLASSES = 7
+};
+
+enum I2cLinkState
+{
+    LINK_READY = 0,         // Trasmissioni abilitate
+    LINK_CLEARING = 1,      // Bus-clear in corso
+    LINK_BACKOFF = 2        // Bus-clear fallito, attesa prima di riprovare
+};
+
+/**
+ * Accesso al bus fisico
+ */
+class I2cBus {
+
+public:
+    virtual ~I2cBus() {}
+
+    /**
+     * Transazione completa (START, indirizzo, dati, STOP)
+     * @return Codice I2cError
+     */
+    virtual uint8_t transmit(uint8_t address, const uint8_t* data, int length) = 0;
+
+    /**
+     * true se SDA è tenuta bassa (a bus fermo)
+     */
+    virtual bool isSdaLow() = 0;
+
+    /**
+     * Scollega il driver: SCL e SDA pilotate a mano
+     */
+    virtual void releasePins() = 0;
+
+    /**
+     * Un impulso di clock su SCL
+     */
+    virtual void clockPulse() = 0;
+
+    /**
+     * Condizione di STOP e riavvio del driver
+     */
+    virtual void reattach() = 0;
+};
+
+class I2cLink {
+
+public:
+    explicit I2cLink(I2cBus& bus);
+
+    /**
+     * Invia una transazione con retry
+     * Se il bus risulta bloccato avvia il recupero e ritorna l'errore
+     * @return I2C_OK o l'ultimo errore (I2C_BUS_DOWN durante il recupero)
+     */
+    uint8_t send(uint8_t address, const uint8_t* data, int length);
+
+    /**
+     * Avanza il recupero di un passo (un impulso o un'attesa)
+     * @return true se il bus è pronto
+     */
+    bool step();
+
+    bool isReady() const;
+    int getState() const;
+
+// CONTATORI
+
+    /**
+     * Errori per classe (I2cError), contando ogni tentativo
+     */
+    unsigned long getErrors(int errorClass) const;
+    unsigned long getRetries() const;       // Tentativi ripetuti
+    unsigned long getFailures() const;      // Transazioni fallite dopo i retry
+    unsigned long getStuckEvents() const;   // Bus trovato bloccato
+    unsigned long getRecoveries() const;    // Bus-clear riusciti
+    unsigned long getFailedRecoveries() const;
+    unsigned long getClockPulses() const;
+    void resetCounters();
+
+private:
+    I2cBus& bus;
+    int state;
+    int pulses;
+    int backoff;
+
+    unsigned long errors[I2C_ERROR_CLASSES];
+    unsigned long retries;
+    unsigned long failures;
+    unsigned long stuckEvents;
+    unsigned long recoveries;
+    unsigned long failedRecoveries;
+    unsigned long clockPulses;
+
+    void beginRecovery();
+};
+
+#endif
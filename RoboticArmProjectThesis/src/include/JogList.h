@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * JOG LIST - PIÙ COMANDI DI JOG IN UN MESSAGGIO DI TESTO
+ *
+ * Con più pulsanti tenuti il controller (formato testuale) unisce le
+ * etichette con spazi, per esempio "Base STOP Elbow SX CJOG Z+":
+ *   <giunto> SX|DX|Open|Close|STOP   jog di un giunto
+ *   CJOG <asse>+|-                   jog della pinza lungo X/Y/Z
+ *   CJOG <asse> STOP                 rilascio dell'asse
+ * Il messaggio diventa un frame di jog (vedi ArmFrame.h), applicato in
+ * un solo tick come quelli binari. A parità di giunto vale l'ultimo
+ * comando: il controller mette i rilasci prima delle pressioni.
+ * Una sola parola non valida rifiuta tutto il messaggio (nessun jog
+ * parziale).
+ * Con i frame binari (default) il controller invia già un frame con
+ * tutti i pulsanti: questo percorso serve alle righe da seriale e ai
+ * controller compilati con ARM_FRAME_TEXT_COMPAT = 1.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __JOG_LIST__
+#define __JOG_LIST__
+
+#include <ArmFrame.h>
+
+#define JOG_WORD_LENGTH 16     // Parole più lunghe: messaggio non valido
+
+class JogList {
+
+public:
+    /**
+     * @param names Nomi dei giunti (indice = bit del frame)
+     * @return Comandi riconosciuti, 0 se il messaggio non è una lista di
+     *         jog (frame con maschera vuota)
+     */
+    static int parse(const char* text, const char* const names[], int jointCount, ArmFrame& frame);
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * JOINT TABLE - GIUNTI DEL BRACCIO CONFIGURATI DA TABELLA
+ *
+ * I giunti vengono creati da una tabella di JointConfig (nome, modello,
+ * scheda, canale, limiti, parcheggio), fino a MAX_JOINTS giunti
+ * distribuiti su una o più schede PCA9685.
+ * Lo stato usato dalle interrogazioni frequenti (posizioni, target,
+ * limiti, flag) è tenuto in array contigui e aggiornato in una sola
+ * passata per tick; i flag sono maschere a bit (bit = indice giunto),
+ * così "qualcuno si muove" o "tutti nel range" sono un confronto.
+ ******************************************************************************/
+
+#ifndef __JOINT_TABLE__
+#define __JOINT_TABLE__
+
+#include <Arduino.h>
+#include "ServoBase.h"
+#include "ServoOutput.h"
+
+#define MAX_JOINTS PWM_CHANNELS
+
+// Bit (1 << indice giunto)
+typedef uint16_t JointMask;
+
+enum ServoModel
+{
+    SERVO_MODEL_20KG = 0,   // Servo<Servo20KgTraits>
+    SERVO_MODEL_MG66R = 1   // Servo<MG66RTraits>
+};
+
+/**
+ * Riga della tabella dei giunti
+ */
+struct JointConfig {
+    const char* name;
+    int model;
+    int board;      // Indice in PCA9685_ADDRESSES
+    int channel;
+    int safeMin;
+    int safeMax;
+    float parkAngle;
+};
+
+class JointTable {
+
+public:
+    JointTable();
+
+    /**
+     * Crea i servo della tabella
+     * @return Numero di giunti creati (max MAX_JOINTS)
+     */
+    int configure(const JointConfig* table, int count);
+
+    /**
+     * Avanza i movimenti di tutti i giunti e aggiorna gli array
+     */
+    void update(ServoOutput& pwm);
+
+    /**
+     * Aggiorna gli array dallo stato dei servo (dopo comandi fuori tick)
+     */
+    void sync();
+
+// WAYPOINT DI PIÙ GIUNTI
+
+    /**
+     * Accoda un waypoint di più giunti con un profilo comune: a ogni tick
+     * ogni giunto ha percorso la stessa frazione del proprio tratto, quindi
+     * in spazio giunti il braccio segue il segmento retto fino a targets.
+     * Velocità e accelerazione sono quelle del giunto più limitato, in
+     * proporzione al tratto. Il waypoint precedente viene raccordato solo
+     * se ha gli stessi giunti, nessuno inverte e il salto di velocità di
+     * ognuno sta in un tick della sua accelerazione; altrimenti tutti si
+     * fermano sul waypoint
+     * @param servos      Giunti, indicizzati come le maschere
+     * @param count       Numero di giunti
+     * @param targets     Angoli (indicizzati come servos)
+     * @param mask        Giunti del waypoint
+     * @param maxVelocity Velocità massima di ogni giunto (gradi/s, 0 = limite)
+     * @param cruiseTime  Se > 0, durata della crociera (s), allungata se
+     *                    un giunto non ci arriva
+     * @return false se un giunto è in jog o ha la coda piena (nessun
+     *         giunto viene mosso)
+     */
+    static bool queueSync(
+        ServoMotor* const servos[],
+        int count,
+        const float targets[],
+        JointMask mask,
+        float maxVelocity = 0.0f,
+        float cruiseTime = 0.0f
+    );
+
+    /**
+     * Trattiene la partenza da fermo di un waypoint di più giunti finché
+     * un altro suo giunto non è pronto a partire, così che partano tutti
+     * nello stesso tick. Da chiamare ad ogni tick prima dell'ammissione
+     * (PowerBudget) e di update()
+     */
+    void holdIncompleteGroups();
+
+// ACCESSO
+
+    int getCount() const;
+    ServoMotor* get(int joint) const;
+    ServoMotor* const* getServos() const;
+    const char* getName(int joint) const;
+
+    /**
+     * Indice del giunto con quel nome (-1 se non esiste)
+     */
+    int find(const String& name) const;
+
+// STATO (aggiornato da update()/sync())
+
+    float getPosition(int joint) const;
+    float getTarget(int joint) const;
+    float getParkAngle(int joint) const;
+    JointMask getAllMask() const;
+    JointMask getMovingMask() const;
+    JointMask getUnsafeMask() const;
+
+// IMPOSTAZIONI SU TUTTI I GIUNTI
+
+    void setSafetyEnabled(bool enabled);
+    void setFeedRate(float rate);
+
+private:
+    ServoMotor* servos[MAX_JOINTS];
+    const char* names[MAX_JOINTS];
+    int count;
+
+    // Stato in array contigui
+    float positions[MAX_JOINTS];
+    float targets[MAX_JOINTS];
+    float parkAngles[MAX_JOINTS];
+    float safeMin[MAX_JOINTS];
+    float safeMax[MAX_JOINTS];
+    JointMask movingMask;
+    JointMask unsafeMask;
+    bool safetyEnabled;
+
+    static ServoMotor* createServo(const JointConfig& config);
+};
+
+#endif
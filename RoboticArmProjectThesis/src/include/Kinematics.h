@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * KINEMATICS - CINEMATICA DIRETTA E INVERSA
+ *
+ * Catena: base (rotazione attorno a Z), gomito e polso (rotazioni nel
+ * piano verticale del braccio), punta della pinza. Gli angoli servo
+ * vengono portati in angoli cinematici con offset e verso di ogni giunto:
+ *   - base:   0 = braccio lungo +X, positivo verso +Y
+ *   - gomito: 0 = primo link orizzontale, positivo verso l'alto
+ *   - polso:  0 = secondo link allineato al primo
+ * Calcolo senza float: angoli binari a 16 bit (65536 = 360°), seno e
+ * coseno da una tabella di un quarto d'onda (257 valori Q14) con
+ * interpolazione lineare, lunghezze in 1/256 mm. Costo fisso, adatto a
+ * ogni tick.
+ * La cinematica inversa è analitica (float singola precisione, che
+ * l'ESP32 ha in hardware): per un punto ci sono fino a quattro
+ * soluzioni (base diretta o girata di 180°, gomito alto o basso),
+ * scartate se escono dai limiti dei servo o se il filtro dei limiti
+ * le rifiuta (es. CollisionMap). Con tre giunti il pitch
+ * della pinza dipende dal punto: se richiesto sceglie la soluzione.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __KINEMATICS__
+#define __KINEMATICS__
+
+#include <stdint.h>
+
+#define KIN_Q14_ONE 16384           // 1.0 in Q14
+#define KIN_MM_SCALE 256            // Lunghezze: 1/256 mm
+#define KIN_FULL_TURN 65536L        // Angolo binario di un giro
+#define IK_PITCH_TOLERANCE 3.0f     // Scarto massimo dal pitch richiesto (gradi)
+#define IK_REACH_EPSILON 0.01f      // Tolleranza ai bordi dello spazio di lavoro (mm)
+#define IK_LIMIT_EPSILON 0.01f      // Tolleranza sui limiti dei servo (gradi)
+
+/**
+ * Geometria del braccio (mm e gradi servo)
+ */
+struct ArmGeometry {
+    float baseHeight;   // Piano → asse del gomito
+    float upperArm;     // Asse del gomito → asse del polso
+    float forearm;      // Asse del polso → punta della pinza
+    float baseOffset;   // Angolo servo con il braccio lungo +X
+    float elbowOffset;  // Angolo servo con il primo link orizzontale
+    float wristOffset;  // Angolo servo con il secondo link allineato
+    int baseSign;       // +1 / -1: verso dell'angolo servo
+    int elbowSign;
+    int wristSign;
+};
+
+/**
+ * Posa dell'utensile (1/256 mm, angolo binario)
+ */
+struct ToolPose {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint16_t pitch;     // Inclinazione della pinza sull'orizzontale
+};
+
+enum KinematicAxis
+{
+    KIN_BASE = 0,
+    KIN_ELBOW = 1,
+    KIN_WRIST = 2,
+    KIN_AXES = 3
+};
+
+/**
+ * Configurazione preferita: giunto tra i due link sopra (UP) o sotto
+ * (DOWN) la retta spalla → pinza
+ */
+enum IkBranch
+{
+    IK_ELBOW_UP = 0,
+    IK_ELBOW_DOWN = 1,
+    IK_ELBOW_ANY = 2
+};
+
+enum IkResult
+{
+    IK_OK = 0,
+    IK_UNREACHABLE = 1,     // Fuori dallo spazio di lavoro
+    IK_OUT_OF_LIMITS = 2,   // Raggiungibile solo fuori dai limiti dei servo
+    IK_PITCH_MISMATCH = 3,  // Nessuna soluzione con il pitch richiesto
+    IK_COLLISION = 4        // Tutte le soluzioni scartate dal filtro (collisioni)
+};
+
+/**
+ * Filtro sulle soluzioni (angoli servo): false = da scartare
+ */
+typedef bool (*IkFilter)(void* context, const float servoAngles[KIN_AXES]);
+
+/**
+ * Punto da raggiungere (mm, gradi)
+ */
+struct IkTarget {
+    float x;
+    float y;
+    float z;
+    bool hasPitch;
+    float pitch;        // Come ToolPose.pitch, -180..180
+    int branch;         // IkBranch
+};
+
+/**
+ * Limiti dei servo (gradi servo) e filtro opzionale
+ */
+struct IkLimits {
+    float minAngle[KIN_AXES];
+    float maxAngle[KIN_AXES];
+    IkFilter filter;        // nullptr = nessun filtro
+    void* filterContext;
+};
+
+class Kinematics {
+
+public:
+    Kinematics();
+
+    void configure(const ArmGeometry& geometry);
+    const ArmGeometry& getGeometry() const;
+
+    /**
+     * Cinematica diretta dagli angoli servo
+     * @param servoAngles Base, gomito, polso (gradi servo)
+     */
+    void forward(const float servoAngles[KIN_AXES], ToolPose& pose) const;
+
+    /**
+     * Cinematica diretta dagli angoli cinematici (angoli binari)
+     */
+    void forwardFixed(const uint16_t angles[KIN_AXES], ToolPose& pose) const;
+
+    /**
+     * Angolo servo → angolo cinematico (angolo binario)
+     */
+    uint16_t toKinematic(int axis, float servoAngle) const;
+
+    /**
+     * Cinematica inversa
+     * Tra le soluzioni nei limiti (e nel pitch, se richiesto) vince il
+     * ramo preferito, poi la più vicina agli angoli attuali
+     * @param current     Angoli servo attuali (base, gomito, polso)
+     * @param servoAngles Angoli servo della soluzione
+     * @return IkResult
+     */
+    int inverse(const IkTarget& target, const IkLimits& limits,
+                const float current[KIN_AXES], float servoAngles[KIN_AXES]) const;
+
+    static const char* resultName(int result);
+
+// TRIGONOMETRIA E CONVERSIONI
+
+    static int16_t sinQ14(uint16_t angle);
+    static int16_t cosQ14(uint16_t angle);
+    static uint16_t degToAngle(float degrees);
+    static float angleToDeg(uint16_t angle);   // -180..180
+    static float toMm(int32_t length);
+
+private:
+    ArmGeometry geometry;
+    int32_t baseHeight;     // 1/256 mm
+    int32_t upperArm;
+    int32_t forearm;
+
+    static int32_t quarterSin(uint16_t index);
+
+    bool toServo(int axis, float kinematic, const IkLimits& limits, float& servoAngle) const;
+};
+
+#endif
@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * MOTION PLANNER - CODA WAYPOINT CON LOOKAHEAD PER UN GIUNTO
+ *
+ * Ogni waypoint diventa un segmento a profilo trapezoidale (accelerazione,
+ * crociera, decelerazione) entro i limiti di velocità e accelerazione del
+ * giunto. Il lookahead calcola le velocità di giunzione tra segmenti
+ * consecutivi: se la direzione non cambia il giunto non si ferma a ogni
+ * waypoint ma passa al successivo alla velocità ammessa.
+ *
+ * I waypoint di più giunti sono segmenti sincronizzati: il profilo è
+ * calcolato sulla frazione percorsa (0..1) con limiti comuni a tutti i
+ * giunti del waypoint, quindi a ogni tick tutti hanno percorso la stessa
+ * frazione del proprio tratto e il percorso in spazio giunti è il
+ * segmento retto tra i due waypoint.
+ * Non dipende da Arduino (testabile su host). Tempi in secondi.
+ ******************************************************************************/
+
+#ifndef __MOTION_PLANNER__
+#define __MOTION_PLANNER__
+
+#include <stdint.h>
+
+#define PLANNER_QUEUE_SIZE 8
+
+/**
+ * Limiti comuni di un waypoint di più giunti, in frazioni del tratto
+ * (uguali per tutti i giunti del waypoint)
+ */
+struct SyncProfile {
+    uint16_t group;       // Waypoint (≠ 0, distingue i waypoint consecutivi)
+    float maxVelocity;    // Frazioni/s
+    float maxAccel;       // Frazioni/s² ad accelerazione piena
+    float junction;       // Velocità massima di raccordo col waypoint precedente
+};
+
+/**
+ * Segmento in coda
+ * Per un giunto solo il percorso è in gradi; per un waypoint di più
+ * giunti è la frazione del tratto (length = 1, o il resto dopo resume())
+ */
+struct MotionSegment {
+    float startAngle;
+    float targetAngle;
+    float length;         // Lunghezza del percorso
+    float maxVelocity;    // Velocità di crociera massima del segmento
+    float maxAccel;       // Solo sincronizzati: accelerazione a scala piena
+    float junction;       // Solo sincronizzati: limite di raccordo in ingresso
+    uint16_t group;       // 0 = giunto singolo
+    float entryVelocity;  // Calcolata dal lookahead
+    float exitVelocity;   // Calcolata dal lookahead
+};
+
+/**
+ * Profilo trapezoidale di un segmento, campionabile a qualsiasi tempo
+ */
+struct MotionProfile {
+    float startAngle;
+    float direction;      // Gradi per unità di percorso (±1 per un giunto solo)
+    float distance;       // Lunghezza del percorso
+    float entryVelocity;
+    float cruiseVelocity;
+    float exitVelocity;
+    float accelIn;        // Accelerazione fase 1 (con segno)
+    float accelOut;       // Accelerazione fase 3 (con segno)
+    float t1, t2, duration;
+    float d1, d2;
+
+    float position(float t) const;
+    float velocity(float t) const;
+
+    /**
+     * Percorso fatto e velocità sul percorso (unità del segmento)
+     */
+    float travel(float t) const;
+    float speed(float t) const;
+};
+
+class MotionPlanner {
+
+public:
+    MotionPlanner();
+
+    /**
+     * Limiti del giunto (gradi/s e gradi/s²)
+     * Ricalcola il lookahead dei segmenti in coda
+     * @param accelScale Scala dell'accelerazione (ammissione), applicata
+     *                   anche ai segmenti sincronizzati
+     */
+    void setLimits(float maxVelocity, float maxAccel, float accelScale = 1.0f);
+    float getMaxVelocity() const;
+
+    /**
+     * Accelerazione del giunto già scalata
+     */
+    float getMaxAccel() const;
+
+    /**
+     * Svuota la coda e ferma il planner nella posizione indicata
+     */
+    void reset(float position);
+
+    /**
+     * Aggiunge un waypoint e ricalcola il lookahead
+     * @param targetAngle Angolo finale
+     * @param maxVelocity Velocità massima (0 = limite del giunto)
+     * @return false se la coda è piena
+     */
+    bool push(float targetAngle, float maxVelocity = 0.0f);
+
+    /**
+     * Aggiunge il tratto di questo giunto di un waypoint di più giunti
+     * Con gli stessi sync e la stessa coda, il lookahead dà a tutti i
+     * giunti del waypoint le stesse velocità sul percorso
+     * @return false se la coda è piena
+     */
+    bool pushSync(float targetAngle, const SyncProfile& sync);
+
+    /**
+     * Toglie l'ultimo waypoint in coda (non il segmento attivo)
+     * @return false se la coda è vuota
+     */
+    bool dropLast();
+
+    /**
+     * Estrae il prossimo segmento e ne costruisce il profilo
+     * @return false se la coda è vuota
+     */
+    bool next(MotionProfile& profile);
+
+    /**
+     * Rimette in testa alla coda il resto del segmento attivo, dal
+     * punto raggiunto al suo target, così che il lookahead possa
+     * raccordarlo con i waypoint arrivati durante l'esecuzione
+     * @param travelled Percorso già fatto (MotionProfile::travel)
+     * @param speed     Velocità sul percorso (MotionProfile::speed)
+     */
+    void resume(float travelled, float speed);
+
+// GETTERS
+
+    bool isFull() const;
+    bool isEmpty() const;
+    int getCount() const;
+
+    /**
+     * Angolo finale dell'ultimo waypoint (o posizione se vuota)
+     */
+    float getEndPosition() const;
+
+    /**
+     * Primo segmento in coda
+     * @return false se la coda è vuota
+     */
+    bool peek(MotionSegment& segment) const;
+
+    /**
+     * Ultimo segmento: l'ultimo in coda, o quello attivo se la coda è
+     * vuota e activeRunning
+     * @return false se non c'è
+     */
+    bool getTail(MotionSegment& segment, bool activeRunning) const;
+
+    /**
+     * true se un segmento del waypoint group è ancora in coda
+     */
+    bool contains(uint16_t group) const;
+
+    /**
+     * Tempo minimo di un movimento da fermo a fermo (s)
+     */
+    float restToRestTime(float distance, float maxVelocity = 0.0f) const;
+
+    /**
+     * Velocità di crociera che fa durare un movimento da fermo a fermo
+     * esattamente duration secondi (limite del giunto se impossibile)
+     */
+    float velocityForDuration(float distance, float duration) const;
+
+    /**
+     * Costruisce il profilo di un segmento con i limiti del giunto
+     */
+    void buildProfile(const MotionSegment& segment, MotionProfile& profile) const;
+
+private:
+    MotionSegment queue[PLANNER_QUEUE_SIZE];
+    int head;
+    int count;
+
+    float maxVelocity;
+    float maxAccel;       // Già scalata
+    float accelScale;
+
+    // Ingresso della coda: uscita (fissata) del segmento attivo
+    float entryVelocity;
+
+    // Segmento attivo, per resume() e getTail()
+    MotionSegment active;
+
+    float endPosition;
+
+    MotionSegment& at(int index);
+    const MotionSegment& at(int index) const;
+    MotionSegment& append(float targetAngle);
+    float accelOf(const MotionSegment& segment) const;
+    float junctionVelocity(const MotionSegment& prev, const MotionSegment& next) const;
+    void recalculate();
+};
+
+#endif
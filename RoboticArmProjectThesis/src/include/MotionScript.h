@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * MOTION SCRIPT - SEQUENZE DI MOVIMENTI CON NOME
+ *
+ * Script a righe compilato in un programma a istruzioni di dimensione
+ * fissa (nessuna allocazione dinamica):
+ *   # commento
+ *   POSE <nome> a0 a1 ...   posa con un angolo per giunto (non è un'istruzione)
+ *   GO <nome>               tutti i giunti alla posa, arrivo insieme
+ *   JOINT <giunto> <angolo> un giunto
+ *   MOVE x y z [pitch]      pinza nel punto (cinematica inversa)
+ *   LINE x y z [pitch]      pinza nel punto in linea retta
+ *   CLAW OPEN|CLOSE|<ang>   pinza
+ *   WAIT <ms>               pausa a braccio fermo
+ *   REPEAT [n] ... END      ripete n volte (senza n: all'infinito)
+ * Le istruzioni sono sequenziali: ognuna parte a braccio fermo, quindi
+ * la durata di un ciclo è la somma dei movimenti e delle pause.
+ * ScriptRunner avanza di un passo per tick senza bloccare; il dry-run
+ * percorre il programma su una posizione simulata, verifica limiti e
+ * raggiungibilità e somma le durate stimate.
+ * Il braccio è visto attraverso ScriptTarget.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __MOTION_SCRIPT__
+#define __MOTION_SCRIPT__
+
+#include <stdint.h>
+
+#define SCRIPT_MAX_OPS 96
+#define SCRIPT_MAX_POSES 16
+#define SCRIPT_MAX_JOINTS 8
+#define SCRIPT_MAX_DEPTH 4              // REPEAT annidati
+#define SCRIPT_NAME_LENGTH 16
+#define SCRIPT_LINE_LENGTH 96
+#define SCRIPT_OPS_PER_STEP 8           // Istruzioni senza movimento per tick
+#define SCRIPT_DRY_RUN_STEPS 20000      // Istruzioni massime simulate
+
+enum ScriptOpCode {
+    OP_END = 0,       // Fine del programma
+    OP_GO = 1,        // arg = posa
+    OP_JOINT = 2,     // joint, values[0] = angolo
+    OP_MOVE = 3,      // values = x y z pitch
+    OP_LINE = 4,
+    OP_WAIT = 5,      // values[0] = ms
+    OP_REPEAT = 6,    // arg = ripetizioni (0 = infinite)
+    OP_LOOP = 7       // arg = indice della prima istruzione del corpo
+};
+
+enum ScriptState {
+    SCRIPT_IDLE = 0,
+    SCRIPT_RUNNING = 1,
+    SCRIPT_DONE = 2,
+    SCRIPT_FAILED = 3    // Movimento rifiutato dal braccio
+};
+
+struct ScriptOp {
+    uint8_t code;
+    uint8_t joint;
+    bool hasPitch;
+    uint16_t line;       // Riga del sorgente (per gli errori)
+    int16_t arg;
+    float values[4];
+};
+
+/**
+ * Nomi dei giunti e pinza per la compilazione
+ */
+struct ScriptConfig {
+    const char* const* jointNames;
+    int jointCount;
+    int clawJoint;       // -1 = nessuna pinza
+    float clawOpen;
+    float clawClose;
+};
+
+/**
+ * Il braccio visto dallo script: esecuzione e stime per il dry-run
+ */
+class ScriptTarget {
+public:
+    /**
+     * true se nessun giunto si muove (si può dare l'istruzione successiva)
+     */
+    virtual bool isIdle() = 0;
+
+    /**
+     * Movimenti: false se rifiutato (coda piena, fuori limiti, ...)
+     * @param angles Un angolo per giunto (solo quelli di mask)
+     */
+    virtual bool moveJoints(const float angles[], uint16_t mask) = 0;
+    virtual bool moveTool(const float target[4], bool hasPitch, bool straight) = 0;
+
+    /**
+     * Dry-run: angoli dei giunti per un punto della pinza partendo da
+     * current (non muove nulla)
+     * @return false se il punto non è raggiungibile
+     */
+    virtual bool solveTool(const float target[4], bool hasPitch, const float current[], float angles[]) = 0;
+
+    /**
+     * Dry-run: posa nei limiti e senza collisioni
+     */
+    virtual bool isPoseValid(const float angles[]) = 0;
+
+    /**
+     * Dry-run: durata stimata (s) di un movimento da fermo a fermo
+     */
+    virtual float estimateTime(const float from[], const float to[], bool straight) = 0;
+
+    virtual ~ScriptTarget() {}
+};
+
+class MotionScript {
+
+public:
+    MotionScript();
+
+    /**
+     * Compila un sorgente (righe separate da '\n')
+     * @return false con getErrorLine()/getError() impostati
+     */
+    bool compile(const char* source, const ScriptConfig& config);
+
+    bool isValid() const;
+    int getOpCount() const;
+    const ScriptOp& getOp(int index) const;
+    const float* getPose(int index) const;
+    int getJointCount() const;
+
+    int getErrorLine() const;
+    const char* getError() const;
+
+private:
+    ScriptOp ops[SCRIPT_MAX_OPS];
+    int opCount;
+    float poses[SCRIPT_MAX_POSES][SCRIPT_MAX_JOINTS];
+    char poseNames[SCRIPT_MAX_POSES][SCRIPT_NAME_LENGTH];
+    int poseCount;
+    int jointCount;
+    bool valid;
+    int errorLine;
+    const char* error;
+
+    bool compileLine(char* line, int number, const ScriptConfig& config, int* loops, int& depth);
+    ScriptOp* addOp(uint8_t code, int number);
+    int findPose(const char* name) const;
+    bool fail(int number, const char* message);
+};
+
+/**
+ * Esito del dry-run
+ */
+struct ScriptReport {
+    bool ok;
+    float cycleSeconds;      // Durata stimata (un giro dei REPEAT infiniti)
+    int moves;
+    bool endless;            // Contiene un REPEAT infinito
+    int errorLine;
+    const char* error;
+};
+
+class ScriptRunner {
+
+public:
+    ScriptRunner();
+
+    /**
+     * Avvia un programma compilato (il programma deve restare valido)
+     */
+    bool start(const MotionScript* script, ScriptTarget* target);
+    void stop();
+
+    /**
+     * Un passo per tick: al più un movimento e SCRIPT_OPS_PER_STEP
+     * istruzioni di controllo, mai in attesa attiva
+     * @param now Tempo attuale (ms)
+     * @return ScriptState
+     */
+    int step(unsigned long now);
+
+    int getState() const;
+    bool isRunning() const;
+    int getLine() const;            // Riga dell'istruzione corrente
+    unsigned long getCycles() const;  // Giri completati del REPEAT esterno
+
+    /**
+     * Percorre il programma senza muovere il braccio
+     * @param start Angoli di partenza (un valore per giunto)
+     */
+    static void dryRun(const MotionScript& script, ScriptTarget& target, const float start[], ScriptReport& report);
+
+private:
+    const MotionScript* script;
+    ScriptTarget* target;
+    int state;
+    int pc;
+    int remaining[SCRIPT_MAX_DEPTH];   // Ripetizioni rimaste per livello
+    int depth;
+    bool waiting;
+    unsigned long waitStart;
+    unsigned long cycles;
+
+    bool issue(const ScriptOp& op);
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * PARKING SEQUENCE - PARCHEGGIO ORDINATO E A VELOCITÀ LIMITATA
+ *
+ * Porta i giunti nelle posizioni di parcheggio per fasi: ogni fase muove
+ * insieme i giunti della sua maschera (es. prima si alza il gomito, poi
+ * si ruota la base) e parte quando la precedente è ferma. I movimenti
+ * passano dal planner dei servo, quindi con rampe e a velocità ridotta,
+ * senza il picco di corrente dei salti istantanei.
+ * All'avvio sceglie la velocità più bassa che rispetta il budget di tempo;
+ * se nemmeno al limite dei giunti le fasi in serie ci stanno, o se il
+ * budget scade con fasi ancora in attesa, le avvia tutte insieme.
+ * Non blocca: il chiamante fa update() ad ogni tick e interroga lo stato.
+ ******************************************************************************/
+
+#ifndef __PARKING_SEQUENCE__
+#define __PARKING_SEQUENCE__
+
+#include <Arduino.h>
+#include "JointTable.h"
+
+#define PARK_MAX_STAGES 8
+#define PARK_VELOCITY 45.0f          // Velocità preferita (gradi/s)
+#define PARK_TIME_BUDGET_MS 5000     // Durata massima del parcheggio
+
+enum ParkingState
+{
+    PARK_IDLE = 0,
+    PARK_RUNNING = 1,
+    PARK_DONE = 2,
+    PARK_LATE = 3      // Completato oltre il budget
+};
+
+class ParkingSequence {
+
+public:
+    ParkingSequence();
+
+    /**
+     * Imposta l'ordine delle fasi
+     * I giunti che non compaiono in nessuna fase partono con l'ultima
+     * @param masks Bit (1 << indice giunto) dei giunti di ogni fase
+     * @param count Numero di fasi (max PARK_MAX_STAGES)
+     */
+    void setOrder(const JointMask* masks, int count);
+
+    /**
+     * Avvia il parcheggio (i giunti in movimento vengono fermati in rampa)
+     * @param servos  Giunti indicizzati come nelle maschere
+     * @param targets Angoli di parcheggio
+     * @param count   Numero di giunti
+     * @param now     Tempo attuale (ms)
+     * @param budget  Durata massima (ms)
+     */
+    void begin(
+        ServoMotor* const servos[],
+        const float targets[],
+        int count,
+        unsigned long now,
+        unsigned long budget = PARK_TIME_BUDGET_MS
+    );
+
+    /**
+     * Avanza la sequenza, da chiamare ad ogni tick
+     * @return true quando il parcheggio è terminato
+     */
+    bool update(unsigned long now);
+
+    /**
+     * Interrompe la sequenza (i movimenti già avviati proseguono)
+     */
+    void abort();
+
+// GETTERS
+
+    bool isActive() const;
+    int getState() const;
+    int getCurrentStage() const;
+    float getVelocity() const;
+
+private:
+    ServoMotor* servos[MAX_JOINTS];
+    float targets[MAX_JOINTS];
+    int jointCount;
+
+    JointMask stages[PARK_MAX_STAGES];
+    int stageCount;
+    int currentStage;    // Prima fase non ancora avviata
+    JointMask launched;  // Giunti delle fasi già avviate
+
+    int state;
+    float velocity;      // Velocità scelta per rispettare il budget
+    bool parallel;       // Fasi sovrapposte: in serie non starebbero nel budget
+    unsigned long startTime;
+    unsigned long budget;
+
+    unsigned long estimate(float velocity) const;
+    bool isStageIdle(JointMask mask) const;
+    void startStage(JointMask mask);
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * POWER BUDGET - AMMISSIONE DEI MOVIMENTI ENTRO LA CORRENTE DISPONIBILE
+ *
+ * Tutti i servo condividono un'unica alimentazione: più giunti che
+ * accelerano insieme possono far scendere la tensione e resettare l'ESP32.
+ * Ogni giunto fermo assorbe la corrente di mantenimento; un giunto che
+ * parte prenota in più la corrente stimata al suo limite di accelerazione
+ * e velocità, e la tiene finché non torna fermo.
+ * Se la prenotazione non sta nel budget l'accelerazione del giunto viene
+ * ridotta; se nemmeno alla scala minima ci sta, la partenza viene
+ * rimandata (sfalsata) finché un altro giunto non si ferma.
+ * I giunti di un waypoint sincronizzato sono ammessi insieme, con la
+ * stessa scala (i profili si allungano insieme) o rimandati tutti.
+ * Da chiamare ad ogni tick PRIMA di updateSmoothMove().
+ ******************************************************************************/
+
+#ifndef __POWER_BUDGET__
+#define __POWER_BUDGET__
+
+#include <Arduino.h>
+#include "JointTable.h"
+
+#define POWER_BUDGET_DEFAULT_MA 4000.0f  // Alimentazione servo (mA)
+#define POWER_MIN_ACCEL_SCALE 0.3f       // Sotto questa scala si sfalsa
+
+// Modello di assorbimento per classe di carico (mA, mA per °/s², mA per °/s)
+#define POWER_IDLE_HEAVY_MA 150.0f
+#define POWER_ACCEL_HEAVY 1.2f
+#define POWER_VELOCITY_HEAVY 3.0f
+#define POWER_IDLE_LIGHT_MA 80.0f
+#define POWER_ACCEL_LIGHT 0.5f
+#define POWER_VELOCITY_LIGHT 1.5f
+
+class PowerBudget {
+
+public:
+    PowerBudget();
+
+    /**
+     * Corrente disponibile per i servo (mA)
+     */
+    void setBudget(float milliAmps);
+    float getBudget() const;
+
+    /**
+     * Ammette, scala o rimanda le partenze dei giunti
+     * @param servos Giunti, in ordine di priorità
+     * @param count  Numero di giunti
+     */
+    void admit(ServoMotor* const servos[], int count);
+
+    /**
+     * Corrente stimata di un giunto (mA)
+     * @param loadClass LOAD_LIGHT / LOAD_HEAVY
+     * @param accel     Accelerazione (gradi/s²)
+     * @param velocity  Velocità (gradi/s)
+     */
+    static float jointCurrent(int loadClass, float accel, float velocity);
+
+// STATISTICHE
+
+    float getReservedCurrent() const;   // Prenotata ora (mA)
+    float getPeakCurrent() const;       // Massima prenotata (mA)
+    unsigned long getScaledStarts() const;
+    unsigned long getDelayedStarts() const;
+    unsigned long getDelayedTicks() const;
+    void resetStats();
+
+private:
+    float budget;
+    bool reserved[MAX_JOINTS];
+    bool delayed[MAX_JOINTS];
+    float reservation[MAX_JOINTS];
+
+    float reservedCurrent;
+    float peakCurrent;
+    unsigned long scaledStarts;
+    unsigned long delayedStarts;
+    unsigned long delayedTicks;
+
+    void admitGroup(ServoMotor* const servos[], int count, int first, uint16_t group,
+                    bool done[], float& total);
+};
+
+#endif
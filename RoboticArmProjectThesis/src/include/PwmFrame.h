@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * PWM FRAME - REGISTRI DI UN PCA9685 DA INVIARE IN BLOCCO
+ *
+ * Copia dei registri LEDn_ON/OFF di una scheda con i canali modificati
+ * nel tick. Il frame viene spedito a gruppi di canali consecutivi: con
+ * l'auto-increment del PCA9685 un gruppo è una sola transazione I2C
+ * (indirizzo + registro iniziale + 4 byte per canale). Due gruppi vengono
+ * uniti se riscrivere i canali in mezzo costa meno di una transazione.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __PWM_FRAME__
+#define __PWM_FRAME__
+
+#include <stdint.h>
+#include "PwmPhaseTable.h"
+
+#define PCA9685_LED0_ON_L_REG 0x06
+#define PWM_BYTES_PER_CHANNEL 4
+#define I2C_TRANSACTION_OVERHEAD 3   // Indirizzo + registro + start/stop (byte)
+
+// Caso peggiore di un frame: 16 canali + un registro per gruppo (max 8)
+#define PWM_FRAME_MAX_BYTES (PWM_CHANNELS * PWM_BYTES_PER_CHANNEL + PWM_CHANNELS / 2)
+#define PWM_FRAME_MAX_RUNS (PWM_CHANNELS / 2)
+
+/**
+ * Gruppo di canali consecutivi da scrivere in una transazione
+ */
+struct PwmRun {
+    uint8_t first;
+    uint8_t last;
+};
+
+class PwmFrame {
+
+public:
+    PwmFrame();
+
+    /**
+     * Aggiorna i registri di un canale (segnato da inviare se cambiano)
+     */
+    void set(int channel, uint16_t on, uint16_t off);
+
+    bool isDirty() const;
+    uint16_t getDirtyMask() const;
+
+    /**
+     * Divide i canali modificati in gruppi da inviare
+     * @param runs Gruppi in ordine di registro (max PWM_CHANNELS)
+     * @return Numero di gruppi
+     */
+    int plan(PwmRun* runs) const;
+
+    /**
+     * Byte di un gruppo: registro iniziale + ON_L, ON_H, OFF_L, OFF_H
+     * @return Lunghezza scritta in buffer
+     */
+    int encode(const PwmRun& run, uint8_t* buffer) const;
+
+    /**
+     * Byte sul bus per inviare i gruppi (overhead incluso)
+     */
+    static int busBytes(const PwmRun* runs, int count);
+
+    /**
+     * Frame inviato: i canali tornano puliti
+     */
+    void clearDirty();
+
+    /**
+     * Canali da reinviare (frame ripreso prima della trasmissione)
+     */
+    void markDirty(uint16_t mask);
+
+    uint16_t getOn(int channel) const;
+    uint16_t getOff(int channel) const;
+
+private:
+    uint16_t on[PWM_CHANNELS];
+    uint16_t off[PWM_CHANNELS];
+    uint16_t dirty;
+};
+
+#endif
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * PWM PHASE TABLE - SFASAMENTO DEGLI IMPULSI SUI CANALI PCA9685
+ *
+ * Con ON = 0 tutti gli impulsi servo partono sullo stesso fronte del
+ * periodo e i driver dei servo assorbono corrente in fase. La tabella
+ * distribuisce i canali usati su slot equispaziati del periodo (4096
+ * conteggi): l'impulso di ogni canale parte dal suo offset e, se supera
+ * la fine del periodo, prosegue nel successivo (OFF < ON, supportato dal
+ * PCA9685). Con n canali e impulsi ≤ 4096/n non ci sono sovrapposizioni.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __PWM_PHASE_TABLE__
+#define __PWM_PHASE_TABLE__
+
+#include <stdint.h>
+
+#define PWM_PERIOD_COUNTS 4096
+#define PWM_CHANNELS 16
+#define PWM_FULL_OFF 4096  // Bit FULL_OFF del registro OFF
+
+class PwmPhaseTable {
+
+public:
+    PwmPhaseTable();
+
+    /**
+     * Registra un canale e ridistribuisce gli offset di tutti
+     * @return true se gli offset sono cambiati (uscite da riscrivere)
+     */
+    bool add(int channel);
+
+    bool contains(int channel) const;
+    int getCount() const;
+
+    /**
+     * Offset ON del canale (0 se non registrato)
+     */
+    uint16_t getOffset(int channel) const;
+
+    /**
+     * Registri ON/OFF per un impulso di pulse conteggi
+     * pulse = 0 spegne il canale (FULL_OFF)
+     */
+    void window(int channel, uint16_t pulse, uint16_t& on, uint16_t& off) const;
+
+private:
+    uint16_t offsets[PWM_CHANNELS];
+    bool used[PWM_CHANNELS];
+    int count;
+
+    void rebuild();
+};
+
+#endif
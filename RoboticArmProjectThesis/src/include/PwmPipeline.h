@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * PWM PIPELINE - INVIO ASINCRONO DEI FRAME PWM SU I2C
+ *
+ * Il MotionTask calcola i frame e li accoda; un task FreeRTOS dedicato
+ * (core 0, il loop Arduino gira sul core 1) li trasmette con Wire, così
+ * il tick non resta fermo per tutto il tempo di bus.
+ * Doppio buffer: mentre un batch è sul bus l'altro si riempie. Se al
+ * tick successivo il batch pronto non è ancora partito viene ripreso e
+ * riscritto con i valori nuovi (vince l'ultimo impulso); se entrambi i
+ * buffer sono occupati il frame resta nei PwmFrame e parte al tick dopo.
+ * Dopo l'avvio del task solo il task usa Wire. Le transazioni passano da
+ * I2cLink (retry e bus-clear): i canali di una transazione fallita
+ * tornano da inviare al flush successivo, e durante il recupero del bus
+ * i batch restano in coda (ripresi e aggiornati a ogni tick).
+ ******************************************************************************/
+
+#ifndef __PWM_PIPELINE__
+#define __PWM_PIPELINE__
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "PwmFrame.h"
+#include "I2cLink.h"
+#include "WireBus.h"
+
+#define MAX_BOARDS 4                   // Schede PCA9685 sullo stesso bus
+#define PWM_PIPELINE_STACK 2048
+#define PWM_PIPELINE_PRIORITY 2        // Sopra il loop Arduino (1)
+#define PWM_PIPELINE_CORE 0
+
+#define PWM_BATCH_BYTES (MAX_BOARDS * PWM_FRAME_MAX_BYTES)
+#define PWM_BATCH_TRANSFERS (MAX_BOARDS * PWM_FRAME_MAX_RUNS)
+
+enum PwmBatchState
+{
+    BATCH_FREE = 0,     // Libero
+    BATCH_FILLING = 1,  // In scrittura dal MotionTask
+    BATCH_READY = 2,    // Accodato, non ancora sul bus
+    BATCH_SENDING = 3   // In trasmissione
+};
+
+/**
+ * Una transazione I2C del batch (un gruppo di registri di una scheda)
+ */
+struct PwmTransfer {
+    uint8_t board;
+    uint8_t address;
+    uint8_t length;
+    uint16_t offset;    // In PwmBatch::data
+    uint16_t mask;      // Canali contenuti
+};
+
+/**
+ * Frame di tutte le schede di un tick
+ */
+struct PwmBatch {
+    uint8_t data[PWM_BATCH_BYTES];
+    PwmTransfer transfers[PWM_BATCH_TRANSFERS];
+    int count;
+    int length;
+    uint16_t dirty[MAX_BOARDS];   // Canali contenuti, per scheda
+    volatile uint8_t state;
+
+    /**
+     * Aggiunge una transazione (false se il batch è pieno)
+     */
+    bool add(int board, uint8_t address, uint16_t mask, const uint8_t* bytes, int size);
+    void clear();
+};
+
+class PwmPipeline {
+
+public:
+    PwmPipeline();
+
+    /**
+     * Avvia il task di trasmissione
+     * @return false se il task non parte (invio sincrono in submit)
+     */
+    bool begin();
+    bool isRunning() const;
+
+    /**
+     * Verifica la presenza di un dispositivo (prima di begin())
+     * Con il bus bloccato esegue un bus-clear completo e riprova
+     * @return Codice I2cError
+     */
+    uint8_t probe(uint8_t address);
+
+    /**
+     * Buffer da riempire: il batch pronto non ancora partito, altrimenti
+     * quello libero. Se il batch è stato ripreso i suoi dirty[] indicano
+     * i canali da rimettere nel frame.
+     * @return nullptr se entrambi i buffer sono occupati
+     */
+    PwmBatch* acquire();
+
+    /**
+     * Accoda un batch riempito (vuoto = rilasciato subito)
+     */
+    void submit(PwmBatch* batch);
+
+    bool isBusy() const;
+
+    /**
+     * Canali di una scheda la cui transazione è fallita (azzera)
+     */
+    uint16_t takeFailed(int board);
+
+    const I2cLink& getLink() const;
+
+// ESITO (scritto dal task di trasmissione)
+
+    unsigned long getCompleted() const;     // Batch trasmessi
+    unsigned long getErrors() const;        // Transazioni fallite dopo i retry
+    uint8_t getLastError() const;           // Codice di Wire.endTransmission()
+    uint8_t getLastErrorAddress() const;
+    unsigned long getLastBusMicros() const; // Durata dell'ultimo batch sul bus
+    unsigned long getMaxBusMicros() const;
+    unsigned long getDeferred() const;      // Tick senza buffer libero
+    unsigned long getReclaimed() const;     // Batch ripresi prima dell'invio
+
+private:
+    PwmBatch batches[2];
+    WireBus bus;
+    I2cLink link;
+    uint16_t failed[MAX_BOARDS];
+    TaskHandle_t task;
+    portMUX_TYPE lock;
+    bool running;
+
+    volatile unsigned long completed;
+    volatile unsigned long errors;
+    volatile uint8_t lastError;
+    volatile uint8_t lastErrorAddress;
+    volatile unsigned long lastBusMicros;
+    volatile unsigned long maxBusMicros;
+    unsigned long deferred;
+    unsigned long reclaimed;
+
+    static void taskEntry(void* param);
+    void run();
+    PwmBatch* take();
+    void transmit(PwmBatch& batch);
+};
+
+#endif
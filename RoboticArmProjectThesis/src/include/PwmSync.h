@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * PWM SYNC - FASE DEL PERIODO PWM DEL PCA9685
+ *
+ * L'oscillatore del PCA9685 non è leggibile: un canale di riferimento
+ * (PWM_SYNC_CHANNEL, ON = 0) emette un breve impulso all'inizio di ogni
+ * periodo ed è collegato a un GPIO (PWM_SYNC_PIN). L'interrupt sul
+ * fronte di salita registra l'istante di inizio periodo, da cui si
+ * ricava quanto manca al prossimo.
+ * Il PCA9685 applica i nuovi ON/OFF al ciclo successivo: un frame che
+ * arriva appena prima dell'inizio del periodo ha la latenza minima,
+ * uno che arriva appena dopo aspetta un periodo intero. phaseError()
+ * dice di quanto spostare il tick per stare a PWM_SYNC_LEAD_US dal
+ * fronte.
+ ******************************************************************************/
+
+#ifndef __PWM_SYNC__
+#define __PWM_SYNC__
+
+#include <Arduino.h>
+
+#define PWM_SYNC_PULSE 41           // ~0.5ms a 50Hz (conteggi su 4096)
+#define PWM_SYNC_TIMEOUT_PERIODS 4  // Senza fronti per 4 periodi: non agganciato
+#define PWM_SYNC_DEADBAND_US 500    // Scarto tollerato prima di spostare il tick
+
+class PwmSync {
+
+public:
+    PwmSync();
+
+    /**
+     * Collega l'interrupt del fronte di riferimento
+     * @param pin          GPIO collegato al canale di riferimento (-1 = disattivo)
+     * @param periodMicros Periodo PWM (µs)
+     */
+    void begin(int pin, unsigned long periodMicros);
+    void setPeriod(unsigned long periodMicros);
+
+    /**
+     * true se i fronti arrivano regolarmente
+     */
+    bool isLocked(unsigned long now) const;
+
+    /**
+     * µs che mancano al prossimo inizio periodo
+     */
+    unsigned long untilNextPeriod(unsigned long now) const;
+
+    /**
+     * Scarto tra l'anticipo attuale e quello desiderato (µs)
+     * > 0: uscita troppo in anticipo (ritardare il tick)
+     * < 0: uscita in ritardo (anticipare il tick)
+     * @param lead Anticipo desiderato sul fronte (µs)
+     */
+    long phaseError(unsigned long now, unsigned long lead) const;
+
+    unsigned long getEdges() const;
+    unsigned long getPeriod() const;
+
+private:
+    int pin;
+    unsigned long period;
+    volatile unsigned long lastEdge;
+    volatile unsigned long edges;
+
+    static void IRAM_ATTR onEdge(void* arg);
+};
+
+#endif
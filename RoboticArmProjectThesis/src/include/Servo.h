@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * SERVO<TRAITS> - SERVO CON CARATTERISTICHE NOTE A COMPILE TIME
+ *
+ * Un modello di servo è una struct di traits con i limiti fisici come
+ * costanti constexpr:
+ *
+ *   struct MyServoTraits {
+ *       static constexpr uint16_t MIN_PULSE = 102;   // Pulse a MIN_ANGLE
+ *       static constexpr uint16_t MAX_PULSE = 512;   // Pulse a MAX_ANGLE
+ *       static constexpr int MIN_ANGLE = 0;
+ *       static constexpr int MAX_ANGLE = 180;
+ *       static constexpr float MAX_SPEED = 240.0f;   // °/s sotto carico
+ *       static constexpr float MAX_ACCEL = 1200.0f;  // °/s²
+ *       static constexpr int MAX_REFRESH_HZ = 50;    // 50 = analogico
+ *       static constexpr int LOAD_CLASS = LOAD_LIGHT;
+ *       static constexpr const char* NAME = "MyServo";
+ *   };
+ *   typedef Servo<MyServoTraits> ServoMotorMy;
+ *
+ * I traits sono verificati a compile time (static_assert) e inizializzano
+ * i limiti di ServoMotor; le conversioni angolo → pulse restano quelle
+ * non virtuali della base, con la curva di calibrazione a runtime.
+ * Servo<Traits> deriva da ServoMotor, quindi giunti di modelli diversi
+ * convivono negli stessi array di ServoMotor*.
+ ******************************************************************************/
+
+#ifndef __SERVO_TEMPLATE__
+#define __SERVO_TEMPLATE__
+
+#include "ServoBase.h"
+
+template <typename Traits>
+class Servo : public ServoMotor {
+
+    static_assert(Traits::MIN_ANGLE < Traits::MAX_ANGLE, "Range angolare vuoto");
+    static_assert(Traits::MIN_PULSE < Traits::MAX_PULSE, "Range di pulse vuoto");
+    static_assert(Traits::MAX_PULSE < PWM_PERIOD_COUNTS, "Pulse oltre il periodo PWM");
+    static_assert(Traits::MAX_SPEED > 0.0f && Traits::MAX_ACCEL > 0.0f, "Limiti dinamici non validi");
+    static_assert(Traits::MAX_REFRESH_HZ >= SERVO_NOMINAL_FREQUENCY, "Refresh sotto i 50Hz nominali");
+    static_assert((long)Traits::MAX_PULSE * Traits::MAX_REFRESH_HZ / SERVO_NOMINAL_FREQUENCY < PWM_PERIOD_COUNTS,
+                  "Impulso massimo oltre il periodo alla frequenza massima");
+
+public:
+    /**
+     * Costruttore con range personalizzabile
+     * @param channel  Canale PCA9685 (0-15)
+     * @param safeMin  Limite minimo di sicurezza (default -1 = no limit)
+     * @param safeMax  Limite massimo di sicurezza (default -1 = no limit)
+     */
+    Servo(int channel, int safeMin = -1, int safeMax = -1)
+        : ServoMotor(
+              channel,
+              Traits::MIN_PULSE,
+              Traits::MAX_PULSE,
+              Traits::MIN_ANGLE,
+              Traits::MAX_ANGLE,
+              (safeMin >= 0) ? safeMin : Traits::MIN_ANGLE,
+              (safeMax >= 0) ? safeMax : Traits::MAX_ANGLE) {
+        setMotionLimits(Traits::MAX_SPEED, Traits::MAX_ACCEL);
+        loadClass = Traits::LOAD_CLASS;
+        Serial.printf("%s initialized\n", Traits::NAME);
+    }
+
+    int getMaxRefresh() const override {
+        return Traits::MAX_REFRESH_HZ;
+    }
+};
+
+#endif
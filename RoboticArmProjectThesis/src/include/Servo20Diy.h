@@ -1,5 +1,5 @@
 /*******************************************************************************
- * SERVO MOTOR 20KG DIY - CLASSE DERIVATA
+ * SERVO MOTOR 20KG DIY - TRAITS DEL MODELLO
  *
  * Servo ad altissima coppia 20kg/cm
  * Range: 0-270°
@@ -10,28 +10,28 @@
 #ifndef __SERVO_20_DIY__
 #define __SERVO_20_DIY__
 
-#include "ServoBase.h"
+#include "Servo.h"
 
-/**
- * Servo 20kg 270° specializzato
- * Eredita da ServoMotor
- */
-class ServoMotor20Diy : public ServoMotor
-{
-
-public:
-    /**
-     * Costruttore con range personalizzabile
-     * @param channel  Canale PCA9685 (0-15)
-     * @param safeMin  Limite minimo di sicurezza (default -1 = no limit)
-     * @param safeMax  Limite massimo di sicurezza (default -1 = no limit)
-     */
-    ServoMotor20Diy(
-        int channel,
-        int safeMin = -1,
-        int safeMax = -1);
+struct Servo20KgTraits {
+    static constexpr uint16_t MIN_PULSE = 102;   // 500μs → 0°
+    static constexpr uint16_t MAX_PULSE = 512;   // 2500μs → 270°
+    static constexpr int MIN_ANGLE = 0;
+    static constexpr int MAX_ANGLE = 270;
+
+    // Limiti dinamici sotto carico (a vuoto: 0.13s/60° ≈ 460°/s)
+    static constexpr float MAX_SPEED = 180.0f;   // °/s
+    static constexpr float MAX_ACCEL = 720.0f;   // °/s²
 
+    // Servo digitale: accetta refresh fino a 330Hz
+    static constexpr int MAX_REFRESH_HZ = 330;
 
+    static constexpr int LOAD_CLASS = LOAD_HEAVY;
+    static constexpr const char* NAME = "ServoMotor20Diy (270°)";
 };
 
-#endif
\ No newline at end of file
+/**
+ * Servo 20kg 270° specializzato
+ */
+typedef Servo<Servo20KgTraits> ServoMotor20Diy;
+
+#endif
@@ -2,11 +2,35 @@
 #define __SERVO_MOTOR_BASE__
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
+#include "ServoOutput.h"
+#include "ServoCalibration.h"
+#include "MotionPlanner.h"
+#include "set_up.h"
+
+// Senza un nuovo jog() entro questo tempo il giunto decelera e si ferma
+#define JOG_KEEPALIVE_MS 300
+
+// Periodo del MotionTask in secondi (tempo di campionamento dei profili)
+#define MOTION_PERIOD_S (MOTION_PERIOD_MS / 1000.0f)
+
+// Classe di carico, per il modello di assorbimento (PowerBudget)
+enum LoadClass
+{
+    LOAD_LIGHT = 0,  // MG66R: polso, pinza
+    LOAD_HEAVY = 1   // 20kg: base, gomito
+};
+
+// Modalità di arresto di stopMove()
+enum StopMode
+{
+    STOP_HOLD = 0,   // Ferma subito sulla posizione effettivamente emessa
+    STOP_RAMP = 1    // Decelera entro il limite di accelerazione del giunto
+};
 
 /**
  * Classe base per tutti i servo motori
  * Supporta movimenti NON-BLOCCANTI per scheduler
+ * I modelli concreti sono Servo<Traits> (vedi Servo.h)
  */
 class ServoMotor {
 
@@ -23,32 +47,69 @@ public:
         int safeMin = -1,
         int safeMax = -1
     );
+    virtual ~ServoMotor() {}
     
 // MOVIMENTO IMMEDIATO
 
     /**
      * Muove servo istantaneamente all'angolo specificato
      */
-    void moveServo(Adafruit_PWMServoDriver& pwm, float angle);
+    void moveServo(ServoOutput& pwm, float angle);
     
     /**
      * Muove servo relativamente alla posizione attuale
      */
-    void moveRelative(Adafruit_PWMServoDriver& pwm, int delta);
+    void moveRelative(ServoOutput& pwm, int delta);
+
+    /**
+     * Scrive un pulse grezzo (usato dalla calibrazione)
+     * Il pulse viene comunque limitato a minPulse-maxPulse
+     */
+    void writePulse(ServoOutput& pwm, uint16_t pulse);
     
 // MOVIMENTO SMOOTH NON-BLOCCANTE
 
+    /**
+     * Accoda un waypoint (NON-BLOCCANTE)
+     * Il planner raccorda i waypoint consecutivi nella stessa direzione
+     * senza fermarsi, entro i limiti di velocità e accelerazione del giunto.
+     * Se il giunto sta eseguendo l'ultimo segmento in coda, il resto di
+     * quel segmento viene ripianificato per raccordarsi col nuovo.
+     * 
+     * @param targetAngle Angolo destinazione
+     * @param maxVelocity Velocità massima (gradi/s, 0 = limite del giunto)
+     * @param minDuration Durata minima da fermo a fermo (ms, 0 = nessuna)
+     * @return false se la coda è piena o il giunto è in jog
+     */
+    bool queueMove(float targetAngle, float maxVelocity = 0.0f, uint16_t minDuration = 0);
+
+    /**
+     * Accoda il tratto di questo giunto di un waypoint di più giunti
+     * (vedi JointTable::queueSync): il profilo è comune a tutti i
+     * giunti del waypoint, che partono insieme
+     * @return false se la coda è piena o il giunto è in jog
+     */
+    bool queueSyncMove(float targetAngle, const SyncProfile& sync);
+
+    /**
+     * Toglie l'ultimo waypoint accodato, se non è ancora partito
+     * (annulla un waypoint di più giunti accodato solo in parte)
+     */
+    bool dropLastMove();
+
     /**
      * Avvia movimento smooth (NON-BLOCCANTE)
-     * Da chiamare UNA VOLTA per iniziare il movimento
+     * Compatibilità: accoda un waypoint lungo almeno duration ms.
+     * Ogni segmento viene campionato a MOTION_PERIOD_MS: una sola
+     * valutazione del profilo e della calibrazione per tick
      * 
-     * @param pwm         Driver PWM
+     * @param pwm         Uscita PWM
      * @param targetAngle Angolo destinazione
      * @param duration    Durata totale (ms)
      * @param steps       Numero di step (ignorato, usa tempo)
      */
-    void startSmoothMove(
-        Adafruit_PWMServoDriver& pwm, 
+    bool startSmoothMove(
+        ServoOutput& pwm, 
         float targetAngle, 
         uint16_t duration, 
         uint16_t steps = 0  // Ignorato, compatibilità
@@ -56,31 +117,150 @@ public:
     
     /**
      * Aggiorna movimento smooth in corso
-     * Da chiamare CONTINUAMENTE dallo scheduler
+     * Da chiamare UNA VOLTA PER TICK dallo scheduler (avanza di un campione)
      * 
-     * @param pwm Driver PWM
+     * @param pwm Uscita PWM
      * @return true se movimento completato, false altrimenti
      */
-    bool updateSmoothMove(Adafruit_PWMServoDriver& pwm);
+    bool updateSmoothMove(ServoOutput& pwm);
     
     /**
-     * Ferma movimento in corso
+     * Ferma movimento in corso e svuota la coda
+     * Con STOP_HOLD il giunto resta sull'ultimo pulse scritto; con
+     * STOP_RAMP decelera nei tick successivi (isMoving() resta true
+     * fino all'arresto). In entrambi i casi lo stato interno coincide
+     * poi con l'uscita del PCA9685.
+     * 
+     * @param mode STOP_HOLD o STOP_RAMP
+     */
+    void stopMove(StopMode mode = STOP_HOLD);
+
+// JOG A VELOCITÀ COSTANTE
+
+    /**
+     * Avvia o rinnova un jog (NON-BLOCCANTE)
+     * Il giunto accelera fino a velocity entro il suo limite di
+     * accelerazione, la mantiene e decelera prima dei limiti di sicurezza.
+     * Va richiamato almeno ogni JOG_KEEPALIVE_MS, altrimenti decelera
+     * fino a fermarsi. Se c'è un movimento in corso, il jog parte dalla
+     * sua posizione e velocità attuali e la coda viene svuotata.
+     * 
+     * @param velocity Velocità con segno (gradi/s, scalata dal feed rate)
      */
-    void stopMove();
+    void jog(float velocity);
+
+    /**
+     * Rilascio del jog: decelera fino a fermarsi
+     */
+    void jogStop();
+
+    /**
+     * Restringe i limiti del jog in corso o del prossimo (es. zona senza
+     * collisioni con gli altri giunti), sempre entro i limiti di sicurezza.
+     * Torna ai limiti di sicurezza quando il jog si ferma
+     */
+    void setJogWindow(float minAngle, float maxAngle);
     
 // POSIZIONI PREDEFINITE
 
-    void moveToMin(Adafruit_PWMServoDriver& pwm);
-    void moveToMax(Adafruit_PWMServoDriver& pwm);
-    void moveToCenter(Adafruit_PWMServoDriver& pwm);
-    void moveToSafePosition(Adafruit_PWMServoDriver& pwm, int angle);
+    void moveToMin(ServoOutput& pwm);
+    void moveToMax(ServoOutput& pwm);
+    void moveToCenter(ServoOutput& pwm);
+    void moveToSafePosition(ServoOutput& pwm, int angle);
     
 // GETTERS
 
     int getCurrentAngle() const;
+
+    /**
+     * Angolo esatto corrispondente all'ultimo pulse scritto
+     */
+    float getPosition() const;
     int getChannel() const;
+
+    /**
+     * Scheda PCA9685 del canale (indice del registro in ServoOutput)
+     */
+    void setBoard(int board);
+    int getBoard() const;
     bool isMoving() const;
+
+    /**
+     * Angolo finale dell'ultimo waypoint in coda (attuale se fermo)
+     */
+    float getTargetAngle() const;
+    bool canQueueMove() const;
+    int getQueuedMoves() const;
+
+    /**
+     * Spostamento (con segno, entro i limiti di sicurezza) dalla fine
+     * della coda a targetAngle
+     */
+    float getMoveDistance(float targetAngle) const;
+
+    /**
+     * Ultimo segmento (in coda o attivo) e primo in coda
+     * @return false se non c'è o il giunto è in jog
+     */
+    bool getLastSegment(MotionSegment& segment) const;
+    bool getNextSegment(MotionSegment& segment) const;
+
+    /**
+     * true se il waypoint group è ancora in coda
+     */
+    bool hasWaypoint(uint16_t group) const;
+
+    /**
+     * Durata minima (ms) per andare da fermo a fermo fino a targetAngle,
+     * partendo dalla fine della coda
+     * @param maxVelocity Velocità di crociera (gradi/s, 0 = limite del giunto)
+     */
+    unsigned long getMinMoveTime(float targetAngle, float maxVelocity = 0.0f) const;
+
+    /**
+     * Durata minima (s) da fermo a fermo tra due angoli qualsiasi, con il
+     * feed rate attuale (stima per il dry-run degli script)
+     */
+    float getRestToRestTime(float fromAngle, float toAngle) const;
+    float getMaxVelocity() const;
+    float getMaxAccel() const;
+    bool isJogging() const;
+    float getFeedRate() const;
+
+    /**
+     * true se c'è un movimento pronto a partire da fermo
+     * (segmento in coda non ancora avviato o jog a velocità nulla)
+     */
+    bool isStarting() const;
+    int getLoadClass() const;
+
+    /**
+     * Frequenza PWM massima accettata dal servo (Hz)
+     */
+    virtual int getMaxRefresh() const;
+
+    /**
+     * Segmenti avviati dall'accensione (cambia a ogni nuovo segmento)
+     */
+    unsigned long getSegmentCount() const;
+
+    /**
+     * Tick pianificati del segmento attivo (0 se nessun segmento)
+     */
+    uint16_t getSegmentTicks() const;
+
+    /**
+     * Comandi limitati dai limiti di sicurezza dall'accensione
+     */
+    unsigned long getSaturationCount() const;
+    float getAccelLimit() const;   // Accelerazione nominale (senza scala)
+    float getAccelScale() const;
     bool isAngleSafe(int angle) const;
+    int getSafeMinAngle() const;
+    int getSafeMaxAngle() const;
+    uint16_t getMinPulse() const;
+    uint16_t getMaxPulse() const;
+    const ServoCalibration& getCalibration() const;
     String getDebugInfo() const;
     
 // SETTERS
@@ -89,10 +269,59 @@ public:
     void setSafetyEnabled(bool enabled);
     void setTrim(int trim);
 
+    /**
+     * Limiti dinamici del giunto (gradi/s, gradi/s²)
+     */
+    void setMotionLimits(float maxVelocity, float maxAccel);
+
+    /**
+     * Override di velocità (1.0 = 100%) applicato a jog e nuovi waypoint
+     */
+    void setFeedRate(float rate);
+
+    /**
+     * Log di waypoint accodati e arrivi per tutti i giunti (disattivato
+     * durante lo stream G-code, che usa la seriale per "ok"/"error:")
+     */
+    static void setMotionLog(bool enabled);
+
+// AMMISSIONE (PowerBudget)
+
+    /**
+     * Trattiene la partenza da fermo finché non viene ammessa
+     * (i movimenti già avviati non vengono interrotti)
+     */
+    void setStartHold(bool hold);
+
+    /**
+     * Trattiene la partenza di un waypoint di più giunti finché gli altri
+     * giunti non sono pronti (JointTable::holdIncompleteGroups)
+     */
+    void setSyncHold(bool hold);
+    bool isSyncHeld() const;
+
+    /**
+     * Scala l'accelerazione dei prossimi movimenti (0-1]
+     * Da usare a giunto fermo: la coda viene ripianificata
+     */
+    void setAccelScale(float scale);
+
+    /**
+     * Imposta la curva di calibrazione angolo → pulse
+     * Deve coprire lo stesso range fisico del servo
+     */
+    bool setCalibration(const ServoCalibration& cal);
+
+    /**
+     * Torna alla curva lineare nominale
+     */
+    void resetCalibration();
+
 protected:
 // VARIABILI PROTETTE (NO DUPLICATI!)
 
     // Hardware
+    int board;
     int channel;
     
     // Range fisico
@@ -107,20 +336,62 @@ protected:
     bool safetyEnabled;
     
     // Stato attuale
-    int currentAngle;
+    int currentAngle;        // position arrotondata
+    float position;          // Angolo dell'ultimo pulse emesso
     int trim;
+
+    // Curva angolo → pulse (lineare finché non calibrata)
+    ServoCalibration calibration;
     
     // Movimento smooth NON-BLOCCANTE
-    bool moving;
-    float moveStartAngle;
-    float moveTargetAngle;
-    unsigned long moveStartTime;
-    uint16_t moveDuration;
+    bool moving;             // Segmento attivo in esecuzione
+    MotionPlanner planner;   // Coda waypoint con lookahead
+    MotionProfile profile;   // Profilo del segmento attivo
+    float profilePhase;      // Tempo del profilo al tick 0 (s)
+    uint16_t moveTick;       // Tick eseguiti del segmento
+    uint16_t moveTicks;      // Tick totali del segmento
+    unsigned long segmentCount;
+    unsigned long saturationCount;
+    float feedRate;          // Override di velocità (1.0 = 100%)
+    float accelLimit;        // Accelerazione nominale (gradi/s²)
+    float accelScale;        // Scala imposta dall'ammissione
+    bool startHold;          // Partenza da fermo non ancora ammessa
+    bool syncHold;           // Waypoint di più giunti in attesa degli altri
+    int loadClass;
+
+    // Jog a velocità
+    bool jogging;
+    float jogPosition;       // Posizione comandata (gradi)
+    float jogVelocity;       // Velocità attuale con segno (gradi/s)
+    float jogTarget;         // Velocità richiesta con segno (gradi/s)
+    unsigned long jogKeepalive;
+    float jogMin;            // Limiti del jog (entro quelli di sicurezza)
+    float jogMax;
+
+    uint16_t lastPulse;      // Ultimo pulse scritto sul PCA9685
+
+    static bool motionLog;
     
 // UTILITY PROTETTE
 
-    uint16_t angleToPulse(float angle);
-    float applySafetyLimits(float angle);
+    /**
+     * Conversioni del percorso caldo: non virtuali, con i limiti dei
+     * campi (per Servo<Traits> inizializzati dalle costanti dei traits)
+     */
+    uint16_t angleToPulse(float angle) const;
+    uint16_t clampPulse(int pulse) const;
+    float applySafetyLimits(float angle) const;
+    float limitCommand(float angle);
+    bool canTakeWaypoint() const;
+    void resumeActive();
+    float samplePosition(uint16_t tick) const;
+    void beginSegment(float phase);
+    float currentVelocity() const;
+    void beginRamp();
+    void emitSample(ServoOutput& pwm, uint16_t tick);
+    void setPosition(float angle);
+    bool updateJog(ServoOutput& pwm);
+    void emitPulse(ServoOutput& pwm, uint16_t pulse);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * SERVO CALIBRATION - CURVA PIECEWISE-LINEAR PER CANALE
+ *
+ * Tabella angolo → pulse con CAL_POINTS punti equispaziati sul range fisico.
+ * Non dipende da Arduino: compilabile e testabile anche su host.
+ ******************************************************************************/
+
+#ifndef __SERVO_CALIBRATION__
+#define __SERVO_CALIBRATION__
+
+#include <stdint.h>
+
+// Numero di punti della curva (segmenti = CAL_POINTS - 1)
+#define CAL_POINTS 9
+
+/**
+ * Curva di calibrazione di un canale servo
+ * I punti sono equispaziati: l'indice del segmento si ottiene con una
+ * moltiplicazione, quindi la conversione costa quanto il vecchio map()
+ */
+class ServoCalibration {
+
+public:
+    ServoCalibration();
+
+    /**
+     * Inizializza la curva come retta (servo ideale)
+     */
+    void setLinear(int minAngle, int maxAngle, uint16_t minPulse, uint16_t maxPulse);
+
+    /**
+     * Converte angolo → pulse interpolando tra i due punti vicini
+     * Fuori range satura al primo/ultimo punto
+     */
+    uint16_t angleToPulse(float angle) const;
+
+    /**
+     * Conversione inversa pulse → angolo (curva monotona)
+     */
+    float pulseToAngle(uint16_t pulse) const;
+
+// PUNTI
+
+    float getPointAngle(int index) const;
+    uint16_t getPointPulse(int index) const;
+    void setPointPulse(int index, uint16_t pulse);
+
+// GETTERS
+
+    int getMinAngle() const;
+    int getMaxAngle() const;
+
+    /**
+     * true se la curva è strettamente monotona (crescente o decrescente)
+     */
+    bool isMonotonic() const;
+
+    /**
+     * Checksum dei punti, usato per validare i dati salvati in NVS
+     */
+    uint16_t checksum() const;
+
+private:
+    int16_t minAngle;
+    int16_t maxAngle;
+    float pointsPerDegree;  // (CAL_POINTS - 1) / (maxAngle - minAngle)
+    uint16_t pulse[CAL_POINTS];
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * SERVO HEALTH - MONITORAGGIO DEI GIUNTI E DEL BUS
+ *
+ * Aggiornato una volta per tick dopo l'uscita PWM, con costo costante
+ * (una passata sui giunti, al più una lettura analogica). Controlla:
+ *  - I2C: tick consecutivi con transazioni fallite (dopo i retry) o con
+ *    il bus in recupero nella PwmPipeline
+ *  - Tempi: durata reale di ogni segmento rispetto a quella pianificata
+ *    (tick del MotionTask in ritardo o saltati)
+ *  - Saturazione: troppi comandi limitati dai limiti di sicurezza in
+ *    una finestra
+ *  - Feedback analogico (opzionale): posizione letta lontana da quella
+ *    comandata a giunto fermo
+ * Il primo guasto viene memorizzato come ServoFault finché la macchina
+ * non lo riconosce (clearFault); i contatori restano disponibili.
+ ******************************************************************************/
+
+#ifndef __SERVO_HEALTH__
+#define __SERVO_HEALTH__
+
+#include <Arduino.h>
+#include "JointTable.h"
+#include "PwmPipeline.h"
+
+#define HEALTH_I2C_FAULT_TICKS 3        // Tick consecutivi con errori I2C
+#define HEALTH_OVERRUN_RATIO 1.5f       // Durata reale / pianificata
+#define HEALTH_OVERRUN_SLACK_MS 40      // Tolleranza fissa (2 tick)
+#define HEALTH_OVERRUN_FAULTS 3         // Segmenti in ritardo consecutivi
+#define HEALTH_WINDOW_TICKS 50          // Finestra saturazioni (1s)
+#define HEALTH_SATURATION_LIMIT 5       // Saturazioni per finestra
+#define HEALTH_FEEDBACK_TOLERANCE 8.0f  // Gradi
+#define HEALTH_FEEDBACK_FAULTS 3        // Letture errate consecutive
+
+enum ServoFaultType
+{
+    FAULT_NONE = 0,
+    FAULT_I2C = 1,          // Bus o PCA9685 non rispondono
+    FAULT_MOVE_OVERRUN = 2, // Segmenti molto più lunghi del piano
+    FAULT_SATURATION = 3,   // Comandi ripetuti oltre i limiti di sicurezza
+    FAULT_FEEDBACK = 4      // Posizione misurata diversa da quella comandata
+};
+
+/**
+ * Guasto rilevato
+ */
+struct ServoFault {
+    int type;               // ServoFaultType
+    int joint;              // Indice giunto, -1 per il bus
+    float value;            // Codice errore I2C, ms di ritardo, saturazioni o gradi di scarto
+    unsigned long time;     // millis() del rilevamento
+};
+
+class ServoHealth {
+
+public:
+    ServoHealth();
+
+    /**
+     * Feedback analogico di un giunto (angolo = offset + lettura * scale)
+     * @param pin   Pin ADC (-1 = nessun feedback)
+     */
+    void setFeedback(int joint, int pin, float scale, float offset);
+
+    /**
+     * Un tick di monitoraggio, dopo joints.update() e pwm.flush()
+     */
+    void update(const JointTable& joints, const PwmPipeline& pipeline, unsigned long now);
+
+    bool hasFault() const;
+    const ServoFault& getFault() const;
+
+    /**
+     * Guasto gestito: riparte il rilevamento (i contatori restano)
+     */
+    void clearFault();
+
+    static const char* faultName(int type);
+
+// CONTATORI
+
+    unsigned long getI2cErrors() const;
+    unsigned long getOverruns(int joint) const;
+    unsigned long getSaturations(int joint) const;
+    unsigned long getFeedbackErrors(int joint) const;
+    unsigned long getFaultCount() const;
+    unsigned long getTicks() const;
+
+private:
+    ServoFault fault;
+    unsigned long faultCount;
+    unsigned long ticks;
+
+    // I2C
+    unsigned long lastPipelineErrors;
+    unsigned long i2cErrors;
+    int i2cFailedTicks;
+
+    // Tempi dei segmenti
+    unsigned long lastSegment[MAX_JOINTS];
+    unsigned long segmentStart[MAX_JOINTS];
+    uint16_t segmentTicks[MAX_JOINTS];      // 0 = nessun segmento seguito
+    uint8_t lateSegments[MAX_JOINTS];
+    unsigned long overruns[MAX_JOINTS];
+
+    // Saturazioni
+    unsigned long windowSaturations[MAX_JOINTS];    // Conteggio a inizio finestra
+    unsigned long saturations[MAX_JOINTS];
+    int windowTick;
+
+    // Feedback
+    int feedbackPin[MAX_JOINTS];
+    float feedbackScale[MAX_JOINTS];
+    float feedbackOffset[MAX_JOINTS];
+    uint8_t feedbackMisses[MAX_JOINTS];
+    unsigned long feedbackErrors[MAX_JOINTS];
+    int feedbackJoint;
+
+    void checkI2c(const PwmPipeline& pipeline, unsigned long now);
+    void checkSegment(int joint, const ServoMotor* servo, unsigned long now);
+    void checkSaturations(const JointTable& joints, unsigned long now);
+    void checkFeedback(const JointTable& joints, unsigned long now);
+    void closeSegment(int joint, unsigned long now);
+    void raise(int type, int joint, float value, unsigned long now);
+};
+
+#endif
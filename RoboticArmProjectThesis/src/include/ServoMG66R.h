@@ -1,5 +1,5 @@
 /*******************************************************************************
- * SERVO MOTOR MG66R - CLASSE DERIVATA
+ * SERVO MOTOR MG66R - TRAITS DEL MODELLO
  * 
  * Servo ad alta coppia 11kg/cm
  * Range: 0-180°
@@ -10,31 +10,28 @@
 #ifndef __SERVO_MOTOR_MG66R__
 #define __SERVO_MOTOR_MG66R__
 
-#include "ServoBase.h"
+#include "Servo.h"
+
+struct MG66RTraits {
+    static constexpr uint16_t MIN_PULSE = 102;   // 500μs → 0°
+    static constexpr uint16_t MAX_PULSE = 512;   // 2500μs → 180°
+    static constexpr int MIN_ANGLE = 0;
+    static constexpr int MAX_ANGLE = 180;
+
+    // Limiti dinamici sotto carico (a vuoto: 0.19s/60° ≈ 315°/s)
+    static constexpr float MAX_SPEED = 240.0f;   // °/s
+    static constexpr float MAX_ACCEL = 1200.0f;  // °/s²
+
+    // Servo analogico: solo 50Hz
+    static constexpr int MAX_REFRESH_HZ = 50;
+
+    static constexpr int LOAD_CLASS = LOAD_LIGHT;
+    static constexpr const char* NAME = "ServoMotorMG66R";
+};
 
 /**
  * Servo MG66R specializzato
- * Eredita da ServoMotor
  */
-class ServoMotorMG66R : public ServoMotor {
-
-public:
-    /**
-     * Costruttore con range personalizzabile
-     * @param channel  Canale PCA9685 (0-15)
-     * @param safeMin  Limite minimo di sicurezza (default -1 = no limit)
-     * @param safeMax  Limite massimo di sicurezza (default -1 = no limit)
-     */
-    ServoMotorMG66R(
-        int channel,
-        int safeMin = -1,
-        int safeMax = -1
-    );
-    
-    /**
-     * Override per aggiungere metodi specifici MG66R
-     */
-    void calibrate();
-};
+typedef Servo<MG66RTraits> ServoMotorMG66R;
 
 #endif
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * SERVO OUTPUT - STADIO DI USCITA VERSO I PCA9685
+ *
+ * Registro delle schede PCA9685 sullo stesso bus: i giunti sono mappati
+ * su (scheda, canale). Unico punto che scrive i registri LEDn_ON/OFF:
+ * movimenti, jog, parcheggio e calibrazione passano tutti da write(),
+ * quindi ogni canale mantiene sempre il suo offset di fase (vedi
+ * PwmPhaseTable). write() aggiorna solo il frame della scheda; flush(),
+ * una volta per tick, codifica un frame per scheda a gruppi di canali
+ * consecutivi (vedi PwmFrame) e lo accoda alla PwmPipeline, che lo
+ * trasmette in background.
+ * Gli impulsi arrivano in conteggi nominali a SERVO_NOMINAL_FREQUENCY
+ * (50Hz, come le curve dei servo e le calibrazioni salvate); ogni scheda
+ * li riscala alla propria frequenza, così la durata in µs resta uguale
+ * anche con refresh più alti (servo digitali, 200-330Hz).
+ ******************************************************************************/
+
+#ifndef __SERVO_OUTPUT__
+#define __SERVO_OUTPUT__
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_PWMServoDriver.h>
+#include "PwmPhaseTable.h"
+#include "PwmFrame.h"
+#include "PwmPipeline.h"
+
+#define SERVO_NOMINAL_FREQUENCY 50        // Frequenza dei conteggi di impulso
+#define PCA9685_OSCILLATOR_HZ 25000000.0f // Come Adafruit_PWMServoDriver
+
+class ServoOutput {
+
+public:
+    ServoOutput();
+
+    /**
+     * Verifica e inizializza un PCA9685 e lo aggiunge al registro
+     * (anche se non risponde, vedi isOnline)
+     * @param address   Indirizzo I2C
+     * @param frequency Frequenza PWM (Hz)
+     * @return Indice della scheda, -1 se il registro è pieno
+     */
+    int addBoard(uint8_t address, float frequency);
+
+    /**
+     * Cambia la frequenza PWM di una scheda e riscrive i canali attivi
+     * con gli impulsi riscalati. Solo prima di startPipeline().
+     * @return false se la pipeline è già avviata
+     */
+    bool setFrequency(int board, float frequency);
+
+    /**
+     * Frequenza effettiva (dopo l'arrotondamento del prescaler)
+     */
+    float getFrequency(int board) const;
+    unsigned long getPeriodMicros(int board) const;
+
+    /**
+     * Frequenza effettiva del PCA9685 per una frequenza richiesta
+     */
+    static float actualFrequency(float frequency);
+
+    /**
+     * Avvia l'invio asincrono (dopo aver aggiunto tutte le schede)
+     * Da qui in poi Wire è usato solo dal task della pipeline
+     */
+    bool startPipeline();
+
+    /**
+     * Registra un canale servo e gli assegna uno slot di fase
+     * I canali già scritti vengono riscritti con il nuovo offset
+     */
+    void addChannel(int board, int channel);
+
+    /**
+     * Aggiorna l'impulso di un canale nel frame della sua scheda
+     * @param board   Scheda (indice di addBoard)
+     * @param channel Canale PCA9685 (0-15)
+     * @param pulse   Durata dell'impulso (conteggi su 4096 a 50Hz)
+     */
+    void write(int board, int channel, uint16_t pulse);
+
+    /**
+     * Accoda i frame modificati di tutte le schede in un batch
+     * Non attende il bus: se i buffer sono occupati i canali restano
+     * da inviare e partono al flush successivo
+     * @return Byte accodati per il bus
+     */
+    int flush();
+
+    int getBoardCount() const;
+
+    /**
+     * true se la scheda ha risposto alla verifica di addBoard()
+     */
+    bool isOnline(int board) const;
+    uint8_t getAddress(int board) const;
+    uint16_t getOnTime(int board, int channel) const;
+    const PwmPhaseTable& getPhases(int board) const;
+    int getLastFlushBytes() const;
+    const PwmPipeline& getPipeline() const;
+
+private:
+    struct Board {
+        uint8_t address;
+        bool online;
+        Adafruit_PWMServoDriver driver;
+        PwmPhaseTable phases;
+        PwmFrame frame;
+        float frequency;                // Effettiva
+        uint32_t scale;                 // Conteggi / conteggi nominali (Q16)
+        uint16_t pulses[PWM_CHANNELS];  // Ultimo impulso scritto, nominale (0 = mai)
+    };
+
+    Board boards[MAX_BOARDS];
+    int boardCount;
+    int lastFlushBytes;
+    PwmPipeline pipeline;
+    unsigned long reportedErrors;
+
+    void reportErrors();
+
+    bool isValid(int board, int channel) const;
+};
+
+#endif
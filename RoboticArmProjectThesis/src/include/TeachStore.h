@@ -0,0 +1,106 @@
+/*******************************************************************************
+ * TEACH STORE - REGISTRAZIONI TEACH SU LITTLEFS
+ *
+ * Le scritture e le letture in flash possono fermare il chiamante per
+ * decine di ms (cancellazione dei settori): le fa un task FreeRTOS
+ * dedicato (core 0, sotto la PwmPipeline), mai il tick di movimento.
+ * Tra il tick e il task c'è un TrajectoryRing:
+ *   registrazione: il tick codifica un campione per tick nel ring, il
+ *                  task lo scarica nel file a blocchi
+ *   riproduzione:  il task riempie il ring dal file a blocchi, il tick
+ *                  decodifica un campione per tick
+ * Il file non viene mai caricato tutto in RAM. Se il ring si riempie
+ * (flash troppo lenta) la registrazione si interrompe; se si svuota
+ * durante la riproduzione il braccio resta fermo finché arrivano dati.
+ * File in TEACH_DIRECTORY/<nome>.tch (formato in TrajectoryCodec.h).
+ ******************************************************************************/
+
+#ifndef __TEACH_STORE__
+#define __TEACH_STORE__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "TrajectoryCodec.h"
+
+#define TEACH_DIRECTORY "/teach"
+#define TEACH_NAME_LENGTH 24
+#define TEACH_RING_BYTES 4096          // ~4s di jog con la flash ferma
+#define TEACH_CHUNK_BYTES 256          // Blocco per accesso al file
+#define TEACH_STORE_PERIOD_MS 10
+#define TEACH_STORE_STACK 4096
+#define TEACH_STORE_PRIORITY 1         // Sotto la PwmPipeline
+#define TEACH_STORE_CORE 0
+
+enum TeachStoreMode
+{
+    STORE_IDLE = 0,
+    STORE_RECORDING = 1,   // Il task scarica il ring nel file
+    STORE_PLAYING = 2      // Il task riempie il ring dal file
+};
+
+class TeachStore {
+
+public:
+    TeachStore();
+
+    /**
+     * Monta LittleFS (formattato se non valido) e avvia il task
+     * @return false se il filesystem non è disponibile
+     */
+    bool begin();
+    bool isReady() const;
+
+    /**
+     * Avvia la scrittura di una registrazione: il chiamante scrive nel
+     * ring (getRing) e lo chiude alla fine
+     * @param name Nome senza estensione (max TEACH_NAME_LENGTH)
+     * @return false se il task è occupato o il nome non è valido
+     */
+    bool record(const char* name);
+
+    /**
+     * Avvia la lettura: il chiamante legge dal ring, che viene chiuso a
+     * fine file (subito se il file non esiste, vedi getLastError)
+     */
+    bool play(const char* name);
+
+    /**
+     * Interrompe la riproduzione (il file viene chiuso dal task)
+     */
+    void cancel();
+
+    int getMode() const;
+    TrajectoryRing& getRing();
+
+// ESITO (scritto dal task)
+
+    unsigned long getSaved() const;         // Registrazioni completate
+    unsigned long getFileBytes() const;     // Byte dell'ultimo file
+    const char* getLastError() const;       // nullptr se nessun errore
+
+private:
+    uint8_t storage[TEACH_RING_BYTES];
+    TrajectoryRing ring;
+    char path[sizeof(TEACH_DIRECTORY) + TEACH_NAME_LENGTH + 5];
+    File file;
+    bool fileOpen;
+    bool ready;
+    TaskHandle_t task;
+
+    volatile uint8_t mode;
+    volatile bool cancelled;
+    volatile unsigned long saved;
+    volatile unsigned long fileBytes;
+    const char* volatile lastError;
+
+    bool start(const char* name, uint8_t newMode);
+    static void taskEntry(void* param);
+    void run();
+    void drainToFile();
+    void fillFromFile();
+    void finish(const char* error);
+};
+
+#endif
@@ -0,0 +1,214 @@
+/*******************************************************************************
+ * TRAJECTORY CODEC - FORMATO COMPATTO DELLE REGISTRAZIONI TEACH
+ *
+ * Una registrazione è un campione dei setpoint dei giunti per tick di
+ * movimento, in decimi di grado: i tempi sono impliciti (un campione
+ * ogni periodMs dell'intestazione), anche le pause.
+ * Flusso di byte:
+ *   intestazione (TRAJ_HEADER_BYTES)
+ *   KEY    0x81 + int16 LE per giunto (primo campione, assoluto)
+ *   DELTA  0x80 + maschera varint + zigzag varint per giunto della
+ *          maschera (differenza dal campione precedente)
+ *   REPEAT 0x00-0x7F: ripete l'ultimo DELTA (tag + 1) volte
+ *   END    0xFF
+ * Pause e tratti a velocità costante diventano un DELTA e dei REPEAT:
+ * un jog di qualche secondo occupa pochi byte.
+ * Encoder e decoder lavorano su flussi (TrajectorySink/Source): in
+ * firmware un TrajectoryRing tra il tick e il task che scrive o legge
+ * la flash, quindi il file non viene mai caricato tutto in RAM.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __TRAJECTORY_CODEC__
+#define __TRAJECTORY_CODEC__
+
+#include <stdint.h>
+
+#define TRAJ_MAX_JOINTS 16
+#define TRAJ_UNITS_PER_DEG 10          // Risoluzione dei campioni
+#define TRAJ_VERSION 1
+#define TRAJ_HEADER_BYTES 8
+
+#define TRAJ_TAG_REPEAT_MAX 0x7F       // Tag 0x00-0x7F: REPEAT
+#define TRAJ_TAG_DELTA 0x80
+#define TRAJ_TAG_KEY 0x81
+#define TRAJ_TAG_END 0xFF
+#define TRAJ_MAX_REPEAT (TRAJ_TAG_REPEAT_MAX + 1)
+
+// Record più lungo: DELTA con maschera a 3 byte e 3 byte per giunto
+#define TRAJ_MAX_RECORD_BYTES (1 + 3 + 3 * TRAJ_MAX_JOINTS)
+#define TRAJ_DECODE_BUFFER 64
+
+enum TrajectoryStatus {
+    TRAJ_SAMPLE = 0,   // Campione disponibile
+    TRAJ_WAIT = 1,     // Dati non ancora arrivati (riprovare al tick dopo)
+    TRAJ_END = 2,      // Fine della registrazione
+    TRAJ_ERROR = 3     // Flusso non valido
+};
+
+/**
+ * Intestazione: "TCH", versione, giunti, periodo, risoluzione, riservato
+ */
+struct TrajectoryHeader {
+    uint8_t jointCount;
+    uint8_t periodMs;
+    uint8_t unitsPerDeg;
+};
+
+/**
+ * Destinazione dei byte codificati
+ */
+class TrajectorySink {
+public:
+    /**
+     * Scrive tutto il blocco o niente
+     * @return false se non c'è spazio
+     */
+    virtual bool write(const uint8_t* data, int length) = 0;
+    virtual ~TrajectorySink() {}
+};
+
+/**
+ * Origine dei byte da decodificare
+ */
+class TrajectorySource {
+public:
+    /**
+     * @return Byte letti (0 = nessun dato disponibile ora)
+     */
+    virtual int read(uint8_t* data, int length) = 0;
+
+    /**
+     * true quando non arriveranno altri byte oltre a quelli già scritti
+     */
+    virtual bool isClosed() const = 0;
+    virtual ~TrajectorySource() {}
+};
+
+/**
+ * Buffer circolare a produttore e consumatore singoli (es. tick e task
+ * della flash su core diversi): indici scritti ognuno da un solo lato
+ */
+class TrajectoryRing : public TrajectorySink, public TrajectorySource {
+
+public:
+    TrajectoryRing(uint8_t* buffer, int capacity);
+
+    /**
+     * Svuota e riapre (solo con entrambi i lati fermi)
+     */
+    void reset();
+
+    bool write(const uint8_t* data, int length) override;
+    int read(uint8_t* data, int length) override;
+
+    /**
+     * Lato produttore: nessun altro byte in arrivo
+     */
+    void close();
+    bool isClosed() const override;
+
+    int available() const;
+    int space() const;
+
+private:
+    uint8_t* buffer;
+    int capacity;
+    volatile int head;       // Scritto dal produttore
+    volatile int tail;       // Scritto dal consumatore
+    volatile bool closed;
+};
+
+class TrajectoryEncoder {
+
+public:
+    TrajectoryEncoder();
+
+    /**
+     * Scrive l'intestazione e prepara una nuova registrazione
+     * @return false se la sink è piena o l'intestazione non è valida
+     */
+    bool begin(TrajectorySink* sink, const TrajectoryHeader& header);
+
+    /**
+     * Aggiunge un campione (header.jointCount valori)
+     * @return false se la sink è piena: la registrazione va chiusa
+     */
+    bool add(const int16_t sample[]);
+
+    /**
+     * Scrive i REPEAT in sospeso e il record END
+     */
+    bool finish();
+
+    unsigned long getSamples() const;
+    unsigned long getBytes() const;
+
+private:
+    TrajectorySink* sink;
+    int jointCount;
+    int16_t previous[TRAJ_MAX_JOINTS];
+    int32_t delta[TRAJ_MAX_JOINTS];
+    bool hasDelta;
+    int repeats;                // REPEAT in sospeso
+    unsigned long samples;
+    unsigned long bytes;
+
+    bool emit(const uint8_t* data, int length);
+    bool flushRepeats();
+};
+
+class TrajectoryDecoder {
+
+public:
+    TrajectoryDecoder();
+
+    /**
+     * Nuova lettura: l'intestazione arriva con i primi byte
+     */
+    void reset(TrajectorySource* source);
+
+    /**
+     * Campione successivo (con pause e REPEAT espansi)
+     * @param sample header.jointCount valori
+     * @return TrajectoryStatus
+     */
+    int next(int16_t sample[]);
+
+    bool hasHeader() const;
+    const TrajectoryHeader& getHeader() const;
+
+    /**
+     * true se il flusso è finito senza record END (registrazione interrotta)
+     */
+    bool isTruncated() const;
+    unsigned long getSamples() const;
+
+// CONVERSIONI
+
+    static int16_t quantize(float degrees);
+    static float toDegrees(int16_t units);
+
+private:
+    TrajectorySource* source;
+    TrajectoryHeader header;
+    bool headerRead;
+    int status;                 // Stato finale (TRAJ_SAMPLE = in corso)
+    bool truncated;
+    int16_t current[TRAJ_MAX_JOINTS];
+    int32_t delta[TRAJ_MAX_JOINTS];
+    bool started;
+    int repeats;                // Campioni ancora da generare con delta
+    unsigned long samples;
+
+    uint8_t buffer[TRAJ_DECODE_BUFFER];
+    int length;
+
+    void fill();
+    void consume(int count);
+    int parseHeader();
+    int parseRecord();
+    static int readVarint(const uint8_t* data, int length, uint32_t& value);
+};
+
+#endif
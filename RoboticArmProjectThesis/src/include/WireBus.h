@@ -0,0 +1,35 @@
+/*******************************************************************************
+ * WIRE BUS - I2cBus SU Wire E GPIO DELL'ESP32
+ *
+ * Transazioni con Wire; per il bus-clear il driver viene scollegato e
+ * SCL pilotata a mano (open drain) leggendo SDA, poi STOP e Wire.begin()
+ * con il clock originale.
+ ******************************************************************************/
+
+#ifndef __WIRE_BUS__
+#define __WIRE_BUS__
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "I2cLink.h"
+
+#define I2C_CLEAR_HALF_PERIOD_US 5   // 100kHz durante il bus-clear
+
+class WireBus : public I2cBus {
+
+public:
+    WireBus(int sdaPin, int sclPin, uint32_t clock);
+
+    uint8_t transmit(uint8_t address, const uint8_t* data, int length) override;
+    bool isSdaLow() override;
+    void releasePins() override;
+    void clockPulse() override;
+    void reattach() override;
+
+private:
+    int sdaPin;
+    int sclPin;
+    uint32_t clock;
+};
+
+#endif
@@ -13,6 +13,7 @@
 //Pin I2C ESP3
 #define SDA_PIN 21 // pin SDA
 #define SCL_PIN 22 // pin SCL
+#define I2C_CLOCK_HZ 400000
 
 //LED e pulsanti
 #define LED_GREEN 16        // GPIO16 → LED verde (stato OK)
@@ -20,8 +21,19 @@
 #define BUTTON_WHITE_PIN 14 // GPIO14 → pulsante bianco (start/safe)
 #define BUTTON_BLUE_PIN 12  // GPIO12 → pulsante blu (stop/emergency)
 
-//Indirizzo I2C del driver PCA9685
-#define PCA9685_ADDRESS 0x40
+//Indirizzi I2C dei driver PCA9685 (scheda 0, 1, ...)
+#define PCA9685_ADDRESSES {0x40}
+
+//Frequenza PWM delle schede (Hz): 50 per servo analogici, 200-330 per
+//schede con soli servo digitali (limitata al minimo dei servo collegati)
+#define SERVO_PWM_FREQUENCY 50
+
+//Allineamento al periodo PWM: canale di riferimento del PCA9685 (scheda 0)
+//collegato a un GPIO. -1 = allineamento disattivato. Per restare agganciati
+//il periodo PWM deve dividere MOTION_PERIOD_MS (50, 100, 200, 250Hz)
+#define PWM_SYNC_PIN -1
+#define PWM_SYNC_CHANNEL 15
+#define PWM_SYNC_LEAD_US 1500   // Anticipo del frame sul fronte (bus + margine)
 
 //Parametri servo 
 #define SERVOMIN 102 
@@ -29,4 +41,7 @@
 #define SERVOMID 307 
 #define SERVO_TRIM 0
 
+//Periodo del MotionTask (50Hz, come il PWM dei servo)
+#define MOTION_PERIOD_MS 20
+
 #endif
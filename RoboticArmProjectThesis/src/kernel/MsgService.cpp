@@ -7,17 +7,17 @@ MsgServiceClass MsgService;
 
 bool MsgServiceClass::isMsgAvailable()
 {
-  return msgAvailable;
+  return count > 0;
 }
 
 Msg *MsgServiceClass::receiveMsg()
 {
-  if (msgAvailable)
+  if (count > 0)
   {
-    Msg *msg = currentMsg;
-    msgAvailable = false;
-    currentMsg = NULL;
-    content = "";
+    Msg *msg = queue[head];
+    queue[head] = NULL;
+    head = (head + 1) % MSG_QUEUE_SIZE;
+    count--;
     return msg;
   }
   else
@@ -26,13 +26,26 @@ Msg *MsgServiceClass::receiveMsg()
   }
 }
 
+bool MsgServiceClass::enqueue(const String &content)
+{
+  if (count == MSG_QUEUE_SIZE)
+  {
+    dropped++;
+    return false;
+  }
+  queue[(head + count) % MSG_QUEUE_SIZE] = new Msg(content);
+  count++;
+  return true;
+}
+
 void MsgServiceClass::init()
 {
   Serial.begin(115200);
-  content.reserve(256);
+  content.reserve(MSG_MAX_LENGTH);
   content = "";
-  currentMsg = NULL;
-  msgAvailable = false;
+  head = 0;
+  count = 0;
+  dropped = 0;
   Serial.println("Msg");
 }
 
@@ -49,10 +62,10 @@ void serialEvent()
     char ch = (char)Serial.read();
     if (ch == '\n')
     {
-      MsgService.currentMsg = new Msg(content);
-      MsgService.msgAvailable = true;
+      MsgService.enqueue(content);
+      content = "";
     }
-    else
+    else if (ch != '\r' && content.length() < MSG_MAX_LENGTH)
     {
       content += ch;
     }
@@ -61,18 +74,14 @@ void serialEvent()
 
 bool MsgServiceClass::isMsgAvailable(Pattern &pattern)
 {
-  return (msgAvailable && pattern.match(*currentMsg));
+  return (count > 0 && pattern.match(*queue[head]));
 }
 
 Msg *MsgServiceClass::receiveMsg(Pattern &pattern)
 {
-  if (msgAvailable && pattern.match(*currentMsg))
+  if (isMsgAvailable(pattern))
   {
-    Msg *msg = currentMsg;
-    msgAvailable = false;
-    currentMsg = NULL;
-    content = "";
-    return msg;
+    return receiveMsg();
   }
   else
   {
@@ -21,15 +21,25 @@ public:
   virtual boolean match(const Msg& m) = 0;  
 };
 
+/* righe complete non ancora lette: uno stream G-code ne invia
+   diverse tra due letture (vedi GcodeStream) */
+#define MSG_QUEUE_SIZE 24
+#define MSG_MAX_LENGTH 256
+
 class MsgServiceClass {
     
 public: 
   
-  Msg* currentMsg;
-  bool msgAvailable;
+  Msg* queue[MSG_QUEUE_SIZE];
+  int head;
+  int count;
+  unsigned long dropped;
 
   void init();  
 
+  /* chiamato da serialEvent a fine riga; false se la coda è piena */
+  bool enqueue(const String& content);
+
   bool isMsgAvailable();
   Msg* receiveMsg();
 
@@ -21,6 +21,10 @@ bool Scheduler::addTask(Task* task) {
     }
 }
 
+void Scheduler::adjustPhase(long delta) {
+    timer.shift(delta);
+}
+
 void Scheduler::schedule() {
     timer.waitForNextTick();
     // Serial.println("here");
@@ -15,6 +15,9 @@ class Scheduler {
     void init(int basePeriod);
     virtual bool addTask(Task* task);
     virtual void schedule();
+
+    /* sposta la fase del tick base di delta ms (> 0 = più tardi) */
+    void adjustPhase(long delta);
 };
 
 #endif
\ No newline at end of file
@@ -23,3 +23,5 @@ unsigned long Timer::deltaOrZero() {
 }
 
 void Timer::resetTimer() { t0 = millis(); }
+
+void Timer::shift(long delta) { t0 += delta; }
@@ -14,6 +14,9 @@ class Timer {
     void waitForNextTick();
     bool isPeriodPassed();
     void resetTimer();
+
+    /* sposta il prossimo tick di delta ms (> 0 = più tardi) */
+    void shift(long delta);
 };
 
 #endif
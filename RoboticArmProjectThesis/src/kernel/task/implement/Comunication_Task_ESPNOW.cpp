@@ -17,7 +17,8 @@ CommunicationTask::CommunicationTask(
     lastMessageTime(0),
     connected(false),
     messagesReceived(0),
-    messagesFailed(0)
+    messagesFailed(0),
+    framesCorrupt(0)
 {
     instance = this;
 }
@@ -74,6 +75,46 @@ void CommunicationTask::handleMessage(
         }
     }
     
+    // Frame binario: verificato qui, applicato dal MotionTask
+    if (ArmFrameCodec::isFrame(data, len)) {
+        handleFrame(data, len);
+        return;
+    }
+
+    // Testo: comandi senza frame (SCRIPT, TEACH, MOVE, ...) e jog di un
+    // controller compilato con ARM_FRAME_TEXT_COMPAT = 1
+    handleText(data, len);
+}
+
+void CommunicationTask::handleFrame(const uint8_t* data, int len) {
+    ArmFrame frame;
+    int result = ArmFrameCodec::decode(data, len, frame);
+
+    if (result != FRAME_OK) {
+        framesCorrupt++;
+        messagesFailed++;
+        Serial.printf("Frame scartato: %s\n", ArmFrameCodec::errorName(result));
+        return;
+    }
+
+    if (!tracker.accept(frame) || frame.type == FRAME_HEARTBEAT) {
+        return;
+    }
+
+    // Log ridotto
+    if (messagesReceived % 10 == 0) {
+        Serial.printf(" RX [%d]: frame #%u, maschera 0x%03X\n", messagesReceived, frame.sequence, frame.mask);
+    }
+
+    if (!machine->pushFrame(frame)) {
+        messagesFailed++;
+        Serial.println("⚠️ Coda frame piena!");
+    }
+
+    startWorkingIfIdle();
+}
+
+void CommunicationTask::handleText(const uint8_t* data, int len) {
     // Converti dati in String
     String message = "";
     for (int i = 0; i < len && i < 128; i++) {
@@ -100,11 +141,15 @@ void CommunicationTask::handleMessage(
             Serial.println("⚠️ Coda piena!");
         }
         
-        // Avvia working se necessario
-        if (machine->getCurrentState() == STATE_CONNECTED || 
-            machine->getCurrentState() == STATE_IDLE) {
-            machine->startWorking();
-        }
+        startWorkingIfIdle();
+    }
+}
+
+void CommunicationTask::startWorkingIfIdle() {
+    // Avvia working se necessario
+    if (machine->getCurrentState() == STATE_CONNECTED || 
+        machine->getCurrentState() == STATE_IDLE) {
+        machine->startWorking();
     }
 }
 
@@ -124,6 +169,9 @@ void CommunicationTask::tick() {
             
             machine->connectionLost();
             lastMessageTime = now;
+
+            // Il controller può essersi riavviato nel frattempo
+            tracker.reset();
         }
     }
     
@@ -134,6 +182,8 @@ void CommunicationTask::tick() {
         Serial.printf("Status:    %s\n", connected ? "Connected" : "Disconnected");
         Serial.printf("Received:  %d messages\n", messagesReceived);
         Serial.printf("Failed:    %d messages\n", messagesFailed);
+        Serial.printf("Frames:    %lu corrotti, %lu persi, %lu duplicati\n",
+            framesCorrupt, tracker.getLost(), tracker.getDuplicates());
         Serial.printf("Last msg:  %lu ms ago\n", now - lastMessageTime);
         Serial.println();
         
@@ -5,11 +5,11 @@
 // COSTRUTTORE
 
 
-MotionTask::MotionTask(RoboticArmMachine* machine)
+MotionTask::MotionTask(RoboticArmMachine* machine, Scheduler* scheduler)
     : machine(machine),
+      scheduler(scheduler),
       commandsProcessed(0),
-      commandsFailed(0),
-      lastCommandTime(0)
+      commandsFailed(0)
 {
 }
 
@@ -23,47 +23,52 @@ void MotionTask::tick() {
 
     
     machine->updateServoMovements();
-    
-
-    // 2. Processa comandi dalla coda
 
-    
-    unsigned long now = millis();
-    
-    // Throttling
-    if (now - lastCommandTime < COMMAND_INTERVAL) {
-        return;
-    }
-    
-    // Se non ci sono comandi, esci
-    if (!machine->hasCommands()) {
-        return;
-    }
-    
-    // Se servo ancora in movimento, aspetta
-    if (machine->isAnyServoMoving()) {
-        return;
+    // Tick agganciato al periodo PWM (correzione di al più 1ms per tick)
+    if (scheduler != nullptr) {
+        scheduler->adjustPhase(machine->getOutputPhaseCorrection());
     }
     
 
-    // 3. Estrai e esegui comando
+    // 2. Frame binari ESP-NOW: jog e rilasci di tutti i pulsanti insieme
+
+    machine->processFrames();
+
+
+    // 3. Processa comandi dalla coda
 
     
-    String cmd = machine->popCommand();
-    
-    if (cmd.length() > 0) {
-        Serial.printf("Esecuzione: \"%s\"\n", cmd.c_str());
-        
-        bool success = machine->executeCommand(cmd);
+    for (int i = 0; i < MAX_COMMANDS_PER_TICK; i++) {
+
+        // Se non ci sono comandi, esci
+        if (!machine->hasCommands()) {
+            return;
+        }
         
-        if (success) {
-            commandsProcessed++;
-        } else {
-            commandsFailed++;
-            Serial.println("Comando fallito");
+        // Se le code dei giunti sono piene, aspetta
+        // (non serve attendere la fine del movimento: il planner raccorda)
+        if (!machine->canAcceptMotion()) {
+            return;
         }
         
-        lastCommandTime = now;
+
+        // 4. Estrai e esegui comando
+
+        
+        String cmd = machine->popCommand();
+        
+        if (cmd.length() > 0) {
+            Serial.printf("Esecuzione: \"%s\"\n", cmd.c_str());
+            
+            bool success = machine->executeCommand(cmd);
+            
+            if (success) {
+                commandsProcessed++;
+            } else {
+                commandsFailed++;
+                Serial.println("Comando fallito");
+            }
+        }
     }
     
-}
\ No newline at end of file
+}
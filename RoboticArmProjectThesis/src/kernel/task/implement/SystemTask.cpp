@@ -1,4 +1,5 @@
 #include "../include/SystemTask.h"
+#include "../../MsgService.h"
 
 
 SystemTask::SystemTask(RoboticArmMachine* machine)
@@ -27,11 +28,34 @@ void SystemTask::tick() {
     
     if (machine->wasButtonBluePressed()) {
         Serial.println("Pulsante BLU");
+        machine->clearCommands();
         if (machine->getCurrentState() == STATE_WORKING) {
-            machine->stopWorking();
-            machine->clearCommands();
+            machine->stopWorking();  // exitWorking() ferma in rampa
+        }
+        else {
+            machine->stopAllServos(STOP_RAMP);
+        }
+    }
+
+    // Righe da seriale: il G-code va allo stream (risposta "ok"/"error:"
+    // per riga), STATUS stampa subito i contatori, il resto va alla coda
+    // dei comandi ESP-NOW (es. "SCRIPT RUN demo")
+    while (MsgService.isMsgAvailable()) {
+        Msg* msg = MsgService.receiveMsg();
+        String line = msg->getContent();
+        delete msg;
+        line.trim();
+
+        if (GcodeStream::isGcode(line.c_str())) {
+            if (!machine->pushGcode(line.c_str())) {
+                Serial.println("error:buffer pieno");
+            }
+        }
+        else if (line == "STATUS" || line == "DEBUG") {
+            Serial.print(machine->getDebugInfo());
+        }
+        else if (line.length() > 0) {
+            machine->pushCommand(line);
         }
     }
-    
-    
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "RoboticArmMachine.h"
 #include <esp_now.h>
 #include <WiFi.h>
+#include <ArmFrame.h>
 
 class CommunicationTask : public Task {
 public:
@@ -37,6 +38,8 @@ public:
      */
     int getMessagesReceived() const { return messagesReceived; }
     int getMessagesFailed() const { return messagesFailed; }
+    unsigned long getFramesCorrupt() const { return framesCorrupt; }
+    const ArmFrameTracker& getTracker() const { return tracker; }
     bool isConnected() const { return connected; }
 
 private:
@@ -47,6 +50,14 @@ private:
     
     int messagesReceived;
     int messagesFailed;
+
+    // Frame binari (vedi ArmFrame.h)
+    ArmFrameTracker tracker;
+    unsigned long framesCorrupt;
+    
+    void handleFrame(const uint8_t* data, int len);
+    void handleText(const uint8_t* data, int len);
+    void startWorkingIfIdle();
     
     static CommunicationTask* instance;
 };
@@ -4,10 +4,14 @@
 
 #include "../include/Task.h"
 #include "RoboticArmMachine.h"
+#include "kernel/Scheduler.h"
 
 class MotionTask : public Task {
 public:
-    MotionTask(RoboticArmMachine* machine);
+    /**
+     * @param scheduler Se presente, la fase del tick segue il periodo PWM
+     */
+    MotionTask(RoboticArmMachine* machine, Scheduler* scheduler = nullptr);
     
     void tick() override;
     
@@ -16,12 +20,13 @@ public:
 
 private:
     RoboticArmMachine* machine;
+    Scheduler* scheduler;
     
     int commandsProcessed;
     int commandsFailed;
     
-    unsigned long lastCommandTime;
-    const unsigned long COMMAND_INTERVAL = 100;  // Min 100ms tra comandi
+    // Jog e waypoint non bloccano: si smaltisce la coda senza throttling
+    const int MAX_COMMANDS_PER_TICK = 4;
 };
 
 #endif
\ No newline at end of file
@@ -22,6 +22,8 @@ SystemTask* systemTask;
 
 
 void setup() {
+    // Spazio per una raffica di righe G-code tra due letture (vedi GcodeStream)
+    Serial.setRxBufferSize(1024);
     Serial.begin(115200);
     delay(1000);
 
@@ -62,8 +64,8 @@ void setup() {
     Serial.println("CommunicationTask aggiunto (100ms)");
 
     // Motion Task - ogni 20ms (stessa frequenza base)
-    motionTask = new MotionTask(machine);
-    motionTask->init(20);  // 20ms period (50Hz servo)
+    motionTask = new MotionTask(machine, &scheduler);
+    motionTask->init(MOTION_PERIOD_MS);  // 20ms period (50Hz servo)
     scheduler.addTask(motionTask);
     Serial.println("MotionTask aggiunto (20ms)");
     
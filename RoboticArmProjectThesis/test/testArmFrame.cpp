@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * TEST HOST: FRAME BINARI ESP-NOW
+ *
+ * Codifica e decodifica dei frame di jog e heartbeat, dimensioni rispetto
+ * al vecchio testo, rilevamento di frame troncati, corrotti (ogni bit
+ * invertito) o di un'altra versione, e sequenza lato ricevitore
+ * (duplicati, frame persi, riavvio del controller).
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -I../shared/ArmFrame test/testArmFrame.cpp ../shared/ArmFrame/ArmFrame.cpp \
+ *       -o /tmp/testArmFrame && /tmp/testArmFrame
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "ArmFrame.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+static ArmFrame makeJog(uint8_t sequence)
+{
+    ArmFrame frame = {};
+    frame.type = FRAME_JOG;
+    frame.sequence = sequence;
+    frame.mask = (1 << 0) | (1 << 1) | (1 << ARM_FRAME_AXIS_BIT(2));
+    frame.values[0] = -100;                       // "Base SX"
+    frame.values[1] = 0;                          // "Elbow STOP"
+    frame.values[ARM_FRAME_AXIS_BIT(2)] = 100;    // "CJOG Z+"
+    return frame;
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testRoundTrip()
+{
+    ArmFrame frame = makeJog(42);
+    uint8_t buffer[ARM_FRAME_MAX_BYTES];
+    int length = ArmFrameCodec::encode(frame, buffer, sizeof(buffer));
+    check(length == ARM_FRAME_HEADER_BYTES + 3 + 1, "tre valori: 11 byte");
+    check(ArmFrameCodec::isFrame(buffer, length), "riconosciuto come frame");
+
+    ArmFrame decoded;
+    check(ArmFrameCodec::decode(buffer, length, decoded) == FRAME_OK, "decodificato");
+    check(decoded.type == FRAME_JOG && decoded.sequence == 42 && decoded.mask == frame.mask,
+          "intestazione identica");
+    check(decoded.values[0] == -100 && decoded.values[1] == 0 && decoded.values[ARM_FRAME_AXIS_BIT(2)] == 100,
+          "velocità identiche");
+    check(decoded.values[2] == 0 && decoded.values[3] == 0, "valori fuori maschera a zero");
+
+    ArmFrame pair = {};
+    pair.type = FRAME_JOG;
+    pair.mask = (1 << 0) | (1 << 1);
+    pair.values[0] = -100;
+    pair.values[1] = 100;
+    const char* text = "Base SX Elbow DX";
+    check(ArmFrameCodec::encode(pair, buffer, sizeof(buffer)) == 10 && 10 < (int)strlen(text) + 1,
+          "due giunti: 10 byte contro 17 del testo");
+
+    ArmFrame heartbeat = {};
+    heartbeat.type = FRAME_HEARTBEAT;
+    length = ArmFrameCodec::encode(heartbeat, buffer, sizeof(buffer));
+    check(length == ARM_FRAME_HEADER_BYTES + 1 && ArmFrameCodec::decode(buffer, length, decoded) == FRAME_OK &&
+          decoded.type == FRAME_HEARTBEAT, "heartbeat senza valori");
+
+    check(ArmFrameCodec::encode(frame, buffer, 8) == 0, "buffer troppo piccolo");
+    check(!ArmFrameCodec::isFrame((const uint8_t*)"Base SX", 8), "il testo non è un frame");
+}
+
+static void testCorruption()
+{
+    ArmFrame frame = makeJog(7);
+    uint8_t buffer[ARM_FRAME_MAX_BYTES];
+    int length = ArmFrameCodec::encode(frame, buffer, sizeof(buffer));
+    ArmFrame decoded;
+
+    // Ogni singolo bit invertito viene rifiutato
+    bool allRejected = true;
+    for (int byte = 0; byte < length; byte++) {
+        for (int bit = 0; bit < 8; bit++) {
+            buffer[byte] ^= (uint8_t)(1 << bit);
+            allRejected = allRejected && ArmFrameCodec::decode(buffer, length, decoded) != FRAME_OK;
+            buffer[byte] ^= (uint8_t)(1 << bit);
+        }
+    }
+    check(allRejected, "ogni bit invertito rifiutato");
+
+    check(ArmFrameCodec::decode(buffer, length - 1, decoded) == FRAME_BAD_LENGTH, "frame troncato");
+    check(ArmFrameCodec::decode(buffer, 4, decoded) == FRAME_TOO_SHORT, "frame cortissimo");
+
+    uint8_t other[ARM_FRAME_MAX_BYTES];
+    memcpy(other, buffer, length);
+    other[1] = ARM_FRAME_VERSION + 1;
+    other[length - 1] = ArmFrameCodec::crc8(other, length - 1);
+    check(ArmFrameCodec::decode(other, length, decoded) == FRAME_BAD_VERSION, "versione diversa");
+
+    memcpy(other, buffer, length);
+    other[ARM_FRAME_HEADER_BYTES] = (uint8_t)(int8_t)-120;
+    other[length - 1] = ArmFrameCodec::crc8(other, length - 1);
+    check(ArmFrameCodec::decode(other, length, decoded) == FRAME_BAD_VALUE, "velocità fuori scala");
+}
+
+static void testSequence()
+{
+    ArmFrameTracker tracker;
+    check(tracker.accept(makeJog(250)), "primo frame accettato");
+    check(!tracker.accept(makeJog(250)) && tracker.getDuplicates() == 1, "duplicato scartato");
+    check(tracker.accept(makeJog(253)) && tracker.getLost() == 2, "due frame persi");
+    check(tracker.accept(makeJog(1)) && tracker.getLost() == 5, "giro della sequenza");
+
+    ArmFrame restart = makeJog(0);
+    restart.flags = FRAME_FLAG_FIRST;
+    check(tracker.accept(restart) && tracker.getLost() == 5, "riavvio del controller: nessuna perdita");
+
+    tracker.reset();
+    check(tracker.accept(makeJog(0)) && tracker.getDuplicates() == 1, "dopo reset la sequenza riparte");
+}
+
+int main()
+{
+    testRoundTrip();
+    testCorruption();
+    testSequence();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * TEST HOST: STREAM G-CODE E CONTROLLO DI FLUSSO A CREDITI
+ *
+ * Verifica l'interpretazione delle righe (movimenti della pinza e dei
+ * giunti, parole modali, pause, M-code, errori), lo smistamento tra
+ * stream e coda dei comandi e i crediti: un host che invia righe finché
+ * ha crediti e ne recupera uno per risposta non riempie mai il buffer,
+ * anche se il braccio consuma le righe più lentamente.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testGcodeStream.cpp src/implement/GcodeStream.cpp \
+ *       -o /tmp/testGcodeStream && /tmp/testGcodeStream
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "include/GcodeStream.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+static bool near(float a, float b)
+{
+    return a - b < 0.001f && b - a < 0.001f;
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testMoves()
+{
+    GcodeStream stream;
+    GcodeBlock block;
+
+    check(!stream.parse("G1 X10 Y20 Z30", block) && block.command == GCODE_ERROR,
+          "G1 senza F rifiutato");
+    check(stream.parse("G0 X100 Y0 Z50 P-30", block) && block.command == GCODE_MOVE && block.rapid,
+          "G0 della pinza con pitch");
+    check(block.toolMask == 0x0F && near(block.tool[GCODE_PITCH], -30.0f), "parole X Y Z P");
+
+    check(stream.parse("g1 x110 f1200 ; commento", block) && !block.rapid && near(block.feed, 20.0f),
+          "G1 minuscolo, F in unità/min");
+    check(block.toolMask == (1 << GCODE_X), "solo gli assi presenti");
+
+    check(stream.parse("N42 X120(modale)Y5*71", block) && block.command == GCODE_MOVE && !block.rapid &&
+          near(block.feed, 20.0f) && near(block.tool[GCODE_Y], 5.0f), "movimento e F modali, N e checksum ignorati");
+
+    check(stream.parse("G0 A90 B110 D45", block) && block.jointMask == 0x0B && near(block.joints[1], 110.0f),
+          "G0 dei giunti");
+    check(stream.parse("G91 G1 C-5", block) && block.relative && block.jointMask == 0x04, "G91 relativo");
+    check(stream.parse("A1", block) && block.relative, "G91 resta attivo");
+    check(stream.parse("G90", block) && block.command == GCODE_NONE && !block.relative, "G90 da solo");
+    check(stream.parse("G1 F600", block) && block.command == GCODE_NONE && near(block.feed, 10.0f),
+          "F da solo");
+}
+
+static void testOtherCommands()
+{
+    GcodeStream stream;
+    GcodeBlock block;
+
+    check(stream.parse("G4 P250", block) && block.command == GCODE_DWELL && block.dwellMs == 250, "G4 P in ms");
+    check(stream.parse("G4 S1.5", block) && block.dwellMs == 1500, "G4 S in secondi");
+    check(!stream.parse("G4 X1 P10", block), "G4 con assi rifiutato");
+    check(stream.parse("M400", block) && block.command == GCODE_SYNC, "M400");
+    check(stream.parse("M114", block) && block.command == GCODE_REPORT, "M114");
+    check(stream.parse("M115", block) && block.command == GCODE_INFO, "M115");
+    check(stream.parse("", block) && block.command == GCODE_NONE, "riga vuota");
+    check(stream.parse("(solo commento)", block) && block.command == GCODE_NONE, "solo commento");
+
+    check(!stream.parse("G20", block), "pollici rifiutati");
+    check(!stream.parse("G2 X1", block), "G non supportato");
+    check(!stream.parse("M3", block), "M non supportato");
+    check(!stream.parse("G0 E5", block), "parola sconosciuta");
+    check(!stream.parse("G0 X1 X2", block), "parola ripetuta");
+    check(!stream.parse("G0 X", block), "numero mancante");
+    check(!stream.parse("G0 (aperto X1", block), "commento non chiuso");
+
+    // Una riga non valida non cambia lo stato modale
+    stream.parse("G1 F600", block);
+    check(!stream.parse("G91 F1200 X1 Q2", block), "riga non valida");
+    check(stream.parse("X1", block) && !block.relative && near(block.feed, 10.0f), "stato modale invariato");
+
+    GcodeStream three;
+    three.configure(3);
+    check(!three.parse("G0 D10", block), "lettera oltre i giunti configurati");
+}
+
+static void testRouting()
+{
+    check(GcodeStream::isGcode("G1 X10"), "G1 allo stream");
+    check(GcodeStream::isGcode("  m400"), "M-code con spazi allo stream");
+    check(GcodeStream::isGcode("X-5 Y2"), "asse modale allo stream");
+    check(GcodeStream::isGcode("; commento"), "commento allo stream");
+    check(!GcodeStream::isGcode("MOVE 100 0 50"), "MOVE alla coda dei comandi");
+    check(!GcodeStream::isGcode("Base SX"), "jog alla coda dei comandi");
+    check(!GcodeStream::isGcode("CAL +"), "CAL alla coda dei comandi");
+    check(!GcodeStream::isGcode("FEED 50"), "FEED alla coda dei comandi");
+    check(!GcodeStream::isGcode(""), "riga vuota ignorata");
+}
+
+/**
+ * Host con i crediti di M115 e braccio che consuma una riga ogni 3 tick
+ */
+static void testCredits()
+{
+    GcodeStream stream;
+    int credits = stream.getCapacity();
+    int sent = 0;
+    int answered = 0;
+    bool overflow = false;
+    char line[32];
+
+    for (int tick = 0; answered < 200; tick++) {
+        // L'host invia finché ha crediti (a raffica)
+        while (credits > 0 && sent < 200) {
+            snprintf(line, sizeof(line), "G1 X%d F3000", sent);
+            overflow = overflow || !stream.push(line);
+            credits--;
+            sent++;
+        }
+
+        if (tick % 3 == 0) {
+            const GcodeBlock* block = stream.peek();
+            if (block != nullptr) {
+                stream.pop();
+                credits++;
+                answered++;
+            }
+        }
+    }
+
+    check(!overflow && stream.getOverflows() == 0, "l'host con i crediti non riempie mai il buffer");
+    check(stream.getReceived() == 200 && stream.isEmpty(), "tutte le righe consumate");
+
+    // Host che ignora i crediti
+    for (int i = 0; i < GCODE_BUFFER_LINES; i++) {
+        stream.push("G1 X1");
+    }
+    check(!stream.push("G1 X2") && stream.getOverflows() == 1, "riga oltre i crediti rifiutata e contata");
+}
+
+static void testHalt()
+{
+    GcodeStream stream;
+    stream.push("G0 X100 Y0 Z50");
+    stream.push("G0 X110");
+    const GcodeBlock* block = stream.peek();
+    check(block != nullptr && block->command == GCODE_MOVE, "riga in testa interpretata");
+
+    // Stop del braccio con righe in buffer: tutte rifiutate, anche la testa
+    stream.halt();
+    block = stream.peek();
+    check(block->command == GCODE_ERROR, "riga in testa rifiutata dopo halt");
+    stream.pop();
+    check(stream.peek()->command == GCODE_ERROR, "righe in buffer rifiutate");
+    stream.pop();
+
+    stream.push("G0 X120");
+    check(stream.peek()->command == GCODE_ERROR, "righe successive rifiutate");
+    stream.pop();
+
+    stream.push("M999");
+    check(stream.peek()->command == GCODE_RESUME && !stream.isHalted(), "M999 riprende");
+    stream.pop();
+
+    stream.push("G0 X130");
+    check(stream.peek()->command == GCODE_MOVE, "movimenti di nuovo accettati");
+
+    char longLine[GCODE_LINE_LENGTH + 10];
+    memset(longLine, 'X', sizeof(longLine) - 1);
+    longLine[sizeof(longLine) - 1] = '\0';
+    stream.pop();
+    check(stream.push(longLine) && stream.peek()->command == GCODE_ERROR, "riga troppo lunga: errore con risposta");
+}
+
+int main()
+{
+    testMoves();
+    testOtherCommands();
+    testRouting();
+    testCredits();
+    testHalt();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
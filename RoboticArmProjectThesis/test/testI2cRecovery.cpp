@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * TEST HOST: RETRY E RECUPERO DEL BUS I2C
+ *
+ * Bus I2C simulato al posto di Wire: si possono iniettare NACK (su
+ * indirizzo o dati) per un numero di transazioni e uno slave che tiene
+ * SDA bassa per un numero di impulsi di clock (o per sempre). Verifica
+ * retry limitati, contatori per classe di errore, bus-clear a passi e
+ * nuovo tentativo dopo un recupero fallito.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testI2cRecovery.cpp src/implement/I2cLink.cpp \
+ *       -o /tmp/testI2cRecovery && /tmp/testI2cRecovery
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "include/I2cLink.h"
+
+#define PCA9685 0x40
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+// ============================================================================
+// BUS SIMULATO
+// ============================================================================
+
+struct FakeI2cBus : public I2cBus {
+    int nackCount;          // Prossime transazioni in NACK
+    uint8_t nackCode;       // I2C_NACK_ADDRESS o I2C_NACK_DATA
+    int stuckPulses;        // Impulsi prima che SDA si liberi (-1 = mai)
+    bool released;          // Pin scollegati dal driver
+    int transmitted;        // Transazioni arrivate al dispositivo
+    int attempts;
+    int pulses;
+    int reattaches;
+
+    FakeI2cBus() : nackCount(0), nackCode(I2C_NACK_ADDRESS), stuckPulses(0), released(false),
+                   transmitted(0), attempts(0), pulses(0), reattaches(0) {}
+
+    bool stuck() const { return stuckPulses != 0; }
+
+    uint8_t transmit(uint8_t, const uint8_t*, int) override {
+        attempts++;
+        if (released) return I2C_OTHER;   // Driver scollegato: non deve succedere
+        if (stuck()) return I2C_TIMEOUT;
+        if (nackCount > 0) {
+            nackCount--;
+            return nackCode;
+        }
+        transmitted++;
+        return I2C_OK;
+    }
+
+    bool isSdaLow() override { return stuck(); }
+    void releasePins() override { released = true; }
+
+    void clockPulse() override {
+        pulses++;
+        if (stuckPulses > 0) stuckPulses--;
+    }
+
+    void reattach() override {
+        released = false;
+        reattaches++;
+    }
+};
+
+static const uint8_t FRAME[] = {0x06, 0x00, 0x00, 0x33, 0x01};
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testRetryOnNack()
+{
+    FakeI2cBus bus;
+    I2cLink link(bus);
+
+    bus.nackCount = 1;
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_OK, "NACK singolo: riuscita al retry");
+    check(bus.transmitted == 1 && link.getRetries() == 1, "un solo retry");
+    check(link.getErrors(I2C_NACK_ADDRESS) == 1 && link.getFailures() == 0,
+          "NACK contato per classe, nessuna transazione fallita");
+
+    bus.nackCount = 10;
+    bus.nackCode = I2C_NACK_DATA;
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_NACK_DATA, "NACK persistente: errore riportato");
+    check(bus.attempts == 2 + 1 + I2C_MAX_RETRIES, "tentativi limitati a 1 + I2C_MAX_RETRIES");
+    check(link.getErrors(I2C_NACK_DATA) == 1 + I2C_MAX_RETRIES && link.getFailures() == 1,
+          "contatori NACK dati e fallimenti");
+    check(link.isReady() && bus.pulses == 0, "NACK non avvia il bus-clear");
+}
+
+static void testStuckLowRecovery()
+{
+    FakeI2cBus bus;
+    I2cLink link(bus);
+
+    bus.stuckPulses = 4;
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_TIMEOUT, "SDA bassa: timeout riportato");
+    check(bus.attempts == 1, "bus bloccato: nessun retry");
+    check(!link.isReady() && link.getState() == LINK_CLEARING && bus.released,
+          "bus-clear avviato con pin scollegati");
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_BUS_DOWN && bus.attempts == 1,
+          "durante il recupero le transazioni non toccano il bus");
+
+    int steps = 0;
+    while (!link.step() && steps < 100) steps++;
+    check(bus.pulses == 4 && steps == 4, "un impulso SCL per step fino al rilascio di SDA");
+    check(link.isReady() && !bus.released && bus.reattaches == 1, "STOP e driver riattaccato");
+    check(link.getRecoveries() == 1 && link.getStuckEvents() == 1, "contatori del recupero");
+
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_OK, "trasmissione di nuovo riuscita");
+}
+
+static void testFailedRecoveryBacksOff()
+{
+    FakeI2cBus bus;
+    I2cLink link(bus);
+
+    bus.stuckPulses = -1;
+    link.send(PCA9685, FRAME, sizeof(FRAME));
+
+    for (int i = 0; i <= I2C_CLEAR_PULSES; i++) link.step();
+    check(bus.pulses == I2C_CLEAR_PULSES, "al più I2C_CLEAR_PULSES impulsi per recupero");
+    check(link.getState() == LINK_BACKOFF && link.getFailedRecoveries() == 1,
+          "SDA sempre bassa: recupero fallito e attesa");
+    check(!bus.released, "driver riattaccato anche dopo il fallimento");
+
+    for (int i = 0; i < I2C_RECOVERY_BACKOFF - 1; i++) link.step();
+    check(link.getState() == LINK_BACKOFF && bus.pulses == I2C_CLEAR_PULSES, "nessun impulso durante l'attesa");
+
+    // Lo slave si sblocca durante l'attesa
+    bus.stuckPulses = 0;
+    check(link.step() && link.isReady(), "fine attesa con SDA libera: bus pronto");
+    check(link.send(PCA9685, FRAME, sizeof(FRAME)) == I2C_OK, "trasmissione riuscita dopo l'attesa");
+}
+
+static void testBackoffRetriesRecovery()
+{
+    FakeI2cBus bus;
+    I2cLink link(bus);
+
+    bus.stuckPulses = -1;
+    link.send(PCA9685, FRAME, sizeof(FRAME));
+    for (int i = 0; i <= I2C_CLEAR_PULSES + I2C_RECOVERY_BACKOFF; i++) link.step();
+
+    check(link.getState() == LINK_CLEARING && link.getStuckEvents() == 2,
+          "fine attesa con SDA bassa: nuovo bus-clear");
+
+    bus.stuckPulses = 2;
+    int steps = 0;
+    while (!link.step() && steps < 100) steps++;
+    check(link.isReady() && link.getRecoveries() == 1, "secondo recupero riuscito");
+}
+
+int main()
+{
+    testRetryOnNack();
+    testStuckLowRecovery();
+    testFailedRecoveryBacksOff();
+    testBackoffRetriesRecovery();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * TEST HOST: PIÙ COMANDI DI JOG IN UN MESSAGGIO
+ *
+ * Messaggi del controller con più pulsanti tenuti: più giunti e assi
+ * della pinza in un frame, giunto ripetuto (vale l'ultimo), spazi in
+ * eccesso, e rifiuto dell'intero messaggio quando una sola parola non
+ * è valida (nessun jog parziale).
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc -I../shared/ArmFrame test/testJogList.cpp src/implement/JogList.cpp \
+ *       -o /tmp/testJogList && /tmp/testJogList
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "include/JogList.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+static const char* const NAMES[] = {"Base", "Elbow", "Wrist", "Claw"};
+#define JOINTS 4
+
+static int parse(const char* text, ArmFrame& frame)
+{
+    return JogList::parse(text, NAMES, JOINTS, frame);
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testLists()
+{
+    ArmFrame frame;
+
+    check(parse("Base SX Elbow DX", frame) == 2 && frame.type == FRAME_JOG, "due giunti");
+    check(frame.mask == 0x03 && frame.values[0] == -100 && frame.values[1] == 100, "verso dei due giunti");
+
+    check(parse("Base STOP Elbow SX Claw Open CJOG Z+", frame) == 4, "giunti, pinza e asse");
+    check(frame.mask == (0x0B | (1 << ARM_FRAME_AXIS_BIT(2))), "maschera dei quattro comandi");
+    check(frame.values[0] == 0 && frame.values[1] == -100 && frame.values[3] == 100 &&
+          frame.values[ARM_FRAME_AXIS_BIT(2)] == 100, "rilascio, jog, apertura e asse");
+
+    check(parse("CJOG X STOP CJOG Y- Claw Close", frame) == 3, "rilascio di un asse in due parole");
+    check(frame.values[ARM_FRAME_AXIS_BIT(0)] == 0 && frame.values[ARM_FRAME_AXIS_BIT(1)] == -100 &&
+          frame.values[3] == -100, "asse fermo, asse indietro, pinza chiusa");
+
+    check(parse("Base SX", frame) == 1 && frame.mask == 0x01, "comando singolo");
+}
+
+static void testDuplicates()
+{
+    ArmFrame frame;
+
+    // Rilascio di Base DX e pressione di Base SX nello stesso messaggio
+    check(parse("Base STOP Base SX", frame) == 2 && frame.mask == 0x01 && frame.values[0] == -100,
+          "giunto ripetuto: vale la pressione dopo il rilascio");
+    check(parse("Base SX Base STOP", frame) == 2 && frame.values[0] == 0, "giunto ripetuto: vale l'ultimo");
+}
+
+static void testSeparators()
+{
+    ArmFrame frame;
+
+    check(parse("Base SX Elbow DX ", frame) == 2, "spazio finale");
+    check(parse("  Base SX   Elbow DX  ", frame) == 2 && frame.mask == 0x03, "spazi multipli");
+    check(parse("", frame) == 0 && frame.mask == 0, "messaggio vuoto");
+    check(parse("   ", frame) == 0 && frame.mask == 0, "solo spazi");
+}
+
+static void testRejected()
+{
+    ArmFrame frame;
+
+    // Una parola non valida annulla anche i comandi validi che la precedono
+    check(parse("Base SX Elbow XX", frame) == 0 && frame.mask == 0, "verso sconosciuto: tutto rifiutato");
+    check(parse("Base SX Shoulder DX", frame) == 0 && frame.mask == 0, "giunto sconosciuto: tutto rifiutato");
+    check(parse("Base SX Elbow", frame) == 0 && frame.mask == 0, "giunto senza verso: tutto rifiutato");
+    check(parse("Base SX CJOG", frame) == 0 && frame.mask == 0, "CJOG senza asse");
+    check(parse("CJOG W+ Base SX", frame) == 0 && frame.mask == 0, "asse sconosciuto");
+    check(parse("CJOG X Base SX", frame) == 0, "CJOG senza verso");
+    check(parse("CJOG X+ Base +", frame) == 0, "verso di un asse su un giunto");
+    check(parse("Base SX CJOG X DX", frame) == 0, "verso di un giunto su un asse");
+    check(parse("Base SX ElbowElbowElbowElbow DX", frame) == 0 && frame.mask == 0, "parola troppo lunga");
+    check(parse("MOVE 100 0 50", frame) == 0, "MOVE non è una lista di jog");
+    check(parse("CAL +", frame) == 0, "CAL non è una lista di jog");
+}
+
+int main()
+{
+    testLists();
+    testDuplicates();
+    testSeparators();
+    testRejected();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+/*******************************************************************************
+ * TEST HOST: CINEMATICA DIRETTA E INVERSA
+ *
+ * Confronta Kinematics (tabella Q14, lunghezze in 1/256 mm) con una
+ * cinematica diretta di riferimento in double su una griglia di angoli
+ * e su angoli pseudo-casuali, verifica seno/coseno su tutto il giro e
+ * misura il tempo per chiamata rispetto al riferimento.
+ * Cinematica inversa: andata e ritorno FK → IK → FK su tutto lo spazio
+ * dei limiti servo, rami gomito alto/basso, pitch, punti fuori portata.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -O2 -Isrc test/testKinematics.cpp src/implement/Kinematics.cpp \
+ *       -o /tmp/testKinematics && /tmp/testKinematics
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "include/Kinematics.h"
+
+#define POSITION_TOLERANCE_MM 0.25
+#define PITCH_TOLERANCE_DEG 0.01
+#define BENCH_CALLS 2000000
+#define ROUND_TRIP_TOLERANCE_MM 0.3
+#define ROUND_TRIP_TOLERANCE_DEG 0.25
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+// Geometria e limiti di prova (come il prototipo)
+static const ArmGeometry GEOMETRY = {95.0f, 105.0f, 150.0f, 135.0f, 45.0f, 90.0f, 1, 1, -1};
+static const IkLimits LIMITS = {{0.0f, 0.0f, 0.0f}, {180.0f, 137.0f, 180.0f}, nullptr, nullptr};
+
+// ============================================================================
+// RIFERIMENTO IN DOUBLE
+// ============================================================================
+
+struct ReferencePose {
+    double x, y, z, pitch;
+};
+
+static void referenceForward(const ArmGeometry& g, const float servo[KIN_AXES], ReferencePose& pose)
+{
+    const double rad = M_PI / 180.0;
+    double base = g.baseSign * (servo[KIN_BASE] - g.baseOffset) * rad;
+    double shoulder = g.elbowSign * (servo[KIN_ELBOW] - g.elbowOffset) * rad;
+    double tool = shoulder + g.wristSign * (servo[KIN_WRIST] - g.wristOffset) * rad;
+
+    double reach = g.upperArm * cos(shoulder) + g.forearm * cos(tool);
+    pose.x = reach * cos(base);
+    pose.y = reach * sin(base);
+    pose.z = g.baseHeight + g.upperArm * sin(shoulder) + g.forearm * sin(tool);
+    pose.pitch = remainder(tool / rad, 360.0);
+}
+
+static double positionError(const ToolPose& pose, const ReferencePose& ref)
+{
+    double dx = Kinematics::toMm(pose.x) - ref.x;
+    double dy = Kinematics::toMm(pose.y) - ref.y;
+    double dz = Kinematics::toMm(pose.z) - ref.z;
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static double pitchError(const ToolPose& pose, const ReferencePose& ref)
+{
+    return fabs(remainder(Kinematics::angleToDeg(pose.pitch) - ref.pitch, 360.0));
+}
+
+// Generatore deterministico (LCG)
+static uint32_t seed = 12345;
+static float randomAngle(float range)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (range / 16777216.0f);
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testTrigonometry()
+{
+    int worst = 0;
+    for (long angle = 0; angle < KIN_FULL_TURN; angle++) {
+        double ref = sin(angle * 2.0 * M_PI / KIN_FULL_TURN) * KIN_Q14_ONE;
+        int error = (int)fabs(Kinematics::sinQ14((uint16_t)angle) - ref);
+        if (error > worst) worst = error;
+    }
+    printf("       errore massimo seno: %d LSB Q14\n", worst);
+    check(worst <= 2, "seno entro 2 LSB su tutto il giro");
+
+    check(Kinematics::sinQ14(0x4000) == KIN_Q14_ONE && Kinematics::cosQ14(0) == KIN_Q14_ONE,
+          "sin(90°) e cos(0°) esatti");
+    check(Kinematics::sinQ14(0xC000) == -KIN_Q14_ONE && Kinematics::cosQ14(0x8000) == -KIN_Q14_ONE,
+          "sin(270°) e cos(180°) esatti");
+    check(Kinematics::degToAngle(-90.0f) == 0xC000 && Kinematics::degToAngle(450.0f) == 0x4000,
+          "gradi → angolo binario con giro modulo 360°");
+}
+
+static void testKnownPoses()
+{
+    Kinematics kinematics;
+    kinematics.configure(GEOMETRY);
+    ToolPose pose;
+
+    // Braccio teso in orizzontale lungo +X
+    const float stretched[KIN_AXES] = {135.0f, 45.0f, 90.0f};
+    kinematics.forward(stretched, pose);
+    check(fabs(Kinematics::toMm(pose.x) - 255.0f) < 0.05f && pose.y == 0 &&
+          fabs(Kinematics::toMm(pose.z) - 95.0f) < 0.05f && pose.pitch == 0,
+          "braccio teso: X = L1 + L2, Z = altezza base");
+
+    // Primo link verticale, secondo orizzontale, base ruotata di 90°
+    const float folded[KIN_AXES] = {225.0f, 135.0f, 180.0f};
+    kinematics.forward(folded, pose);
+    check(fabs(Kinematics::toMm(pose.x)) < 0.05f && fabs(Kinematics::toMm(pose.y) - 150.0f) < 0.05f &&
+          fabs(Kinematics::toMm(pose.z) - 200.0f) < 0.05f && pose.pitch == 0,
+          "link verticale + orizzontale lungo +Y");
+}
+
+static void testAgainstReference()
+{
+    Kinematics kinematics;
+    kinematics.configure(GEOMETRY);
+    ToolPose pose;
+    ReferencePose ref;
+    double worstPosition = 0.0;
+    double worstPitch = 0.0;
+
+    // Griglia a passi di 5° sul campo dei servo
+    for (int base = 0; base <= 270; base += 5) {
+        for (int elbow = 0; elbow <= 270; elbow += 5) {
+            for (int wrist = 0; wrist <= 180; wrist += 5) {
+                const float servo[KIN_AXES] = {(float)base, (float)elbow, (float)wrist};
+                kinematics.forward(servo, pose);
+                referenceForward(GEOMETRY, servo, ref);
+                worstPosition = fmax(worstPosition, positionError(pose, ref));
+                worstPitch = fmax(worstPitch, pitchError(pose, ref));
+            }
+        }
+    }
+
+    // Angoli non allineati alla griglia (tocca l'interpolazione)
+    for (int i = 0; i < 200000; i++) {
+        const float servo[KIN_AXES] = {randomAngle(270.0f), randomAngle(270.0f), randomAngle(180.0f)};
+        kinematics.forward(servo, pose);
+        referenceForward(GEOMETRY, servo, ref);
+        worstPosition = fmax(worstPosition, positionError(pose, ref));
+        worstPitch = fmax(worstPitch, pitchError(pose, ref));
+    }
+
+    printf("       errore massimo: %.4f mm, pitch %.5f°\n", worstPosition, worstPitch);
+    check(worstPosition < POSITION_TOLERANCE_MM, "posizione entro la tolleranza rispetto al double");
+    check(worstPitch < PITCH_TOLERANCE_DEG, "pitch entro la tolleranza rispetto al double");
+}
+
+static IkTarget targetOf(const ToolPose& pose, int branch)
+{
+    IkTarget target = {Kinematics::toMm(pose.x), Kinematics::toMm(pose.y), Kinematics::toMm(pose.z),
+                       false, 0.0f, branch};
+    return target;
+}
+
+static void testRoundTrip()
+{
+    Kinematics kinematics;
+    kinematics.configure(GEOMETRY);
+    ToolPose pose;
+    ToolPose back;
+    float solution[KIN_AXES];
+    const float home[KIN_AXES] = {90.0f, 90.0f, 90.0f};
+    double worstPosition = 0.0;
+    double worstAngle = 0.0;
+    int solved = 0;
+    int total = 0;
+    int sameBranch = 0;
+
+    // Un grado di margine dai limiti: l'arrotondamento della FK in
+    // virgola fissa non deve spingere il punto fuori
+    for (int base = 1; base <= 179; base += 4) {
+        for (int elbow = 1; elbow <= 136; elbow += 3) {
+            for (int wrist = 1; wrist <= 179; wrist += 3) {
+                const float servo[KIN_AXES] = {(float)base, (float)elbow, (float)wrist};
+                kinematics.forward(servo, pose);
+                total++;
+
+                // Nessuna preferenza: un punto raggiunto deve essere risolto
+                IkTarget target = targetOf(pose, IK_ELBOW_ANY);
+                if (kinematics.inverse(target, LIMITS, home, solution) != IK_OK) continue;
+                solved++;
+                kinematics.forward(solution, back);
+                double dx = Kinematics::toMm(back.x - pose.x);
+                double dy = Kinematics::toMm(back.y - pose.y);
+                double dz = Kinematics::toMm(back.z - pose.z);
+                worstPosition = fmax(worstPosition, sqrt(dx * dx + dy * dy + dz * dz));
+
+                // Ramo e posizione di partenza di servo: stessi angoli.
+                // Esclusi braccio quasi teso (i rami coincidono e l'angolo
+                // è mal condizionato) e punti sull'asse della base
+                float relative = GEOMETRY.wristSign * (wrist - GEOMETRY.wristOffset);
+                if (fabs(relative) < 10.0f || hypot(target.x, target.y) < 20.0) continue;
+                target.branch = relative < 0.0f ? IK_ELBOW_UP : IK_ELBOW_DOWN;
+                if (kinematics.inverse(target, LIMITS, servo, solution) != IK_OK) continue;
+                sameBranch++;
+                for (int axis = 0; axis < KIN_AXES; axis++) {
+                    worstAngle = fmax(worstAngle, fabs(solution[axis] - servo[axis]));
+                }
+            }
+        }
+    }
+
+    printf("       %d/%d pose risolte, errore massimo %.4f mm, angolo %.4f° (%d confronti)\n",
+           solved, total, worstPosition, worstAngle, sameBranch);
+    check(solved == total, "ogni pose nei limiti ha una soluzione");
+    check(worstPosition < ROUND_TRIP_TOLERANCE_MM, "FK → IK → FK entro la tolleranza");
+    check(sameBranch > total / 2 && worstAngle < ROUND_TRIP_TOLERANCE_DEG,
+          "stesso ramo: angoli servo ritrovati");
+}
+
+static void testBranchesAndPitch()
+{
+    Kinematics kinematics;
+    kinematics.configure(GEOMETRY);
+    ToolPose pose;
+    float up[KIN_AXES];
+    float down[KIN_AXES];
+    float solution[KIN_AXES];
+    const float home[KIN_AXES] = {90.0f, 90.0f, 90.0f};
+
+    // Punto davanti, sopra la spalla: entrambi i rami nei limiti
+    IkTarget target = {210.0f, 60.0f, 150.0f, false, 0.0f, IK_ELBOW_UP};
+    check(kinematics.inverse(target, LIMITS, home, up) == IK_OK, "ramo gomito alto risolto");
+    target.branch = IK_ELBOW_DOWN;
+    check(kinematics.inverse(target, LIMITS, home, down) == IK_OK, "ramo gomito basso risolto");
+    check(up[KIN_ELBOW] > down[KIN_ELBOW] && fabs(up[KIN_BASE] - down[KIN_BASE]) < 0.01f,
+          "gomito alto: primo link più sollevato, stessa base");
+
+    // Il pitch sceglie il ramo anche contro la preferenza
+    kinematics.forward(down, pose);
+    target.branch = IK_ELBOW_UP;
+    target.hasPitch = true;
+    target.pitch = Kinematics::angleToDeg(pose.pitch);
+    check(kinematics.inverse(target, LIMITS, home, solution) == IK_OK &&
+          fabs(solution[KIN_ELBOW] - down[KIN_ELBOW]) < 0.1f, "pitch del ramo basso: scelto il ramo basso");
+
+    target.pitch += 45.0f;
+    check(kinematics.inverse(target, LIMITS, home, solution) == IK_PITCH_MISMATCH,
+          "pitch impossibile nel punto: rifiutato");
+
+    IkTarget far = {300.0f, 0.0f, 95.0f, false, 0.0f, IK_ELBOW_ANY};
+    check(kinematics.inverse(far, LIMITS, home, solution) == IK_UNREACHABLE, "oltre L1 + L2: fuori portata");
+
+    IkTarget behind = {-200.0f, 0.0f, 40.0f, false, 0.0f, IK_ELBOW_ANY};
+    check(kinematics.inverse(behind, LIMITS, home, solution) == IK_OUT_OF_LIMITS,
+          "dietro la base e in basso: fuori dai limiti dei servo");
+}
+
+static void benchmark()
+{
+    Kinematics kinematics;
+    kinematics.configure(GEOMETRY);
+    volatile int32_t sinkFixed = 0;
+    volatile double sinkDouble = 0.0;
+
+    uint16_t angles[KIN_AXES] = {0, 0, 0};
+    ToolPose pose;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        angles[KIN_BASE] += 97;
+        angles[KIN_ELBOW] += 61;
+        angles[KIN_WRIST] += 37;
+        kinematics.forwardFixed(angles, pose);
+        sinkFixed = sinkFixed + pose.x + pose.z;
+    }
+    double fixedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    float servo[KIN_AXES] = {0.0f, 0.0f, 0.0f};
+    ReferencePose ref;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        servo[KIN_BASE] += 0.53f;
+        servo[KIN_ELBOW] += 0.33f;
+        servo[KIN_WRIST] += 0.2f;
+        referenceForward(GEOMETRY, servo, ref);
+        sinkDouble = sinkDouble + ref.x + ref.z;
+    }
+    double doubleNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    IkTarget target = {150.0f, 0.0f, 120.0f, false, 0.0f, IK_ELBOW_UP};
+    const float home[KIN_AXES] = {90.0f, 90.0f, 90.0f};
+    float solution[KIN_AXES];
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_CALLS / 10; i++) {
+        target.y = (float)(i % 200) - 100.0f;
+        kinematics.inverse(target, LIMITS, home, solution);
+        sinkDouble = sinkDouble + solution[KIN_BASE];
+    }
+    double inverseNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("       virgola fissa: %.1f ns/chiamata, double: %.1f ns/chiamata, inversa: %.1f ns/chiamata\n",
+           fixedNs / BENCH_CALLS, doubleNs / BENCH_CALLS, inverseNs / (BENCH_CALLS / 10));
+    check(fixedNs > 0.0 && doubleNs > 0.0, "benchmark eseguito");
+}
+
+int main()
+{
+    testTrigonometry();
+    testKnownPoses();
+    testAgainstReference();
+    testRoundTrip();
+    testBranchesAndPitch();
+    benchmark();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
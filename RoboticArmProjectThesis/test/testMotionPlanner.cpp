@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * TEST HOST: MOTION PLANNER (RACCORDI E WAYPOINT SINCRONIZZATI)
+ *
+ * Due planner con limiti diversi (gomito 20kg e polso MG66R) ricevono
+ * gli stessi waypoint sincronizzati: i profili devono avere la stessa
+ * durata e a ogni istante la stessa frazione percorsa, anche con un
+ * raccordo tra due waypoint e dopo resume(). Verifica anche il raccordo
+ * di un giunto solo, il fermo sull'inversione e dropLast().
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testMotionPlanner.cpp src/implement/MotionPlanner.cpp \
+ *       -o /tmp/testMotionPlanner && /tmp/testMotionPlanner
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "include/MotionPlanner.h"
+
+#define PERIOD_S 0.02f
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+static bool near(float a, float b, float tolerance = 0.001f)
+{
+    return fabsf(a - b) < tolerance;
+}
+
+/**
+ * Limiti comuni di un waypoint da (e0, w0) a (e1, w1), come JointTable::queueSync
+ */
+static SyncProfile syncFor(float elbowDistance, float wristDistance, uint16_t group, float junction)
+{
+    float e = fabsf(elbowDistance);
+    float w = fabsf(wristDistance);
+    SyncProfile sync;
+    sync.group = group;
+    sync.maxVelocity = fminf(180.0f / e, 240.0f / w);
+    sync.maxAccel = fminf(720.0f / e, 1200.0f / w);
+    sync.junction = junction;
+    return sync;
+}
+
+/**
+ * Frazione del tratto percorsa a t
+ */
+static float fraction(const MotionProfile& profile, float t)
+{
+    return (profile.position(t) - profile.startAngle) / (profile.direction * profile.distance);
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testSingleJoint()
+{
+    MotionPlanner planner;
+    planner.setLimits(180.0f, 720.0f);
+    planner.reset(0.0f);
+
+    MotionProfile profile;
+    planner.push(10.0f);
+    planner.push(20.0f);
+    planner.next(profile);
+    check(profile.exitVelocity > 0.0f, "stessa direzione: raccordo senza fermarsi");
+
+    planner.reset(0.0f);
+    planner.push(10.0f);
+    planner.push(0.0f);
+    planner.next(profile);
+    check(profile.exitVelocity == 0.0f, "inversione: fermo sul waypoint");
+
+    planner.reset(0.0f);
+    planner.push(10.0f);
+    planner.push(30.0f);
+    check(planner.dropLast() && planner.getCount() == 1 && near(planner.getEndPosition(), 10.0f),
+          "dropLast toglie solo l'ultimo waypoint");
+}
+
+static void testSynchronised()
+{
+    MotionPlanner elbow;
+    MotionPlanner wrist;
+    elbow.setLimits(180.0f, 720.0f);
+    wrist.setLimits(240.0f, 1200.0f);
+    elbow.reset(90.0f);
+    wrist.reset(90.0f);
+
+    // Gomito +60°, polso -50°: da soli avrebbero profili diversi
+    SyncProfile sync = syncFor(60.0f, -50.0f, 1, 0.0f);
+    elbow.pushSync(150.0f, sync);
+    wrist.pushSync(40.0f, sync);
+
+    MotionProfile e;
+    MotionProfile w;
+    elbow.next(e);
+    wrist.next(w);
+    check(e.duration == w.duration, "stessa durata");
+
+    bool same = true;
+    for (float t = 0.0f; t <= e.duration + PERIOD_S; t += PERIOD_S) {
+        same = same && near(fraction(e, t), fraction(w, t), 1e-5f);
+    }
+    check(same, "stessa frazione a ogni tick");
+    check(near(e.position(e.duration), 150.0f) && near(w.position(w.duration), 40.0f), "arrivo sui target");
+    check(fabsf(e.velocity(e.t1)) <= 180.0f + 0.01f && fabsf(w.velocity(w.t1)) <= 240.0f + 0.01f,
+          "velocità entro i limiti di ogni giunto");
+}
+
+static void testBlendAndResume()
+{
+    MotionPlanner elbow;
+    MotionPlanner wrist;
+    elbow.setLimits(180.0f, 720.0f);
+    wrist.setLimits(240.0f, 1200.0f);
+    elbow.reset(90.0f);
+    wrist.reset(90.0f);
+
+    // Due waypoint con raccordo ammesso
+    SyncProfile first = syncFor(40.0f, -30.0f, 1, 0.0f);
+    SyncProfile second = syncFor(20.0f, -15.0f, 2, 5.0f);
+    elbow.pushSync(130.0f, first);
+    wrist.pushSync(60.0f, first);
+    elbow.pushSync(150.0f, second);
+    wrist.pushSync(45.0f, second);
+
+    MotionProfile e;
+    MotionProfile w;
+    elbow.next(e);
+    wrist.next(w);
+    check(e.exitVelocity > 0.0f && e.exitVelocity == w.exitVelocity, "raccordo comune ai due giunti");
+
+    // A metà del primo tratto il resto viene ripianificato
+    float t = 5 * PERIOD_S;
+    elbow.resume(e.travel(t), e.speed(t));
+    wrist.resume(w.travel(t), w.speed(t));
+    elbow.next(e);
+    wrist.next(w);
+    check(e.duration == w.duration && e.startAngle > 90.0f && e.startAngle < 130.0f,
+          "resto ripianificato con la stessa durata");
+    check(near((e.startAngle - 90.0f) / 40.0f, (w.startAngle - 90.0f) / -30.0f, 1e-5f),
+          "resto dalla stessa frazione");
+
+    elbow.next(e);
+    wrist.next(w);
+    check(e.duration == w.duration && e.entryVelocity == w.entryVelocity, "secondo waypoint sincronizzato");
+    check(near(e.position(e.duration), 150.0f) && near(w.position(w.duration), 45.0f), "arrivo sul secondo waypoint");
+
+    // Un giunto solo dopo un waypoint sincronizzato parte da fermo
+    elbow.reset(90.0f);
+    elbow.pushSync(130.0f, first);
+    elbow.push(170.0f);
+    elbow.next(e);
+    check(e.exitVelocity == 0.0f, "waypoint sincronizzato seguito da uno singolo: fermo");
+
+    MotionSegment tail;
+    check(elbow.getTail(tail, true) && tail.group == 0 && elbow.contains(1) == false, "coda e gruppi");
+}
+
+int main()
+{
+    testSingleJoint();
+    testSynchronised();
+    testBlendAndResume();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * TEST HOST: MOTION SCRIPT (COMPILAZIONE, ESECUZIONE, DRY-RUN)
+ *
+ * Braccio simulato a quattro giunti (0-180°, 90°/s da fermo a fermo) e
+ * pinza raggiungibile solo con x < 200. Verifica gli errori di
+ * compilazione con la riga giusta, l'espansione dei REPEAT annidati da
+ * parte di ScriptRunner (un movimento per tick, a braccio fermo), le
+ * pause, il rifiuto di un movimento e il dry-run: durata del ciclo,
+ * limiti dei giunti, punti non raggiungibili e programmi troppo lunghi.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testMotionScript.cpp src/implement/MotionScript.cpp \
+ *       -o /tmp/testMotionScript && /tmp/testMotionScript
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "include/MotionScript.h"
+
+#define SIM_JOINTS 4
+#define SIM_SPEED 90.0f        // °/s
+#define SIM_MAX_MOVES 32
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) < 0.001f;
+}
+
+static const char* const JOINT_NAMES[SIM_JOINTS] = {"Base", "Elbow", "Wrist", "Claw"};
+static const ScriptConfig CONFIG = {JOINT_NAMES, SIM_JOINTS, 3, 110.0f, 45.0f};
+
+// ============================================================================
+// BRACCIO SIMULATO
+// ============================================================================
+
+class SimArm : public ScriptTarget {
+public:
+    float angles[SIM_JOINTS] = {90.0f, 90.0f, 90.0f, 90.0f};
+    uint16_t masks[SIM_MAX_MOVES];
+    int moves = 0;
+    int busyTicks = 0;        // Tick di movimento dopo ogni comando
+    bool reject = false;
+
+    bool isIdle() override {
+        if (busyTicks > 0) {
+            busyTicks--;
+            return false;
+        }
+        return true;
+    }
+
+    bool moveJoints(const float target[], uint16_t mask) override {
+        if (reject) {
+            return false;
+        }
+        for (int joint = 0; joint < SIM_JOINTS; joint++) {
+            if (mask & (1 << joint)) angles[joint] = target[joint];
+        }
+        if (moves < SIM_MAX_MOVES) masks[moves] = mask;
+        moves++;
+        busyTicks = 2;
+        return true;
+    }
+
+    bool moveTool(const float target[4], bool hasPitch, bool /* straight */) override {
+        return solveTool(target, hasPitch, angles, angles) && moveJoints(angles, 0x07);
+    }
+
+    // Base = x, gomito = y, polso = z
+    bool solveTool(const float target[4], bool /* hasPitch */, const float current[], float result[]) override {
+        if (target[0] >= 200.0f) return false;
+        for (int joint = 0; joint < SIM_JOINTS; joint++) result[joint] = current[joint];
+        for (int axis = 0; axis < 3; axis++) result[axis] = target[axis];
+        return true;
+    }
+
+    bool isPoseValid(const float pose[]) override {
+        for (int joint = 0; joint < SIM_JOINTS; joint++) {
+            if (pose[joint] < 0.0f || pose[joint] > 180.0f) return false;
+        }
+        return true;
+    }
+
+    float estimateTime(const float from[], const float to[], bool /* straight */) override {
+        float worst = 0.0f;
+        for (int joint = 0; joint < SIM_JOINTS; joint++) {
+            float delta = fabsf(to[joint] - from[joint]);
+            if (delta > worst) worst = delta;
+        }
+        return worst / SIM_SPEED;
+    }
+};
+
+/**
+ * Compila e restituisce la riga dell'errore (0 se compilato)
+ */
+static int errorLine(MotionScript& script, const char* source)
+{
+    return script.compile(source, CONFIG) ? 0 : script.getErrorLine();
+}
+
+/**
+ * Esegue fino alla fine (o maxTicks), un tick ogni 20ms
+ */
+static int runToEnd(ScriptRunner& runner, int maxTicks)
+{
+    unsigned long now = 0;
+    int state = runner.getState();
+    for (int tick = 0; tick < maxTicks && runner.isRunning(); tick++, now += 20) {
+        state = runner.step(now);
+    }
+    return state;
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testCompileErrors()
+{
+    MotionScript script;
+
+    check(errorLine(script, "POSE a 1 2 3 4\nGO a\nJUMP a\n") == 3, "istruzione sconosciuta alla riga 3");
+    check(!script.isValid() && strcmp(script.getError(), "istruzione sconosciuta") == 0, "messaggio dell'errore");
+
+    check(errorLine(script, "REPEAT 2\nJOINT Base 10\n") == 2, "REPEAT senza END");
+    check(errorLine(script, "JOINT Base 10\nEND\n") == 2, "END senza REPEAT");
+    check(errorLine(script, "REPEAT 0\nEND\n") == 1, "REPEAT 0 rifiutato");
+    check(errorLine(script, "REPEAT\nREPEAT\nREPEAT\nREPEAT\nREPEAT\nEND\nEND\nEND\nEND\nEND\n") == 5,
+          "quinto REPEAT annidato rifiutato");
+    check(errorLine(script, "REPEAT\nREPEAT\nREPEAT\nREPEAT\nWAIT 1\nEND\nEND\nEND\nEND\n") == 0,
+          "quattro REPEAT annidati accettati");
+
+    check(errorLine(script, "GO home\n") == 1, "GO di una posa non definita");
+    check(errorLine(script, "POSE a 1 2 3\n") == 1, "POSE senza tutti i giunti");
+    check(errorLine(script, "POSE a 1 2 3 4\nPOSE a 5 6 7 8\n") == 2, "posa duplicata");
+    check(errorLine(script, "JOINT Shoulder 10\n") == 1, "giunto sconosciuto");
+    check(errorLine(script, "CLAW HALF\n") == 1, "CLAW con valore non valido");
+    check(errorLine(script, "MOVE 1 2\n") == 1, "MOVE senza z");
+    check(errorLine(script, "WAIT -5\n") == 1, "WAIT negativo");
+
+    char longSource[(SCRIPT_MAX_OPS + 1) * 8 + 1] = "";
+    for (int i = 0; i <= SCRIPT_MAX_OPS; i++) {
+        strcat(longSource, "WAIT 1\n");
+    }
+    check(errorLine(script, longSource) == SCRIPT_MAX_OPS + 1, "programma troppo lungo");
+
+    check(errorLine(script, "# commento\n\n  CLAW OPEN  # pinza\r\n") == 0 && script.getOpCount() == 2,
+          "commenti, righe vuote e CRLF ignorati");
+}
+
+static void testNestedRepeat()
+{
+    MotionScript script;
+    check(script.compile("REPEAT 2\n"
+                         "  JOINT Base 10\n"
+                         "  REPEAT 3\n"
+                         "    JOINT Elbow 20\n"
+                         "  END\n"
+                         "END\n"
+                         "CLAW CLOSE\n", CONFIG), "REPEAT annidati compilati");
+
+    SimArm arm;
+    ScriptRunner runner;
+    check(runner.start(&script, &arm), "avviato");
+    check(runToEnd(runner, 500) == SCRIPT_DONE, "concluso");
+
+    // Base, 3 x Elbow, Base, 3 x Elbow, Claw
+    const uint16_t expected[] = {0x1, 0x2, 0x2, 0x2, 0x1, 0x2, 0x2, 0x2, 0x8};
+    bool order = arm.moves == 9;
+    for (int i = 0; i < 9 && order; i++) {
+        order = arm.masks[i] == expected[i];
+    }
+    check(order, "2 x (1 + 3) movimenti nell'ordine giusto, poi la pinza");
+    check(runner.getCycles() == 2, "due giri del REPEAT esterno");
+    check(near(arm.angles[3], 45.0f), "CLAW CLOSE all'angolo configurato");
+}
+
+static void testStepping()
+{
+    MotionScript script;
+    script.compile("JOINT Base 10\nWAIT 100\nJOINT Base 20\n", CONFIG);
+
+    SimArm arm;
+    ScriptRunner runner;
+    runner.start(&script, &arm);
+
+    runner.step(0);
+    check(arm.moves == 1, "un movimento al primo tick");
+    runner.step(20);
+    check(arm.moves == 1 && runner.getLine() == 2, "attende il braccio fermo");
+
+    runner.step(40);
+
+    // Braccio fermo a 60ms: la pausa parte qui
+    runner.step(60);
+    runner.step(140);
+    check(arm.moves == 1, "pausa in corso dopo 80ms");
+    runner.step(160);
+    check(arm.moves == 2, "movimento dopo 100ms di pausa");
+
+    // Movimento rifiutato dal braccio
+    SimArm busy;
+    busy.reject = true;
+    runner.start(&script, &busy);
+    check(runner.step(0) == SCRIPT_FAILED && runner.getLine() == 1, "rifiuto: FAILED alla riga del movimento");
+
+    // REPEAT infinito fermato da SCRIPT STOP
+    MotionScript endless;
+    endless.compile("REPEAT\nJOINT Base 10\nJOINT Base 20\nEND\n", CONFIG);
+    runner.start(&endless, &arm);
+    runToEnd(runner, 100);
+    check(runner.isRunning() && runner.getCycles() > 5, "REPEAT infinito ancora in corso");
+    runner.stop();
+    check(runner.getState() == SCRIPT_IDLE, "fermato");
+}
+
+static void testDryRun()
+{
+    MotionScript script;
+    SimArm arm;
+    ScriptReport report;
+    const float start[SIM_JOINTS] = {90.0f, 90.0f, 90.0f, 90.0f};
+
+    // 90 → 0 (1s), 0 → 90 (1s) ripetuto 3 volte, più 3 pause da 250ms
+    script.compile("REPEAT 3\nJOINT Base 0\nWAIT 250\nJOINT Base 90\nEND\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(report.ok && report.moves == 6 && !report.endless, "dry-run: 6 movimenti");
+    check(near(report.cycleSeconds, 6.75f), "dry-run: ciclo di 6.75s");
+    check(arm.moves == 0, "dry-run: nessun movimento reale");
+
+    script.compile("REPEAT\nJOINT Base 0\nEND\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(report.ok && report.endless && near(report.cycleSeconds, 1.0f), "REPEAT infinito: un giro");
+
+    script.compile("POSE ok 10 10 10 10\nPOSE bad 10 190 10 10\nGO ok\nGO bad\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(!report.ok && report.errorLine == 4, "posa fuori dai limiti alla riga 4");
+
+    script.compile("MOVE 100 50 50\nLINE 250 50 50\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(!report.ok && report.errorLine == 2 && strcmp(report.error, "punto non raggiungibile") == 0,
+          "punto non raggiungibile alla riga 2");
+
+    script.compile("REPEAT 1000\nREPEAT 1000\nWAIT 1\nEND\nEND\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(!report.ok && strcmp(report.error, "programma troppo lungo per il dry-run") == 0,
+          "oltre SCRIPT_DRY_RUN_STEPS istruzioni");
+
+    script.compile("JUMP\n", CONFIG);
+    ScriptRunner::dryRun(script, arm, start, report);
+    check(!report.ok && report.errorLine == 1, "programma non compilato: errore della compilazione");
+}
+
+int main()
+{
+    testCompileErrors();
+    testNestedRepeat();
+    testStepping();
+    testDryRun();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
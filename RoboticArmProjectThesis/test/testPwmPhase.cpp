@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * TEST HOST: IMPULSI SFASATI SUI CANALI PCA9685
+ *
+ * Registri LEDn_ON/OFF simulati come sul PCA9685: l'uscita è alta dal
+ * conteggio ON al conteggio OFF, con OFF < ON l'impulso scavalca la fine
+ * del periodo. Verifica durata degli impulsi, assenza di sovrapposizioni
+ * e riduzione dei canali alti contemporaneamente rispetto a ON = 0.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testPwmPhase.cpp src/implement/PwmPhaseTable.cpp \
+ *       -o /tmp/testPwmPhase && /tmp/testPwmPhase
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "include/PwmPhaseTable.h"
+
+#define SERVO_MAX_PULSE 512   // 2.5ms a 50Hz
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+// ============================================================================
+// REGISTRI PCA9685 SIMULATI
+// ============================================================================
+
+struct Pca9685Registers {
+    uint16_t on[PWM_CHANNELS];
+    uint16_t off[PWM_CHANNELS];
+    bool valid;
+
+    Pca9685Registers() : valid(true) {
+        for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+            on[ch] = 0;
+            off[ch] = PWM_FULL_OFF;
+        }
+    }
+
+    void setPWM(int channel, uint16_t onValue, uint16_t offValue) {
+        // 12 bit + bit FULL_OFF
+        if (onValue >= PWM_PERIOD_COUNTS || offValue > PWM_FULL_OFF) valid = false;
+        on[channel] = onValue;
+        off[channel] = offValue;
+    }
+
+    bool isHigh(int channel, int count) const {
+        if (off[channel] & PWM_FULL_OFF) return false;
+        if (on[channel] <= off[channel]) return count >= on[channel] && count < off[channel];
+        return count >= on[channel] || count < off[channel];  // Scavalca il periodo
+    }
+
+    int highTime(int channel) const {
+        int total = 0;
+        for (int count = 0; count < PWM_PERIOD_COUNTS; count++) {
+            if (isHigh(channel, count)) total++;
+        }
+        return total;
+    }
+
+    int peakHigh() const {
+        int peak = 0;
+        for (int count = 0; count < PWM_PERIOD_COUNTS; count++) {
+            int high = 0;
+            for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+                if (isHigh(ch, count)) high++;
+            }
+            if (high > peak) peak = high;
+        }
+        return peak;
+    }
+};
+
+static void writeAll(const PwmPhaseTable& table, Pca9685Registers& regs,
+                     const int* channels, int count, uint16_t pulse)
+{
+    for (int i = 0; i < count; i++) {
+        uint16_t on, off;
+        table.window(channels[i], pulse, on, off);
+        regs.setPWM(channels[i], on, off);
+    }
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testArmChannels()
+{
+    const int channels[] = {0, 4, 8, 12};  // Canali del braccio (set_up.h)
+
+    PwmPhaseTable table;
+    for (int i = 0; i < 4; i++) table.add(channels[i]);
+
+    Pca9685Registers regs;
+    writeAll(table, regs, channels, 4, SERVO_MAX_PULSE);
+
+    bool widths = true;
+    for (int i = 0; i < 4; i++) {
+        if (regs.highTime(channels[i]) != SERVO_MAX_PULSE) widths = false;
+    }
+
+    check(regs.valid, "registri ON/OFF nel range del PCA9685");
+    check(widths, "durata impulsi invariata dallo sfasamento");
+    check(regs.peakHigh() == 1, "4 canali a impulso massimo: mai due alti insieme");
+
+    // Riferimento: tutti con ON = 0
+    Pca9685Registers inPhase;
+    for (int i = 0; i < 4; i++) inPhase.setPWM(channels[i], 0, SERVO_MAX_PULSE);
+    printf("       canali alti insieme: %d in fase, %d sfasati\n",
+           inPhase.peakHigh(), regs.peakHigh());
+}
+
+static void testAllChannelsAndWrap()
+{
+    int channels[PWM_CHANNELS];
+    PwmPhaseTable table;
+    for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+        channels[ch] = ch;
+        table.add(ch);
+    }
+
+    Pca9685Registers regs;
+    writeAll(table, regs, channels, PWM_CHANNELS, SERVO_MAX_PULSE);
+
+    bool widths = true;
+    bool wrapped = false;
+    for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+        if (regs.highTime(ch) != SERVO_MAX_PULSE) widths = false;
+        if (regs.off[ch] < regs.on[ch]) wrapped = true;
+    }
+
+    check(widths, "16 canali: durata impulsi invariata");
+    check(wrapped, "impulso che scavalca il periodo (OFF < ON) presente");
+    check(regs.peakHigh() <= (PWM_CHANNELS * SERVO_MAX_PULSE) / PWM_PERIOD_COUNTS,
+          "16 canali: picco di canali alti al minimo teorico");
+}
+
+static void testRegistrationKeepsSlotsConsistent()
+{
+    PwmPhaseTable table;
+    check(table.add(3), "primo canale registrato");
+    check(table.getOffset(3) == 0, "canale unico a offset 0");
+    check(!table.add(3), "canale già registrato ignorato");
+    check(!table.add(PWM_CHANNELS), "canale fuori range rifiutato");
+
+    table.add(9);
+    check(table.getOffset(9) == PWM_PERIOD_COUNTS / 2, "secondo canale a metà periodo");
+
+    table.add(0);
+    bool spaced = table.getOffset(0) == 0 &&
+                  table.getOffset(3) == PWM_PERIOD_COUNTS / 3 &&
+                  table.getOffset(9) == 2 * PWM_PERIOD_COUNTS / 3;
+    check(spaced, "slot ridistribuiti equispaziati in ordine di canale");
+
+    uint16_t on, off;
+    table.window(5, 300, on, off);
+    check(on == 0 && off == 300, "canale non registrato: ON = 0 come prima");
+
+    table.window(3, 0, on, off);
+    check(off == PWM_FULL_OFF, "pulse 0 spegne il canale (FULL_OFF)");
+}
+
+int main()
+{
+    testArmChannels();
+    testAllChannelsAndWrap();
+    testRegistrationKeepsSlotsConsistent();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
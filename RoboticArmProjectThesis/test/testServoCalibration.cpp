@@ -0,0 +1,176 @@
+/*******************************************************************************
+ * TEST HOST: CALIBRAZIONE PIECEWISE-LINEAR SU SERVO SIMULATO
+ *
+ * Servo simulato con non-linearità nota (errore sinusoidale fino a 6°).
+ * Verifica che la routine automatica e quella guidata producano una curva
+ * che porta il servo sull'angolo richiesto entro 1°.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testServoCalibration.cpp \
+ *       src/implement/ServoCalibration.cpp src/implement/CalibrationRoutine.cpp \
+ *       -o /tmp/testServoCalibration && /tmp/testServoCalibration
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "include/ServoCalibration.h"
+#include "include/CalibrationRoutine.h"
+
+// Servo 270° come ServoMotor20Diy
+#define SIM_MIN_ANGLE 0
+#define SIM_MAX_ANGLE 270
+#define SIM_MIN_PULSE 102
+#define SIM_MAX_PULSE 512
+#define SIM_BOW_DEG 6.0f
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+// ============================================================================
+// SERVO SIMULATO
+// ============================================================================
+
+/**
+ * Angolo reale raggiunto con un dato pulse
+ */
+static float simulatedAngle(void* /* context */, uint16_t pulse)
+{
+    float ideal = SIM_MIN_ANGLE + (float)(pulse - SIM_MIN_PULSE) *
+                  (SIM_MAX_ANGLE - SIM_MIN_ANGLE) / (SIM_MAX_PULSE - SIM_MIN_PULSE);
+    return ideal + SIM_BOW_DEG * sinf(ideal * (float)M_PI / SIM_MAX_ANGLE);
+}
+
+static float maxError(const ServoCalibration& cal, int safeMin, int safeMax)
+{
+    float worst = 0.0f;
+    for (int angle = safeMin; angle <= safeMax; angle++) {
+        float reached = simulatedAngle(nullptr, cal.angleToPulse(angle));
+        float error = fabsf(reached - angle);
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testLinearMatchesMap()
+{
+    ServoCalibration cal;
+    cal.setLinear(SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE);
+
+    bool same = true;
+    for (int angle = SIM_MIN_ANGLE; angle <= SIM_MAX_ANGLE; angle++) {
+        long expected = SIM_MIN_PULSE + (long)angle * (SIM_MAX_PULSE - SIM_MIN_PULSE) /
+                        (SIM_MAX_ANGLE - SIM_MIN_ANGLE);
+        long got = cal.angleToPulse(angle);
+        if (got < expected - 1 || got > expected + 1) same = false;
+    }
+
+    check(same, "curva lineare equivalente al vecchio map()");
+    check(cal.isMonotonic(), "curva lineare monotona");
+    check(fabsf(cal.pulseToAngle(cal.angleToPulse(135)) - 135) < 1.0f, "pulseToAngle inversa di angleToPulse");
+}
+
+static void testAutomatic()
+{
+    ServoCalibration nominal;
+    nominal.setLinear(SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE);
+
+    CalibrationRoutine routine;
+    routine.setProbe(simulatedAngle, nullptr);
+    routine.begin(nominal, SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE, 0);
+
+    unsigned long now = 0;
+    int ticks = 0;
+    while (routine.isActive() && ticks < 10000) {
+        now += 20;
+        routine.update(now);
+        ticks++;
+    }
+
+    check(routine.getState() == CAL_DONE, "routine automatica completata");
+    printf("       %d tick (%.1f s), errore nominale %.2f°, calibrato %.2f°\n",
+           ticks, now / 1000.0f,
+           maxError(nominal, SIM_MIN_ANGLE, SIM_MAX_ANGLE),
+           maxError(routine.getResult(), SIM_MIN_ANGLE, SIM_MAX_ANGLE));
+    check(maxError(routine.getResult(), SIM_MIN_ANGLE, SIM_MAX_ANGLE) < 1.0f, "errore calibrato < 1°");
+}
+
+static void testGuidedWithSafeRange()
+{
+    const int safeMin = 60;
+    const int safeMax = 200;
+
+    ServoCalibration nominal;
+    nominal.setLinear(SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE);
+
+    CalibrationRoutine routine;
+    routine.begin(nominal, safeMin, safeMax, SIM_MIN_PULSE, SIM_MAX_PULSE, 0);
+
+    bool leftSafeRange = false;
+    unsigned long now = 0;
+    int ticks = 0;
+    while (routine.isActive() && ticks < 10000) {
+        now += 20;
+        if (routine.update(now)) {
+            float angle = simulatedAngle(nullptr, routine.getPulse());
+            if (angle < safeMin - SIM_BOW_DEG - 1 || angle > safeMax + SIM_BOW_DEG + 1) {
+                leftSafeRange = true;
+            }
+        }
+
+        // Operatore simulato: corregge a vista di un passo per tick
+        if (routine.getState() == CAL_WAIT_OPERATOR) {
+            float error = routine.getCurrentAngle() - simulatedAngle(nullptr, routine.getPulse());
+            if (error > 0.4f) routine.nudge(1);
+            else if (error < -0.4f) routine.nudge(-1);
+            else routine.confirm();
+        }
+        ticks++;
+    }
+
+    check(routine.getState() == CAL_DONE, "routine guidata completata");
+    check(!leftSafeRange, "routine guidata resta nel range sicuro");
+    // Tra i punti misurati l'errore è piccolo, ai bordi vale l'estrapolazione
+    int firstMeasured = (int)ceilf(nominal.getPointAngle(2));
+    int lastMeasured = (int)nominal.getPointAngle(5);
+    check(maxError(routine.getResult(), firstMeasured, lastMeasured) < 1.0f, "errore calibrato tra i punti misurati < 1°");
+    check(maxError(routine.getResult(), safeMin, safeMax) < maxError(nominal, safeMin, safeMax),
+          "errore calibrato nel range sicuro minore del nominale");
+}
+
+static void testAbortAndChecksum()
+{
+    ServoCalibration nominal;
+    nominal.setLinear(SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE);
+
+    CalibrationRoutine routine;
+    routine.begin(nominal, SIM_MIN_ANGLE, SIM_MAX_ANGLE, SIM_MIN_PULSE, SIM_MAX_PULSE, 0);
+    routine.abort();
+    check(routine.getState() == CAL_FAILED && !routine.isActive(), "abort interrompe la routine");
+
+    ServoCalibration changed = nominal;
+    changed.setPointPulse(3, changed.getPointPulse(3) + 1);
+    check(changed.checksum() != nominal.checksum(), "checksum rileva un punto modificato");
+
+    changed.setPointPulse(3, changed.getPointPulse(2));
+    check(!changed.isMonotonic(), "curva non monotona rifiutata");
+}
+
+int main()
+{
+    testLinearMatchesMap();
+    testAutomatic();
+    testGuidedWithSafeRange();
+    testAbortAndChecksum();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+/*******************************************************************************
+ * TEST HOST: FORMATO DELLE REGISTRAZIONI TEACH
+ *
+ * Registra una sessione di jog simulata (pause, rampe, velocità costante,
+ * tremolio) e la rilegge attraverso un TrajectoryRing piccolo, alternando
+ * scrittura e lettura come tick e task della flash. Verifica che i
+ * campioni tornino identici e nello stesso numero (tempi conservati),
+ * la compressione di pause e tratti a velocità costante, le registrazioni
+ * interrotte e i flussi non validi.
+ *
+ * Compilazione (da RoboticArmProjectThesis/):
+ *   g++ -std=c++17 -Isrc test/testTrajectoryCodec.cpp src/implement/TrajectoryCodec.cpp \
+ *       -o /tmp/testTrajectoryCodec && /tmp/testTrajectoryCodec
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "include/TrajectoryCodec.h"
+
+#define JOINTS 4
+#define PERIOD_MS 20
+
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    printf("%s %s\n", condition ? "[OK]  " : "[FAIL]", what);
+    if (!condition) failures++;
+}
+
+/**
+ * Sink in memoria (il "file")
+ */
+struct MemorySink : public TrajectorySink {
+    std::vector<uint8_t> data;
+
+    bool write(const uint8_t* bytes, int length) override {
+        data.insert(data.end(), bytes, bytes + length);
+        return true;
+    }
+};
+
+/**
+ * Source in memoria, a blocchi di al più chunk byte per lettura
+ */
+struct MemorySource : public TrajectorySource {
+    const std::vector<uint8_t>& data;
+    size_t position;
+    int chunk;
+
+    MemorySource(const std::vector<uint8_t>& data, int chunk) : data(data), position(0), chunk(chunk) {}
+
+    int read(uint8_t* bytes, int length) override {
+        int count = (int)(data.size() - position);
+        if (count > length) count = length;
+        if (count > chunk) count = chunk;
+        memcpy(bytes, data.data() + position, count);
+        position += count;
+        return count;
+    }
+
+    bool isClosed() const override { return position == data.size(); }
+};
+
+typedef std::vector<std::vector<int16_t>> Session;
+
+static const TrajectoryHeader HEADER = {JOINTS, PERIOD_MS, TRAJ_UNITS_PER_DEG};
+
+// ============================================================================
+// SESSIONE SIMULATA
+// ============================================================================
+
+/**
+ * Jog a pulsante: pausa, rampa, crociera, frenata, per giunti diversi,
+ * con un po' di tremolio sulla pinza
+ */
+static Session makeSession()
+{
+    Session session;
+    float angles[JOINTS] = {90.0f, 110.0f, 90.0f, 45.0f};
+    float velocity[JOINTS] = {0.0f, 0.0f, 0.0f, 0.0f};
+    srand(7);
+
+    for (int tick = 0; tick < 3000; tick++) {
+        int phase = (tick / 250) % 6;
+        int joint = (tick / 250) % JOINTS;
+        float target = (phase % 2 == 0) ? 0.0f : ((phase & 2) ? -40.0f : 40.0f);
+
+        for (int j = 0; j < JOINTS; j++) {
+            float want = (j == joint) ? target : 0.0f;
+            float dv = 400.0f * PERIOD_MS / 1000.0f;
+            if (velocity[j] < want) velocity[j] = (velocity[j] + dv < want) ? velocity[j] + dv : want;
+            if (velocity[j] > want) velocity[j] = (velocity[j] - dv > want) ? velocity[j] - dv : want;
+            angles[j] += velocity[j] * PERIOD_MS / 1000.0f;
+        }
+        if (tick > 2500 && tick % 3 == 0) {
+            angles[3] += (rand() % 5 - 2) * 0.1f;
+        }
+
+        std::vector<int16_t> sample(JOINTS);
+        for (int j = 0; j < JOINTS; j++) {
+            sample[j] = TrajectoryDecoder::quantize(angles[j]);
+        }
+        session.push_back(sample);
+    }
+    return session;
+}
+
+static std::vector<uint8_t> encode(const Session& session, bool finish = true)
+{
+    MemorySink sink;
+    TrajectoryEncoder encoder;
+    encoder.begin(&sink, HEADER);
+    for (const auto& sample : session) {
+        encoder.add(sample.data());
+    }
+    if (finish) {
+        encoder.finish();
+    }
+    return sink.data;
+}
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static void testRoundTripThroughRing()
+{
+    Session session = makeSession();
+    uint8_t storage[96];
+    TrajectoryRing ring(storage, sizeof(storage));
+    TrajectoryEncoder encoder;
+    TrajectoryDecoder decoder;
+    decoder.reset(&ring);
+
+    check(encoder.begin(&ring, HEADER), "intestazione scritta");
+
+    // Un campione per tick; il "task" scarica il ring ogni 5 tick
+    Session decoded;
+    std::vector<uint8_t> file;
+    bool ok = true;
+    for (size_t tick = 0; tick < session.size(); tick++) {
+        ok = ok && encoder.add(session[tick].data());
+        if (tick % 5 == 4) {
+            uint8_t chunk[64];
+            int count;
+            while ((count = ring.read(chunk, sizeof(chunk))) > 0) {
+                file.insert(file.end(), chunk, chunk + count);
+            }
+        }
+    }
+    ok = ok && encoder.finish();
+    uint8_t chunk[64];
+    int count;
+    while ((count = ring.read(chunk, sizeof(chunk))) > 0) {
+        file.insert(file.end(), chunk, chunk + count);
+    }
+    check(ok, "il ring da 96 byte basta se scaricato ogni 5 tick");
+    check(encoder.getSamples() == session.size(), "campioni contati dall'encoder");
+
+    // Riproduzione: il "task" riempie il ring a blocchi, il tick decodifica
+    ring.reset();
+    decoder.reset(&ring);
+    size_t position = 0;
+    int status = TRAJ_WAIT;
+    int waits = 0;
+    while (status == TRAJ_SAMPLE || status == TRAJ_WAIT) {
+        int room = ring.space() < 40 ? ring.space() : 40;
+        int n = (int)(file.size() - position) < room ? (int)(file.size() - position) : room;
+        if (n > 0) {
+            ring.write(file.data() + position, n);
+            position += n;
+        }
+        if (position == file.size()) {
+            ring.close();
+        }
+
+        int16_t sample[JOINTS];
+        status = decoder.next(sample);
+        if (status == TRAJ_SAMPLE) {
+            decoded.push_back(std::vector<int16_t>(sample, sample + JOINTS));
+        }
+        else if (status == TRAJ_WAIT) {
+            waits++;
+        }
+    }
+
+    check(status == TRAJ_END && !decoder.isTruncated(), "fine con record END");
+    check(decoder.hasHeader() && decoder.getHeader().jointCount == JOINTS &&
+          decoder.getHeader().periodMs == PERIOD_MS, "intestazione riletta");
+    check(decoded.size() == session.size(), "stesso numero di campioni (tempi conservati)");
+    check(decoded == session, "campioni identici");
+
+    printf("       %zu campioni, %zu byte (%.2f byte/campione, grezzo %d), attese %d\n",
+           session.size(), file.size(), (double)file.size() / session.size(), 2 * JOINTS, waits);
+    check(file.size() * 8 < session.size() * 2 * JOINTS, "compressione oltre 8x sul jog");
+}
+
+static void testHoldAndConstantVelocity()
+{
+    Session session;
+    for (int tick = 0; tick < 1000; tick++) {
+        int16_t base = (int16_t)(tick < 500 ? 900 : 900 + (tick - 500) * 12);
+        session.push_back({base, 1100, 900, 450});
+    }
+    std::vector<uint8_t> file = encode(session);
+
+    // KEY + (DELTA nullo + 4 REPEAT) + (DELTA + 4 REPEAT) + END
+    check(file.size() <= TRAJ_HEADER_BYTES + 9 + 2 + 4 + 4 + 4 + 1,
+          "pausa e velocità costante: pochi byte");
+
+    MemorySource source(file, 3);
+    TrajectoryDecoder decoder;
+    decoder.reset(&source);
+    int16_t sample[JOINTS];
+    size_t count = 0;
+    bool same = true;
+    int status;
+    while ((status = decoder.next(sample)) == TRAJ_SAMPLE || status == TRAJ_WAIT) {
+        if (status == TRAJ_SAMPLE) {
+            same = same && count < session.size() && memcmp(sample, session[count].data(), sizeof(sample)) == 0;
+            count++;
+        }
+    }
+    check(status == TRAJ_END && same && count == session.size(), "riletti identici a blocchi di 3 byte");
+}
+
+static void testTruncatedRecording()
+{
+    Session session = makeSession();
+    std::vector<uint8_t> file = encode(session, false);
+    file.resize(file.size() - 1);   // Ultimo record a metà (spegnimento)
+
+    MemorySource source(file, 64);
+    TrajectoryDecoder decoder;
+    decoder.reset(&source);
+    int16_t sample[JOINTS];
+    int status;
+    unsigned long count = 0;
+    while ((status = decoder.next(sample)) == TRAJ_SAMPLE || status == TRAJ_WAIT) {
+        if (status == TRAJ_SAMPLE) count++;
+    }
+    check(status == TRAJ_END && decoder.isTruncated(), "senza END: fine segnalata come interrotta");
+    check(count > 0 && count <= session.size(), "campioni validi fino all'interruzione");
+}
+
+static void testInvalidStreams()
+{
+    std::vector<uint8_t> file = encode(makeSession());
+    int16_t sample[JOINTS];
+
+    std::vector<uint8_t> badMagic = file;
+    badMagic[0] = 'X';
+    MemorySource source1(badMagic, 64);
+    TrajectoryDecoder decoder;
+    decoder.reset(&source1);
+    check(decoder.next(sample) == TRAJ_ERROR, "intestazione non valida");
+
+    std::vector<uint8_t> badTag = file;
+    badTag[TRAJ_HEADER_BYTES] = 0x10;   // REPEAT prima del KEY
+    MemorySource source2(badTag, 64);
+    decoder.reset(&source2);
+    check(decoder.next(sample) == TRAJ_ERROR, "REPEAT prima del primo campione");
+
+    std::vector<uint8_t> empty;
+    MemorySource source3(empty, 64);
+    decoder.reset(&source3);
+    check(decoder.next(sample) == TRAJ_ERROR, "file vuoto");
+}
+
+static void testRingOverflow()
+{
+    uint8_t storage[32];
+    TrajectoryRing ring(storage, sizeof(storage));
+    TrajectoryEncoder encoder;
+    encoder.begin(&ring, HEADER);
+
+    Session session = makeSession();
+    bool ok = true;
+    size_t tick = 0;
+    while (ok && tick < session.size()) {
+        ok = encoder.add(session[tick++].data());
+    }
+    check(!ok, "ring mai scaricato: add() segnala lo spazio finito");
+    check(ring.available() <= 31, "il ring non viene sovrascritto");
+}
+
+static void testQuantize()
+{
+    check(TrajectoryDecoder::quantize(90.04f) == 900 && TrajectoryDecoder::quantize(90.05f) == 901,
+          "arrotondamento al decimo di grado");
+    check(TrajectoryDecoder::quantize(-1.26f) == -13, "angoli negativi");
+    check(TrajectoryDecoder::toDegrees(TrajectoryDecoder::quantize(137.3f)) == 137.3f, "conversione inversa");
+}
+
+int main()
+{
+    testRoundTripThroughRing();
+    testHoldAndConstantVelocity();
+    testTruncatedRecording();
+    testInvalidStreams();
+    testRingOverflow();
+    testQuantize();
+
+    printf("\n%s (%d failure)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
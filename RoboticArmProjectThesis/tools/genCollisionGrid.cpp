@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * TOOL HOST: GENERATORE DELLA GRIGLIA DI COLLISIONE
+ *
+ * Calcola, per ogni cella gomito/polso di COLLISION_STEP_DEG gradi, se
+ * la posa è sicura con la geometria di ArmModel.h e scrive
+ * src/implement/CollisionGrid.cpp. Una cella è sicura solo se lo sono
+ * tutti i punti campionati al suo interno, bordi compresi (griglia
+ * conservativa). Controlli nel piano del braccio, in double:
+ *   - polso e punta della pinza sopra il piano (ARM_TABLE_CLEARANCE_MM)
+ *   - avambraccio e pinza fuori dal corpo della base
+ *   - angolo tra i due link di almeno ARM_MIN_FOLD_DEG
+ * Il braccio è montato sopra la base: il primo link non viene
+ * controllato contro il corpo della base.
+ *
+ * Uso (da RoboticArmProjectThesis/, dopo ogni modifica di ArmModel.h):
+ *   g++ -std=c++17 -Isrc tools/genCollisionGrid.cpp -o /tmp/genCollisionGrid && \
+ *       /tmp/genCollisionGrid > src/implement/CollisionGrid.cpp
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "include/CollisionMap.h"
+
+#define SUBSAMPLES 4            // Intervalli per lato di cella
+#define LINK_SAMPLE_MM 2.0      // Passo dei punti sull'avambraccio
+
+static const double RAD = M_PI / 180.0;
+
+// ============================================================================
+// MODELLO
+// ============================================================================
+
+static bool insideBase(double reach, double height)
+{
+    return fabs(reach) < ARM_BASE_RADIUS_MM + ARM_LINK_RADIUS_MM &&
+           height < ARM_BASE_TOP_MM + ARM_LINK_RADIUS_MM;
+}
+
+static bool isPoseSafe(const ArmGeometry& g, double elbow, double wrist)
+{
+    double shoulder = g.elbowSign * (elbow - g.elbowOffset) * RAD;
+    double relative = g.wristSign * (wrist - g.wristOffset) * RAD;
+    double tool = shoulder + relative;
+
+    // Avambraccio ripiegato sul braccio
+    if (fabs(remainder(relative / RAD, 360.0)) > 180.0 - ARM_MIN_FOLD_DEG) {
+        return false;
+    }
+
+    double wristReach = g.upperArm * cos(shoulder);
+    double wristHeight = g.baseHeight + g.upperArm * sin(shoulder);
+    double tipReach = wristReach + g.forearm * cos(tool);
+    double tipHeight = wristHeight + g.forearm * sin(tool);
+
+    if (wristHeight < ARM_TABLE_CLEARANCE_MM || tipHeight < ARM_TABLE_CLEARANCE_MM) {
+        return false;
+    }
+
+    int samples = (int)ceil(g.forearm / LINK_SAMPLE_MM);
+    for (int i = 0; i <= samples; i++) {
+        double t = (double)i / samples;
+        if (insideBase(wristReach + (tipReach - wristReach) * t, wristHeight + (tipHeight - wristHeight) * t)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isCellSafe(const ArmGeometry& g, int elbowCell, int wristCell)
+{
+    for (int i = 0; i <= SUBSAMPLES; i++) {
+        for (int j = 0; j <= SUBSAMPLES; j++) {
+            double elbow = (elbowCell + (double)i / SUBSAMPLES) * COLLISION_STEP_DEG;
+            double wrist = (wristCell + (double)j / SUBSAMPLES) * COLLISION_STEP_DEG;
+            if (!isPoseSafe(g, elbow, wrist)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+int main()
+{
+    const ArmGeometry& g = ARM_GEOMETRY;
+    static uint8_t grid[COLLISION_GRID_BYTES] = {};
+    int safe = 0;
+
+    for (int e = 0; e < COLLISION_ELBOW_CELLS; e++) {
+        for (int w = 0; w < COLLISION_WRIST_CELLS; w++) {
+            if (isCellSafe(g, e, w)) {
+                int bit = e * COLLISION_WRIST_CELLS + w;
+                grid[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+                safe++;
+            }
+        }
+    }
+
+    int total = COLLISION_ELBOW_CELLS * COLLISION_WRIST_CELLS;
+    fprintf(stderr, "%d/%d celle sicure, %d byte\n", safe, total, COLLISION_GRID_BYTES);
+
+    printf("/*******************************************************************************\n");
+    printf(" * COLLISION GRID - GENERATO DA tools/genCollisionGrid.cpp, NON MODIFICARE\n");
+    printf(" *\n");
+    printf(" * Celle gomito/polso di %d gradi (%d x %d), %d/%d sicure.\n",
+           COLLISION_STEP_DEG, COLLISION_ELBOW_CELLS, COLLISION_WRIST_CELLS, safe, total);
+    printf(" * Ingombri: piano %.0fmm, base R%.0f H%.0fmm, link %.0fmm, piega %.0f gradi\n",
+           ARM_TABLE_CLEARANCE_MM, ARM_BASE_RADIUS_MM, ARM_BASE_TOP_MM, ARM_LINK_RADIUS_MM, ARM_MIN_FOLD_DEG);
+    printf(" ******************************************************************************/\n\n");
+    printf("#include \"include/CollisionMap.h\"\n\n");
+
+    printf("const ArmGeometry COLLISION_GRID_GEOMETRY = {\n");
+    printf("    %#.9gf, %#.9gf, %#.9gf, %#.9gf, %#.9gf, %#.9gf, %d, %d, %d\n",
+           g.baseHeight, g.upperArm, g.forearm, g.baseOffset, g.elbowOffset, g.wristOffset,
+           g.baseSign, g.elbowSign, g.wristSign);
+    printf("};\n\n");
+
+    printf("const uint8_t COLLISION_GRID[COLLISION_GRID_BYTES] = {");
+    for (int i = 0; i < COLLISION_GRID_BYTES; i++) {
+        printf("%s0x%02X%s", i % 16 == 0 ? "\n    " : "", grid[i], i + 1 < COLLISION_GRID_BYTES ? ", " : "");
+    }
+    printf("\n};\n");
+
+    return 0;
+}
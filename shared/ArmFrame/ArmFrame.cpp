@@ -0,0 +1,160 @@
+#include "ArmFrame.h"
+#include <string.h>
+
+// ============================================================================
+// CODIFICA
+// ============================================================================
+
+int ArmFrameCodec::frameLength(uint16_t mask) {
+    int count = 0;
+    for (int bit = 0; bit < ARM_FRAME_VALUES; bit++) {
+        if (mask & (1 << bit)) {
+            count++;
+        }
+    }
+    return ARM_FRAME_HEADER_BYTES + count + 1;
+}
+
+int ArmFrameCodec::encode(const ArmFrame& frame, uint8_t* buffer, int size) {
+    if ((frame.mask >> ARM_FRAME_VALUES) != 0 || frameLength(frame.mask) > size) {
+        return 0;
+    }
+
+    int length = 0;
+    buffer[length++] = ARM_FRAME_MAGIC;
+    buffer[length++] = ARM_FRAME_VERSION;
+    buffer[length++] = frame.type;
+    buffer[length++] = frame.sequence;
+    buffer[length++] = frame.flags;
+    buffer[length++] = (uint8_t)(frame.mask & 0xFF);
+    buffer[length++] = (uint8_t)(frame.mask >> 8);
+
+    for (int bit = 0; bit < ARM_FRAME_VALUES; bit++) {
+        if (frame.mask & (1 << bit)) {
+            buffer[length++] = (uint8_t)frame.values[bit];
+        }
+    }
+
+    buffer[length] = crc8(buffer, length);
+    return length + 1;
+}
+
+// ============================================================================
+// DECODIFICA
+// ============================================================================
+
+bool ArmFrameCodec::isFrame(const uint8_t* data, int length) {
+    return length > 0 && data[0] == ARM_FRAME_MAGIC;
+}
+
+int ArmFrameCodec::decode(const uint8_t* data, int length, ArmFrame& frame) {
+    memset(&frame, 0, sizeof(frame));
+
+    if (length < ARM_FRAME_HEADER_BYTES + 1) {
+        return FRAME_TOO_SHORT;
+    }
+    if (data[0] != ARM_FRAME_MAGIC) {
+        return FRAME_BAD_MAGIC;
+    }
+    if (data[1] != ARM_FRAME_VERSION) {
+        return FRAME_BAD_VERSION;
+    }
+
+    uint16_t mask = (uint16_t)(data[5] | (data[6] << 8));
+    if ((mask >> ARM_FRAME_VALUES) != 0 || length != frameLength(mask)) {
+        return FRAME_BAD_LENGTH;
+    }
+    if (crc8(data, length - 1) != data[length - 1]) {
+        return FRAME_BAD_CRC;
+    }
+    if (data[2] > FRAME_JOG) {
+        return FRAME_BAD_TYPE;
+    }
+
+    frame.type = data[2];
+    frame.sequence = data[3];
+    frame.flags = data[4];
+    frame.mask = mask;
+
+    int offset = ARM_FRAME_HEADER_BYTES;
+    for (int bit = 0; bit < ARM_FRAME_VALUES; bit++) {
+        if (mask & (1 << bit)) {
+            int8_t value = (int8_t)data[offset++];
+            if (value > ARM_FRAME_FULL_SCALE || value < -ARM_FRAME_FULL_SCALE) {
+                return FRAME_BAD_VALUE;
+            }
+            frame.values[bit] = value;
+        }
+    }
+    return FRAME_OK;
+}
+
+/**
+ * CRC-8 ATM (x^8 + x^2 + x + 1), bit per bit: pochi byte per frame
+ */
+uint8_t ArmFrameCodec::crc8(const uint8_t* data, int length) {
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+const char* ArmFrameCodec::errorName(int error) {
+    switch (error) {
+        case FRAME_OK: return "OK";
+        case FRAME_TOO_SHORT: return "Troppo corto";
+        case FRAME_BAD_MAGIC: return "Magic errato";
+        case FRAME_BAD_VERSION: return "Versione non supportata";
+        case FRAME_BAD_LENGTH: return "Lunghezza errata";
+        case FRAME_BAD_CRC: return "CRC errato";
+        case FRAME_BAD_TYPE: return "Tipo sconosciuto";
+        case FRAME_BAD_VALUE: return "Velocità fuori scala";
+        default: return "Sconosciuto";
+    }
+}
+
+// ============================================================================
+// SEQUENZA
+// ============================================================================
+
+ArmFrameTracker::ArmFrameTracker() {
+    this->started = false;
+    this->last = 0;
+    this->lost = 0;
+    this->duplicates = 0;
+}
+
+bool ArmFrameTracker::accept(const ArmFrame& frame) {
+    uint8_t gap = (uint8_t)(frame.sequence - last);
+
+    if (started && !(frame.flags & FRAME_FLAG_FIRST)) {
+        if (gap == 0) {
+            duplicates++;
+            return false;
+        }
+        // Salti all'indietro: controller riavviato senza FIRST, si riparte
+        if (gap < 128) {
+            lost += gap - 1;
+        }
+    }
+
+    started = true;
+    last = frame.sequence;
+    return true;
+}
+
+void ArmFrameTracker::reset() {
+    started = false;
+}
+
+unsigned long ArmFrameTracker::getLost() const {
+    return lost;
+}
+
+unsigned long ArmFrameTracker::getDuplicates() const {
+    return duplicates;
+}
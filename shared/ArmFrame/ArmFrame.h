@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * ARM FRAME - FRAME BINARI ESP-NOW TRA CONTROLLER E BRACCIO
+ *
+ * Condiviso dai due firmware (lib_extra_dirs nei platformio.ini).
+ * Un frame sostituisce le stringhe "Base SX Elbow STOP" + NUL:
+ *   0     magic 0xA5 (il testo non inizia mai così)
+ *   1     versione
+ *   2     tipo (ArmFrameType)
+ *   3     sequenza (modulo 256)
+ *   4     flag (ArmFrameFlag)
+ *   5-6   maschera little-endian: bit 0..7 giunti (indice sul braccio),
+ *         bit 8..10 assi X/Y/Z della pinza
+ *   7..   un int8 per bit della maschera, in ordine di bit: velocità in
+ *         percentuale di quella di jog (-100..100, 0 = rilascio)
+ *   n     CRC-8 (polinomio 0x07) dei byte precedenti
+ * Due giunti in jog occupano 10 byte contro i 17 di "Base SX Elbow DX";
+ * la decodifica non alloca e non confronta stringhe.
+ * I frame portano solo i jog: gli altri comandi (SCRIPT, TEACH, MOVE,
+ * ...) restano testo e il braccio li accetta sempre.
+ * ARM_FRAME_TEXT_COMPAT = 1 (build_flags) riporta il controller al
+ * vecchio formato testuale anche per i jog.
+ * Non dipende da Arduino (testabile su host).
+ ******************************************************************************/
+
+#ifndef __ARM_FRAME__
+#define __ARM_FRAME__
+
+#include <stdint.h>
+
+#ifndef ARM_FRAME_TEXT_COMPAT
+#define ARM_FRAME_TEXT_COMPAT 0      // 1 = stringhe di testo come prima dei frame
+#endif
+
+#define ARM_FRAME_MAGIC 0xA5
+#define ARM_FRAME_VERSION 1
+#define ARM_FRAME_HEADER_BYTES 7
+#define ARM_FRAME_MAX_JOINTS 8
+#define ARM_FRAME_AXES 3
+#define ARM_FRAME_AXIS_SHIFT 8       // Bit del primo asse della pinza
+#define ARM_FRAME_VALUES (ARM_FRAME_AXIS_SHIFT + ARM_FRAME_AXES)
+#define ARM_FRAME_MAX_BYTES (ARM_FRAME_HEADER_BYTES + ARM_FRAME_VALUES + 1)
+#define ARM_FRAME_FULL_SCALE 100     // Valore della velocità di jog piena
+
+#define ARM_FRAME_AXIS_BIT(axis) (ARM_FRAME_AXIS_SHIFT + (axis))
+
+enum ArmFrameType
+{
+    FRAME_HEARTBEAT = 0,   // Solo presenza del controller
+    FRAME_JOG = 1          // Velocità di jog per i bit della maschera
+};
+
+enum ArmFrameFlag
+{
+    FRAME_FLAG_REPEAT = 0x01,   // Solo rinnovi del keepalive, nessun cambio
+    FRAME_FLAG_FIRST = 0x02     // Primo frame dopo l'avvio: sequenza nuova
+};
+
+enum ArmFrameError
+{
+    FRAME_OK = 0,
+    FRAME_TOO_SHORT = 1,
+    FRAME_BAD_MAGIC = 2,
+    FRAME_BAD_VERSION = 3,
+    FRAME_BAD_LENGTH = 4,    // Lunghezza diversa da quella della maschera
+    FRAME_BAD_CRC = 5,
+    FRAME_BAD_TYPE = 6,
+    FRAME_BAD_VALUE = 7      // Velocità oltre ARM_FRAME_FULL_SCALE
+};
+
+struct ArmFrame {
+    uint8_t type;
+    uint8_t sequence;
+    uint8_t flags;
+    uint16_t mask;
+    int8_t values[ARM_FRAME_VALUES];   // Indicizzati per bit (solo quelli della maschera)
+};
+
+class ArmFrameCodec {
+
+public:
+    /**
+     * @return Byte scritti, 0 se il buffer non basta o il frame non è valido
+     */
+    static int encode(const ArmFrame& frame, uint8_t* buffer, int size);
+
+    /**
+     * Verifica magic, versione, lunghezza e CRC; i valori fuori dalla
+     * maschera restano a 0
+     * @return ArmFrameError
+     */
+    static int decode(const uint8_t* data, int length, ArmFrame& frame);
+
+    /**
+     * true se i dati sono un frame binario e non testo
+     */
+    static bool isFrame(const uint8_t* data, int length);
+
+    static uint8_t crc8(const uint8_t* data, int length);
+    static int frameLength(uint16_t mask);
+    static const char* errorName(int error);
+};
+
+/**
+ * Sequenza lato ricevitore: scarta i duplicati e conta i frame persi
+ */
+class ArmFrameTracker {
+
+public:
+    ArmFrameTracker();
+
+    /**
+     * @return false se il frame è un duplicato del precedente
+     */
+    bool accept(const ArmFrame& frame);
+
+    /**
+     * Il prossimo frame riparte da una sequenza qualsiasi (connessione persa)
+     */
+    void reset();
+
+    unsigned long getLost() const;
+    unsigned long getDuplicates() const;
+
+private:
+    bool started;
+    uint8_t last;
+    unsigned long lost;
+    unsigned long duplicates;
+};
+
+#endif